@@ -0,0 +1,316 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "AsyncLogWriter.h"
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	void AppendTimeStamp(std::string& buffer, const SYSTEMTIME& time)
+	{
+		char timeStamp[256]{};
+
+		int length = GetTimeFormatA(
+			LOCALE_USER_DEFAULT,
+			0,
+			&time,
+			nullptr,
+			timeStamp,
+			_countof(timeStamp));
+
+		// The length includes the terminating null character.
+		if (length > 1)
+		{
+			buffer.append(timeStamp, static_cast<size_t>(length) - 1);
+
+			// Append a space to the end of the string if it does not have one.
+			if (timeStamp[length - 2] != ' ')
+			{
+				buffer.append(1, ' ');
+			}
+		}
+	}
+}
+
+AsyncLogWriter::AsyncLogWriter(MappedLogFile& logFile, LogOverflowPolicy overflowPolicy)
+	: logFile(logFile),
+	  overflowPolicy(overflowPolicy),
+	  queue(),
+	  writerThread(),
+	  batchBuffer(),
+	  wakeSignal(0),
+	  writerIdle(false),
+	  stopRequested(false),
+	  fileFlushRequestCount(0),
+	  fileFlushCompletedCount(0),
+	  droppedCount(0)
+{
+	batchBuffer.reserve(64 * 1024);
+}
+
+AsyncLogWriter::~AsyncLogWriter()
+{
+	Stop();
+}
+
+void AsyncLogWriter::Start()
+{
+	if (!writerThread.joinable())
+	{
+		stopRequested.store(false, std::memory_order_relaxed);
+		writerThread = std::thread(&AsyncLogWriter::WriterThreadProc, this);
+	}
+}
+
+void AsyncLogWriter::Stop()
+{
+	if (writerThread.joinable())
+	{
+		stopRequested.store(true, std::memory_order_seq_cst);
+		wakeSignal.fetch_add(1, std::memory_order_release);
+		wakeSignal.notify_one();
+
+		writerThread.join();
+	}
+
+	// Write any messages that were queued after the writer thread exited.
+	while (DrainQueue() > 0)
+	{
+	}
+}
+
+uint64_t AsyncLogWriter::GetDroppedMessageCount() const
+{
+	return droppedCount.load(std::memory_order_relaxed);
+}
+
+void AsyncLogWriter::Flush()
+{
+	if (!writerThread.joinable())
+	{
+		return;
+	}
+
+	// The log file is only accessed by the writer thread, it flushes the
+	// mapped view after it has written the queued messages.
+	const uint64_t target = fileFlushRequestCount.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+	wakeSignal.fetch_add(1, std::memory_order_release);
+	wakeSignal.notify_one();
+
+	uint64_t completed = fileFlushCompletedCount.load(std::memory_order_acquire);
+
+	while (completed < target)
+	{
+		fileFlushCompletedCount.wait(completed, std::memory_order_acquire);
+		completed = fileFlushCompletedCount.load(std::memory_order_acquire);
+	}
+}
+
+bool AsyncLogWriter::WriteLine(const char* const message, bool writeTimeStamp)
+{
+	return Enqueue([&](LogRecord& record)
+	{
+		GetLocalTime(&record.time);
+		record.type = RecordType::TextLine;
+		record.hasTimeStamp = writeTimeStamp;
+
+		const size_t length = strnlen(message, MaxMessageLength);
+
+		std::memcpy(record.message, message, length);
+		record.message[length] = '\0';
+		record.length = static_cast<uint32_t>(length);
+	});
+}
+
+bool AsyncLogWriter::WriteLineFormatted(const char* const format, va_list args)
+{
+	return Enqueue([&](LogRecord& record)
+	{
+		GetLocalTime(&record.time);
+		record.type = RecordType::TextLine;
+		record.hasTimeStamp = true;
+
+		va_list argsCopy;
+		va_copy(argsCopy, args);
+
+		const int length = std::vsnprintf(record.message, sizeof(record.message), format, argsCopy);
+
+		va_end(argsCopy);
+
+		if (length < 0)
+		{
+			record.message[0] = '\0';
+			record.length = 0;
+		}
+		else if (static_cast<size_t>(length) > MaxMessageLength)
+		{
+			// vsnprintf truncated the message to fit the buffer.
+			record.length = static_cast<uint32_t>(MaxMessageLength);
+		}
+		else
+		{
+			record.length = static_cast<uint32_t>(length);
+		}
+	});
+}
+
+bool AsyncLogWriter::WriteBinaryRecord(const uint8_t* data, size_t size)
+{
+	if (size > BinaryLogFormat::MaxRecordSize)
+	{
+		return false;
+	}
+
+	return Enqueue([&](LogRecord& record)
+	{
+		record.type = RecordType::Binary;
+		record.hasTimeStamp = false;
+		record.length = static_cast<uint32_t>(size);
+		std::memcpy(record.message, data, size);
+	});
+}
+
+template <typename FillCallback>
+bool AsyncLogWriter::Enqueue(FillCallback&& fill)
+{
+	bool result = queue.TryEnqueue(fill);
+
+	if (!result && overflowPolicy == LogOverflowPolicy::Block)
+	{
+		do
+		{
+			WakeWriterThread();
+			std::this_thread::yield();
+
+			result = queue.TryEnqueue(fill);
+
+		} while (!result && !stopRequested.load(std::memory_order_relaxed));
+	}
+
+	if (result)
+	{
+		// The fence pairs with the one in the writer thread, it ensures that either
+		// the writer thread sees the new message or we see that it is idle.
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (writerIdle.load(std::memory_order_relaxed))
+		{
+			WakeWriterThread();
+		}
+	}
+	else
+	{
+		droppedCount.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	return result;
+}
+
+void AsyncLogWriter::WakeWriterThread()
+{
+	wakeSignal.fetch_add(1, std::memory_order_release);
+	wakeSignal.notify_one();
+}
+
+void AsyncLogWriter::WriterThreadProc()
+{
+	for (;;)
+	{
+		const uint32_t signal = wakeSignal.load(std::memory_order_acquire);
+
+		// The request count is read before the queue is drained, the messages that were queued
+		// before the flush was requested will be written before the view is flushed.
+		// The queue holds at most one batch, so those messages are all in this batch.
+		const uint64_t flushRequestCount = fileFlushRequestCount.load(std::memory_order_acquire);
+		const size_t recordCount = DrainQueue();
+
+		if (flushRequestCount != fileFlushCompletedCount.load(std::memory_order_relaxed))
+		{
+			logFile.Flush();
+
+			// The waiting threads are released after the file has been flushed.
+			fileFlushCompletedCount.store(flushRequestCount, std::memory_order_release);
+			fileFlushCompletedCount.notify_all();
+		}
+
+		if (recordCount > 0)
+		{
+			continue;
+		}
+
+		if (stopRequested.load(std::memory_order_acquire))
+		{
+			break;
+		}
+
+		writerIdle.store(true, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (queue.IsEmpty() && !stopRequested.load(std::memory_order_relaxed))
+		{
+			wakeSignal.wait(signal, std::memory_order_acquire);
+		}
+
+		writerIdle.store(false, std::memory_order_relaxed);
+	}
+}
+
+size_t AsyncLogWriter::DrainQueue()
+{
+	const auto appendRecord = [this](const LogRecord& record)
+	{
+		if (record.type == RecordType::Binary)
+		{
+			batchBuffer.append(record.message, record.length);
+			return;
+		}
+
+		if (record.hasTimeStamp)
+		{
+			AppendTimeStamp(batchBuffer, record.time);
+		}
+
+		batchBuffer.append(record.message, record.length);
+		batchBuffer.append(1, '\n');
+
+#ifdef _DEBUG
+		OutputDebugStringA(record.message);
+		OutputDebugStringA("\n");
+#endif // _DEBUG
+	};
+
+	size_t recordCount = 0;
+
+	batchBuffer.clear();
+
+	// The batch size is limited to the queue capacity, this prevents the batch
+	// buffer from growing without bound when the producers never stop writing.
+	while (recordCount < QueueCapacity && queue.TryDequeue(appendRecord))
+	{
+		++recordCount;
+	}
+
+	if (recordCount > 0)
+	{
+		// The batch is copied to the mapped log file with a single write call,
+		// the log file flushes the mapped view to disk at a fixed interval.
+		if (logFile)
+		{
+			logFile.Write(batchBuffer.data(), batchBuffer.size());
+		}
+	}
+
+	return recordCount;
+}
@@ -0,0 +1,106 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "BinaryLogFormat.h"
+#include "BoundedMpscQueue.h"
+#include "Logger.h"
+#include "MappedLogFile.h"
+#include <atomic>
+#include <cstdarg>
+#include <string>
+#include <thread>
+#include <Windows.h>
+
+// Writes log messages to the log file from a background thread.
+//
+// The game thread only copies the message into a slot in a lock-free ring buffer,
+// the time stamp formatting and the file I/O are performed by the writer thread.
+class AsyncLogWriter
+{
+public:
+
+	AsyncLogWriter(MappedLogFile& logFile, LogOverflowPolicy overflowPolicy);
+	~AsyncLogWriter();
+
+	AsyncLogWriter(const AsyncLogWriter&) = delete;
+	AsyncLogWriter& operator=(const AsyncLogWriter&) = delete;
+
+	void Start();
+
+	/**
+	 * @brief Stops the writer thread after it has written all of the queued messages.
+	*/
+	void Stop();
+
+	/**
+	 * @brief Waits until the messages that were queued before this call have been written
+	 * to the log file and the file has been flushed to disk.
+	*/
+	void Flush();
+
+	uint64_t GetDroppedMessageCount() const;
+
+	bool WriteLine(const char* const message, bool writeTimeStamp);
+
+	bool WriteLineFormatted(const char* const format, va_list args);
+
+	/**
+	 * @brief Writes a record that is copied to the log file without any formatting.
+	 * @param data The record data.
+	 * @param size The record size, must not be larger than BinaryLogFormat::MaxRecordSize.
+	*/
+	bool WriteBinaryRecord(const uint8_t* data, size_t size);
+
+private:
+
+	// Messages that are longer than this will be truncated.
+	static constexpr size_t MaxMessageLength = 500;
+	static constexpr size_t QueueCapacity = 1024;
+
+	static_assert(MaxMessageLength >= BinaryLogFormat::MaxRecordSize);
+
+	enum class RecordType : uint8_t
+	{
+		TextLine = 0,
+		Binary
+	};
+
+	struct LogRecord
+	{
+		SYSTEMTIME time;
+		uint32_t length;
+		RecordType type;
+		bool hasTimeStamp;
+		char message[MaxMessageLength + 1];
+	};
+
+	template <typename FillCallback> bool Enqueue(FillCallback&& fill);
+	void WakeWriterThread();
+	void WriterThreadProc();
+	size_t DrainQueue();
+
+	MappedLogFile& logFile;
+	const LogOverflowPolicy overflowPolicy;
+	BoundedMpscQueue<LogRecord, QueueCapacity> queue;
+	std::thread writerThread;
+	std::string batchBuffer;
+	std::atomic<uint32_t> wakeSignal;
+	std::atomic<bool> writerIdle;
+	std::atomic<bool> stopRequested;
+	// Flush increments the request count, the writer thread sets the completed count
+	// to the request count that it read before draining the queue once it has flushed the file.
+	std::atomic<uint64_t> fileFlushRequestCount;
+	std::atomic<uint64_t> fileFlushCompletedCount;
+	std::atomic<uint64_t> droppedCount;
+};
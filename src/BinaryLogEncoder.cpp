@@ -0,0 +1,378 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "BinaryLogEncoder.h"
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <Windows.h>
+
+using namespace BinaryLogFormat;
+
+namespace
+{
+	class RecordWriter
+	{
+	public:
+
+		RecordWriter(BinaryLogEncoder::RecordBuffer& buffer)
+			: buffer(buffer), position(0), overflow(false)
+		{
+		}
+
+		template <typename T>
+		void Write(T value)
+		{
+			WriteBytes(&value, sizeof(value));
+		}
+
+		void WriteBytes(const void* data, size_t size)
+		{
+			if (overflow || size > (buffer.size() - position))
+			{
+				overflow = true;
+				return;
+			}
+
+			std::memcpy(buffer.data() + position, data, size);
+			position += size;
+		}
+
+		// Writes a uint16 length prefixed string, the string is truncated if it does not fit.
+		void WriteString(const char* value, size_t maxLength)
+		{
+			const size_t available = buffer.size() - position;
+
+			if (overflow || available < sizeof(uint16_t))
+			{
+				overflow = true;
+				return;
+			}
+
+			size_t length = strnlen(value, maxLength);
+
+			if (length > (available - sizeof(uint16_t)))
+			{
+				length = available - sizeof(uint16_t);
+			}
+
+			Write(static_cast<uint16_t>(length));
+			WriteBytes(value, length);
+		}
+
+		size_t Position() const
+		{
+			return position;
+		}
+
+		bool Overflow() const
+		{
+			return overflow;
+		}
+
+	private:
+
+		BinaryLogEncoder::RecordBuffer& buffer;
+		size_t position;
+		bool overflow;
+	};
+
+	uint64_t GetTimeStamp()
+	{
+		FILETIME utcTime{};
+		FILETIME localTime{};
+
+		GetSystemTimeAsFileTime(&utcTime);
+		FileTimeToLocalFileTime(&utcTime, &localTime);
+
+		return (static_cast<uint64_t>(localTime.dwHighDateTime) << 32) | localTime.dwLowDateTime;
+	}
+
+	size_t GetCachedFormatIndex(const char* const format, size_t tableSize)
+	{
+		// Fibonacci hashing of the string address, the low bits are mostly alignment.
+		const uint64_t hash = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(format)) * 0x9E3779B97F4A7C15ULL;
+
+		return static_cast<size_t>(hash >> 32) & (tableSize - 1);
+	}
+}
+
+BinaryLogEncoder::BinaryLogEncoder()
+	: mutex(),
+	  formats(),
+	  cachedFormats(),
+	  nextFormatId(0),
+	  definitionRecordsMutex(),
+	  definitionRecords()
+{
+}
+
+size_t BinaryLogEncoder::EncodeFileHeader(RecordBuffer& buffer)
+{
+	RecordWriter writer(buffer);
+
+	writer.WriteBytes(Signature, sizeof(Signature));
+	writer.Write(Version);
+
+	return writer.Position();
+}
+
+size_t BinaryLogEncoder::EncodeHeader(const char* const message, RecordBuffer& buffer)
+{
+	RecordWriter writer(buffer);
+
+	writer.Write(RecordType::Header);
+	writer.WriteString(message, std::numeric_limits<uint16_t>::max());
+
+	return writer.Position();
+}
+
+size_t BinaryLogEncoder::EncodeMessage(const char* const message, RecordBuffer& buffer)
+{
+	RecordWriter writer(buffer);
+
+	writer.Write(RecordType::Message);
+	writer.Write(GetTimeStamp());
+	writer.WriteString(message, std::numeric_limits<uint16_t>::max());
+
+	return writer.Position();
+}
+
+size_t BinaryLogEncoder::EncodeFormattedMessage(
+	const char* const format,
+	va_list args,
+	RecordBuffer& buffer,
+	WriteRecordCallback writeDefinition,
+	void* context)
+{
+	const FormatDefinition* definition = GetFormatDefinition(format, writeDefinition, context);
+
+	if (!definition)
+	{
+		return 0;
+	}
+
+	RecordWriter writer(buffer);
+
+	writer.Write(RecordType::FormattedMessage);
+	writer.Write(GetTimeStamp());
+	writer.Write(definition->id);
+
+	// The argument data length is filled in after the arguments have been written.
+	const size_t argumentDataLengthOffset = writer.Position();
+	writer.Write(static_cast<uint16_t>(0));
+
+	// The caller may need to format the message if it does not fit in the record,
+	// so the original argument list must not be modified.
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+
+	for (PrintfArgumentType type : definition->argumentTypes)
+	{
+		switch (type)
+		{
+		case PrintfArgumentType::Int32:
+			writer.Write(va_arg(argsCopy, int32_t));
+			break;
+		case PrintfArgumentType::Int64:
+			writer.Write(va_arg(argsCopy, int64_t));
+			break;
+		case PrintfArgumentType::Float64:
+			writer.Write(va_arg(argsCopy, double));
+			break;
+		case PrintfArgumentType::String:
+		{
+			const char* value = va_arg(argsCopy, const char*);
+			writer.WriteString(value ? value : "(null)", std::numeric_limits<uint16_t>::max());
+			break;
+		}
+		case PrintfArgumentType::Pointer:
+			writer.Write(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(va_arg(argsCopy, void*))));
+			break;
+		case PrintfArgumentType::None:
+		default:
+			// The conversions without an argument are not added to the definition, the
+			// arguments after an unknown type would be read from the wrong position.
+			va_end(argsCopy);
+			return 0;
+		}
+	}
+
+	va_end(argsCopy);
+
+	if (writer.Overflow())
+	{
+		return 0;
+	}
+
+	const uint16_t argumentDataLength = static_cast<uint16_t>(writer.Position() - argumentDataLengthOffset - sizeof(uint16_t));
+	std::memcpy(buffer.data() + argumentDataLengthOffset, &argumentDataLength, sizeof(argumentDataLength));
+
+	return writer.Position();
+}
+
+void BinaryLogEncoder::AppendFormatDefinitions(std::string& buffer)
+{
+	std::scoped_lock lock(definitionRecordsMutex);
+
+	buffer.append(definitionRecords);
+}
+
+const BinaryLogEncoder::FormatDefinition* BinaryLogEncoder::GetFormatDefinition(
+	const char* const format,
+	WriteRecordCallback writeDefinition,
+	void* context)
+{
+	const FormatDefinition* definition = FindCachedFormatDefinition(format);
+
+	if (!definition)
+	{
+		std::scoped_lock lock(mutex);
+
+		const auto existing = formats.find(format);
+
+		if (existing != formats.end())
+		{
+			definition = &existing->second;
+		}
+		else
+		{
+			definition = &AddFormatDefinition(format, writeDefinition, context);
+
+			// The definition is cached after its record has been written, the threads that
+			// find it without the lock will write their messages after the definition.
+			CacheFormatDefinition(format, *definition);
+		}
+	}
+
+	return definition->supported ? definition : nullptr;
+}
+
+const BinaryLogEncoder::FormatDefinition* BinaryLogEncoder::FindCachedFormatDefinition(const char* const format) const
+{
+	size_t index = GetCachedFormatIndex(format, cachedFormats.size());
+
+	for (size_t i = 0; i < cachedFormats.size(); i++)
+	{
+		const CachedFormat& entry = cachedFormats[index];
+		const char* const entryFormat = entry.format.load(std::memory_order_acquire);
+
+		if (entryFormat == format)
+		{
+			return entry.definition.load(std::memory_order_relaxed);
+		}
+		else if (!entryFormat)
+		{
+			return nullptr;
+		}
+
+		index = (index + 1) & (cachedFormats.size() - 1);
+	}
+
+	return nullptr;
+}
+
+void BinaryLogEncoder::CacheFormatDefinition(const char* const format, const FormatDefinition& definition)
+{
+	size_t index = GetCachedFormatIndex(format, cachedFormats.size());
+
+	for (size_t i = 0; i < cachedFormats.size(); i++)
+	{
+		CachedFormat& entry = cachedFormats[index];
+
+		if (!entry.format.load(std::memory_order_relaxed))
+		{
+			// The definition is stored first, the release store of the format publishes it.
+			entry.definition.store(&definition, std::memory_order_relaxed);
+			entry.format.store(format, std::memory_order_release);
+			return;
+		}
+
+		index = (index + 1) & (cachedFormats.size() - 1);
+	}
+}
+
+const BinaryLogEncoder::FormatDefinition& BinaryLogEncoder::AddFormatDefinition(
+	const char* const format,
+	WriteRecordCallback writeDefinition,
+	void* context)
+{
+	FormatDefinition& definition = formats.emplace(format, FormatDefinition()).first->second;
+	definition.supported = false;
+
+	if (nextFormatId > std::numeric_limits<uint16_t>::max())
+	{
+		return definition;
+	}
+
+	const std::string_view formatView(format);
+	PrintfConversion conversion{};
+
+	for (size_t offset = 0; PrintfFormat::FindNextConversion(formatView, offset, conversion); offset = conversion.offset + conversion.length)
+	{
+		if (!PrintfFormat::IsSupported(conversion))
+		{
+			// The arguments after this conversion would be read from the wrong position,
+			// the caller will format these messages before they are written.
+			return definition;
+		}
+
+		for (uint8_t i = 0; i < conversion.starArgumentCount; i++)
+		{
+			definition.argumentTypes.push_back(PrintfArgumentType::Int32);
+		}
+
+		if (conversion.argumentType != PrintfArgumentType::None)
+		{
+			definition.argumentTypes.push_back(conversion.argumentType);
+		}
+	}
+
+	const size_t argumentCount = definition.argumentTypes.size();
+
+	// RecordType + format id + format length + argument count + argument types.
+	const size_t definitionSize = sizeof(RecordType) + (2 * sizeof(uint16_t)) + sizeof(uint8_t) + argumentCount;
+
+	if (argumentCount > std::numeric_limits<uint8_t>::max()
+		|| formatView.size() > (MaxRecordSize - definitionSize))
+	{
+		// The format string is too long to fit in a record, the caller
+		// will format these messages before they are written.
+		return definition;
+	}
+
+	definition.id = static_cast<uint16_t>(nextFormatId);
+	definition.supported = true;
+	nextFormatId++;
+
+	RecordBuffer record;
+	RecordWriter writer(record);
+
+	writer.Write(RecordType::FormatDefinition);
+	writer.Write(definition.id);
+	writer.WriteString(format, formatView.size());
+	writer.Write(static_cast<uint8_t>(argumentCount));
+	writer.WriteBytes(definition.argumentTypes.data(), argumentCount);
+
+	{
+		std::scoped_lock definitionRecordsLock(definitionRecordsMutex);
+
+		definitionRecords.append(reinterpret_cast<const char*>(record.data()), writer.Position());
+	}
+
+	// The definition is written while the lock is held, this guarantees that it
+	// is in the log before any message that uses it.
+	writeDefinition(record.data(), writer.Position(), context);
+
+	return definition;
+}
@@ -0,0 +1,132 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "BinaryLogFormat.h"
+#include "PrintfFormat.h"
+#include <array>
+#include <atomic>
+#include <cstdarg>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Encodes log messages in the binary log format, see BinaryLogFormat.h.
+//
+// Formatted messages are not formatted when they are logged, the record only contains
+// a format id, the time stamp and the raw argument values. The format string is written
+// once, in a FormatDefinition record, the first time it is used.
+class BinaryLogEncoder
+{
+public:
+
+	using RecordBuffer = std::array<uint8_t, BinaryLogFormat::MaxRecordSize>;
+	using WriteRecordCallback = void(*)(const uint8_t* data, size_t size, void* context);
+
+	static constexpr size_t FileHeaderSize = sizeof(BinaryLogFormat::Signature) + sizeof(uint32_t);
+
+	BinaryLogEncoder();
+
+	static size_t EncodeFileHeader(RecordBuffer& buffer);
+
+	static size_t EncodeHeader(const char* const message, RecordBuffer& buffer);
+
+	static size_t EncodeMessage(const char* const message, RecordBuffer& buffer);
+
+	/**
+	 * @brief Encodes a formatted message record.
+	 * @param format The printf format string, it must have static storage duration.
+	 * @param args The format arguments.
+	 * @param buffer The buffer that receives the record.
+	 * @param writeDefinition A callback that writes the FormatDefinition record for a new format string.
+	 * @param context The context value for the callback.
+	 * @return The size of the record, or zero if the message cannot be represented as a
+	 * FormattedMessage record and must be formatted by the caller.
+	*/
+	size_t EncodeFormattedMessage(
+		const char* const format,
+		va_list args,
+		RecordBuffer& buffer,
+		WriteRecordCallback writeDefinition,
+		void* context);
+
+	/**
+	 * @brief Appends the FormatDefinition records for all of the format strings that have been used.
+	 * This is used to start a new log file when the current file is rotated.
+	 * @param buffer The buffer that receives the records.
+	*/
+	void AppendFormatDefinitions(std::string& buffer);
+
+private:
+
+	struct FormatDefinition
+	{
+		uint16_t id;
+		// False if the format cannot be written as a FormattedMessage record.
+		bool supported;
+		std::vector<PrintfArgumentType> argumentTypes;
+	};
+
+	// An entry in the lock-free lookup table for the format definitions that have been created.
+	struct CachedFormat
+	{
+		std::atomic<const char*> format;
+		std::atomic<const FormatDefinition*> definition;
+	};
+
+	// The table has room for several times the number of format strings in the plugin, the
+	// formats that do not fit are still found in the formats map.
+	static constexpr size_t CachedFormatCount = 1024;
+	static_assert((CachedFormatCount & (CachedFormatCount - 1)) == 0, "CachedFormatCount must be a power of 2.");
+
+	const FormatDefinition* GetFormatDefinition(
+		const char* const format,
+		WriteRecordCallback writeDefinition,
+		void* context);
+
+	/**
+	 * @brief Finds a format definition without taking the lock.
+	 * @return The definition, or nullptr if the format has not been cached.
+	*/
+	const FormatDefinition* FindCachedFormatDefinition(const char* const format) const;
+
+	/**
+	 * @brief Adds a format definition to the lookup table, the caller must hold the lock.
+	*/
+	void CacheFormatDefinition(const char* const format, const FormatDefinition& definition);
+
+	/**
+	 * @brief Parses a new format string and writes its FormatDefinition record, the caller must hold the lock.
+	 * @return The definition, its supported flag is false if the format cannot be written
+	 * as a FormattedMessage record.
+	*/
+	const FormatDefinition& AddFormatDefinition(
+		const char* const format,
+		WriteRecordCallback writeDefinition,
+		void* context);
+
+	std::mutex mutex;
+	// The format strings are string literals, so they are identified by their address.
+	// The map nodes are not moved when the map grows, so the cached pointers remain valid.
+	std::unordered_map<const char*, FormatDefinition> formats;
+	// The definitions are looked up for every formatted message, this table lets the
+	// formats that have already been seen skip the lock. It is only written while holding the lock.
+	std::array<CachedFormat, CachedFormatCount> cachedFormats;
+	uint32_t nextFormatId;
+	// A copy of the FormatDefinition records. This has a separate lock because it is read
+	// by the log writer when it starts a new file, which may happen while the writer is
+	// holding the main lock to write a new definition.
+	std::mutex definitionRecordsMutex;
+	std::string definitionRecords;
+};
@@ -0,0 +1,47 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// The layout of the binary log file, this header is shared with the log decoder tool.
+//
+// The file starts with the 8 byte signature and a uint32 version, followed by a list of records.
+// All values are little-endian. Every record starts with a uint8 RecordType value:
+//
+// FormatDefinition: uint16 format id, uint16 format length, the format string (no null terminator),
+//                   uint8 argument count, and a PrintfArgumentType value for each argument.
+// FormattedMessage: uint64 time stamp, uint16 format id, uint16 argument data length, argument data.
+// Message:          uint64 time stamp, uint16 message length, the message string.
+// Header:           uint16 message length, the message string.
+//
+// The time stamp is a Windows FILETIME value in local time.
+// The argument data is written in the order of the argument types in the format definition,
+// Int32 is 4 bytes, Int64, Float64 and Pointer are 8 bytes, String is a uint16 length followed by the string.
+namespace BinaryLogFormat
+{
+	static constexpr char Signature[8] = { 'S', 'C', '4', 'L', 'G', 'L', 'O', 'G' };
+	static constexpr uint32_t Version = 1;
+
+	// The maximum size of a single record, including the RecordType value.
+	static constexpr size_t MaxRecordSize = 496;
+
+	enum class RecordType : uint8_t
+	{
+		FormatDefinition = 1,
+		FormattedMessage = 2,
+		Message = 3,
+		Header = 4
+	};
+}
@@ -0,0 +1,144 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// A bounded lock-free queue that supports multiple producers and a single consumer.
+// Based on Dmitry Vyukov's bounded MPMC queue, every cell has a sequence number that
+// tells the producers and the consumer whether the cell is free or holds a value.
+//
+// The items are filled and read in place, this avoids copying the (large) log records
+// into and out of the queue.
+template <typename T, size_t Capacity>
+class BoundedMpscQueue
+{
+	static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2.");
+
+public:
+
+	BoundedMpscQueue()
+		: cells(std::make_unique<Cell[]>(Capacity)),
+		  enqueuePosition(0),
+		  dequeuePosition(0)
+	{
+		for (size_t i = 0; i < Capacity; i++)
+		{
+			cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+	BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+	/**
+	 * @brief Attempts to add an item to the queue.
+	 * @param fill A callback that initializes the item in place, it must not throw.
+	 * @return True if the item was added; otherwise, false if the queue is full.
+	*/
+	template <typename FillCallback>
+	bool TryEnqueue(FillCallback&& fill)
+	{
+		Cell* cell = nullptr;
+		size_t position = enqueuePosition.load(std::memory_order_relaxed);
+
+		for (;;)
+		{
+			cell = &cells[position & IndexMask];
+
+			const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+			const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+			if (difference == 0)
+			{
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// The queue is full.
+				return false;
+			}
+			else
+			{
+				// Another producer claimed the cell, reload the position and try again.
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		fill(cell->item);
+		cell->sequence.store(position + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	/**
+	 * @brief Attempts to remove an item from the queue.
+	 * This method must only be called from the consumer thread.
+	 * @param read A callback that reads the item in place.
+	 * @return True if an item was removed; otherwise, false if the queue is empty.
+	*/
+	template <typename ReadCallback>
+	bool TryDequeue(ReadCallback&& read)
+	{
+		Cell& cell = cells[dequeuePosition & IndexMask];
+
+		const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+
+		if (static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePosition + 1) < 0)
+		{
+			return false;
+		}
+
+		read(cell.item);
+		cell.sequence.store(dequeuePosition + Capacity, std::memory_order_release);
+		++dequeuePosition;
+
+		return true;
+	}
+
+	/**
+	 * @brief Gets a value indicating whether the queue has no items that are ready to be read.
+	 * This method must only be called from the consumer thread.
+	*/
+	bool IsEmpty() const
+	{
+		const Cell& cell = cells[dequeuePosition & IndexMask];
+
+		const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+
+		return static_cast<intptr_t>(sequence) - static_cast<intptr_t>(dequeuePosition + 1) < 0;
+	}
+
+private:
+
+	static constexpr size_t IndexMask = Capacity - 1;
+	static constexpr size_t CacheLineSize = 64;
+
+	struct Cell
+	{
+		std::atomic<size_t> sequence;
+		T item;
+	};
+
+	std::unique_ptr<Cell[]> cells;
+	// The producer and consumer positions are placed on separate cache lines
+	// to prevent false sharing between the game thread and the writer thread.
+	alignas(CacheLineSize) std::atomic<size_t> enqueuePosition;
+	alignas(CacheLineSize) size_t dequeuePosition;
+};
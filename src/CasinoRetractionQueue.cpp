@@ -0,0 +1,390 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "CasinoRetractionQueue.h"
+#include "Logger.h"
+#include "RewardOccupantIndex.h"
+#include "TraceSpan.h"
+#include "cIGZMessageServer2.h"
+#include "cIGZWin.h"
+#include "cISC4App.h"
+#include "cISC4City.h"
+#include "cISC4CivicBuildingSimulator.h"
+#include "cISC4Lot.h"
+#include "cISC4LotDeveloper.h"
+#include "cISC4LotManager.h"
+#include "cISC4Occupant.h"
+#include "cISC4OccupantManager.h"
+#include "cISC4View3DWin.h"
+#include "cISC4ViewInputControl.h"
+#include "GZCLSIDDefs.h"
+#include "GZServPtrs.h"
+
+static const uint32_t kGZWin_WinSC4App = 0x6104489A;
+static const uint32_t kSC4CLSID_cSC4View3DWin = 0x9A47B417;
+
+static const uint32_t kGZIID_cISC4View3DWin = 0xFA47B3F9;
+
+static const uint32_t kOccupantType_Building = 0x278128A0;
+
+static const uint32_t kCasinoCityExclusionGroup = 0xCA78B74B;
+
+namespace
+{
+	struct CasinoIteratorData
+	{
+		CasinoIteratorData() : casinoOccupant(nullptr)
+		{
+		}
+
+		cISC4Occupant* casinoOccupant;
+	};
+
+	static bool CasinoIterator(cISC4Occupant* pOccupant, void* pData)
+	{
+		uint32_t cityExclusionGroup = 0;
+
+		if (RewardOccupantIndex::TryGetCityExclusionGroup(pOccupant, cityExclusionGroup)
+			&& cityExclusionGroup == kCasinoCityExclusionGroup)
+		{
+			CasinoIteratorData* data = static_cast<CasinoIteratorData*>(pData);
+
+			data->casinoOccupant = pOccupant;
+
+			// Stop the enumeration.
+			return false;
+		}
+
+		return true;
+	}
+
+	cISC4Occupant* GetCasinoOccupant(cISC4City* pCity, const RewardOccupantIndex& rewardOccupantIndex)
+	{
+		if (rewardOccupantIndex.IsBuilt())
+		{
+			return rewardOccupantIndex.Find(kCasinoCityExclusionGroup);
+		}
+
+		// The index is only available after the city has been initialized,
+		// until then every building in the city is checked.
+
+		cISC4OccupantManager* pOccupantManager = pCity->GetOccupantManager();
+
+		if (pOccupantManager)
+		{
+			CasinoIteratorData iteratorData;
+
+			pOccupantManager->IterateOccupants(CasinoIterator, &iteratorData, nullptr, nullptr, kOccupantType_Building);
+
+			return iteratorData.casinoOccupant;
+		}
+
+		return nullptr;
+	}
+
+	void DemolishCasino(cISC4City* pCity, const RewardOccupantIndex& rewardOccupantIndex)
+	{
+		TraceSpan span("DemolishCasino");
+
+		cISC4Occupant* pCasinoOccupant = GetCasinoOccupant(pCity, rewardOccupantIndex);
+
+		if (pCasinoOccupant)
+		{
+			cISC4LotManager* pLotManager = pCity->GetLotManager();
+
+			if (pLotManager)
+			{
+				cISC4Lot* pCasinoLot = pLotManager->GetOccupantLot(pCasinoOccupant);
+
+				if (pCasinoLot)
+				{
+					cISC4LotDeveloper* pLotDeveloper = pCity->GetLotDeveloper();
+
+					if (pLotDeveloper)
+					{
+						pLotDeveloper->StartDemolishLot(pCasinoLot);
+						pLotDeveloper->EndDemolishLot(pCasinoLot);
+					}
+				}
+			}
+		}
+	}
+
+	void DisableCasinoMenuItem(cISC4City* pCity, cISC4View3DWin* pView3DWin)
+	{
+		TraceSpan span("DisableCasinoMenuItem");
+
+		constexpr uint32_t casinoBuildingID = 0x33a0000;
+
+		// Disable the Casino item in the Rewards menu.
+
+		cISC4CivicBuildingSimulator* pCivicBuildingSim = pCity->GetCivicBuildingSimulator();
+
+		if (pCivicBuildingSim)
+		{
+			const cISC4CivicBuildingSimulator::ConditionalBuildingStatus* status = pCivicBuildingSim->GetConditionalBuildingStatus(casinoBuildingID);
+
+			if (status)
+			{
+				constexpr int16_t Status_BuildingDisabled = 1;
+
+				// We create a copy of the existing ConditionalBuildingStatus class and
+				// disable the Casino building in the Rewards menu.
+
+				cISC4CivicBuildingSimulator::ConditionalBuildingStatus newStatus(*status);
+				newStatus.status = Status_BuildingDisabled;
+
+				pCivicBuildingSim->UpdateConditionalBuildingStatus(casinoBuildingID, &newStatus);
+			}
+		}
+
+		// Turn off the Place Lot control, if it is active.
+
+		if (pView3DWin)
+		{
+			cISC4ViewInputControl* pCurrentViewInputControl = pView3DWin->GetCurrentViewInputControl();
+
+			if (pCurrentViewInputControl)
+			{
+				constexpr uint32_t placeLotViewInputControl = 0x88F154FBl;
+
+				if (pCurrentViewInputControl->GetID() == placeLotViewInputControl)
+				{
+					pView3DWin->RemoveCurrentViewInputControl(false);
+				}
+			}
+		}
+	}
+}
+
+CasinoRetractionQueue::ProcessMessageTarget::ProcessMessageTarget(CasinoRetractionQueue& queue)
+	: queue(queue),
+	  refCount(0)
+{
+}
+
+bool CasinoRetractionQueue::ProcessMessageTarget::QueryInterface(uint32_t riid, void** ppvObj)
+{
+	if (riid == GZCLSID::kcIGZMessageTarget2)
+	{
+		AddRef();
+		*ppvObj = static_cast<cIGZMessageTarget2*>(this);
+
+		return true;
+	}
+	else if (riid == GZIID_cIGZUnknown)
+	{
+		AddRef();
+		*ppvObj = static_cast<cIGZUnknown*>(this);
+
+		return true;
+	}
+
+	return false;
+}
+
+uint32_t CasinoRetractionQueue::ProcessMessageTarget::AddRef()
+{
+	return ++refCount;
+}
+
+uint32_t CasinoRetractionQueue::ProcessMessageTarget::Release()
+{
+	// The target is owned by the queue, it is not deleted when the last reference is released.
+	if (refCount > 0)
+	{
+		--refCount;
+	}
+
+	return refCount;
+}
+
+bool CasinoRetractionQueue::ProcessMessageTarget::DoMessage(cIGZMessage2* pMessage)
+{
+	if (pMessage->GetType() == kProcessPendingActionsMessageID)
+	{
+		queue.processMessagePosted = false;
+		queue.ProcessPendingActions();
+	}
+
+	return true;
+}
+
+CasinoRetractionQueue::CasinoRetractionQueue(const RewardOccupantIndex& rewardOccupantIndex)
+	: rewardOccupantIndex(rewardOccupantIndex),
+	  processMessage(),
+	  processMessageTarget(*this),
+	  pCity(nullptr),
+	  pView3DWin(nullptr),
+	  pendingActions(PendingAction::None),
+	  processMessagePosted(false)
+{
+	processMessage.SetType(kProcessPendingActionsMessageID);
+}
+
+CasinoRetractionQueue::~CasinoRetractionQueue()
+{
+	// The message server must not deliver a message to the target after it is destroyed.
+	CancelProcessMessage();
+	ReleaseView3DWin();
+}
+
+void CasinoRetractionQueue::Start(cISC4City* pCity)
+{
+	this->pCity = pCity;
+}
+
+void CasinoRetractionQueue::Stop()
+{
+	// The city is still valid when it is about to be shut down, so a retraction that was
+	// requested before the shutdown is run now instead of being lost with the posted message.
+	ProcessPendingActions();
+	CancelProcessMessage();
+
+	pCity = nullptr;
+
+	ReleaseView3DWin();
+}
+
+void CasinoRetractionQueue::RequestRetraction()
+{
+	pendingActions |= PendingAction::DemolishCasinoLot | PendingAction::DisableCasinoMenu;
+
+	if (!processMessagePosted && !PostProcessMessage())
+	{
+		ProcessPendingActions();
+	}
+}
+
+void CasinoRetractionQueue::CancelRetraction()
+{
+	// A message that is already posted is left in the queue, it has nothing to process when it arrives.
+	pendingActions = PendingAction::None;
+}
+
+void CasinoRetractionQueue::ProcessPendingActions()
+{
+	if (pendingActions == PendingAction::None)
+	{
+		return;
+	}
+
+	TraceSpan span("CasinoRetractionQueue::ProcessPendingActions");
+
+	const uint32_t actions = pendingActions;
+	pendingActions = PendingAction::None;
+
+	cISC4City* pActiveCity = pCity;
+
+	if (!pActiveCity)
+	{
+		cISC4AppPtr pSC4App;
+
+		if (pSC4App)
+		{
+			pActiveCity = pSC4App->GetCity();
+		}
+	}
+
+	if (pActiveCity)
+	{
+		if ((actions & PendingAction::DemolishCasinoLot) != 0)
+		{
+			DemolishCasino(pActiveCity, rewardOccupantIndex);
+		}
+
+		if ((actions & PendingAction::DisableCasinoMenu) != 0)
+		{
+			DisableCasinoMenuItem(pActiveCity, GetView3DWin());
+		}
+	}
+}
+
+bool CasinoRetractionQueue::PostProcessMessage()
+{
+	// The message is only posted while a city is running, before the queue is started
+	// the actions are run immediately.
+	if (pCity)
+	{
+		cIGZMessageServer2Ptr pMsgServ;
+
+		if (pMsgServ && pMsgServ->GeneralMessagePostToTarget(static_cast<cIGZMessage2Standard*>(&processMessage), &processMessageTarget))
+		{
+			processMessagePosted = true;
+			return true;
+		}
+
+		Logger::GetInstance().WriteLine(
+			LogOptions::Errors,
+			"Failed to queue the Casino retraction, it will be run immediately.");
+	}
+
+	return false;
+}
+
+void CasinoRetractionQueue::CancelProcessMessage()
+{
+	if (processMessagePosted)
+	{
+		cIGZMessageServer2Ptr pMsgServ;
+
+		if (pMsgServ)
+		{
+			// Only the queue posts messages to its target, the other messages are not affected.
+			pMsgServ->CancelGeneralMessagePostsToTarget(&processMessageTarget);
+		}
+
+		processMessagePosted = false;
+	}
+}
+
+cISC4View3DWin* CasinoRetractionQueue::GetView3DWin()
+{
+	// The 3D view window is found once per city, the cached window is
+	// released when the queue is stopped.
+	if (!pView3DWin)
+	{
+		cISC4AppPtr pSC4App;
+
+		if (pSC4App)
+		{
+			cIGZWin* pMainWin = pSC4App->GetMainWindow();
+
+			if (pMainWin)
+			{
+				cIGZWin* pParentWin = pMainWin->GetChildWindowFromID(kGZWin_WinSC4App);
+
+				if (pParentWin)
+				{
+					cISC4View3DWin* pWin = nullptr;
+
+					if (pParentWin->GetChildAs(kSC4CLSID_cSC4View3DWin, kGZIID_cISC4View3DWin, reinterpret_cast<void**>(&pWin)))
+					{
+						pView3DWin = pWin;
+					}
+				}
+			}
+		}
+	}
+
+	return pView3DWin;
+}
+
+void CasinoRetractionQueue::ReleaseView3DWin()
+{
+	if (pView3DWin)
+	{
+		pView3DWin->Release();
+		pView3DWin = nullptr;
+	}
+}
@@ -0,0 +1,115 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "cIGZMessageTarget2.h"
+#include "cRZMessage2Standard.h"
+#include <cstdint>
+
+class cISC4City;
+class cISC4View3DWin;
+class RewardOccupantIndex;
+
+// Runs the actions that retract the Legalize Gambling ordinance outside of the UI callback
+// that turned the ordinance off.
+//
+// A retraction request only records the pending actions and posts a message to a target
+// that the queue owns, the message server delivers it on its next tick and the target then
+// calls ProcessPendingActions.
+// At most one message is posted at a time, so repeated requests are coalesced into a single
+// run of the actions, and a request that is cancelled before the message arrives does nothing.
+class CasinoRetractionQueue
+{
+public:
+
+	explicit CasinoRetractionQueue(const RewardOccupantIndex& rewardOccupantIndex);
+	~CasinoRetractionQueue();
+
+	CasinoRetractionQueue(const CasinoRetractionQueue&) = delete;
+	CasinoRetractionQueue& operator=(const CasinoRetractionQueue&) = delete;
+
+	/**
+	 * @brief Starts queuing the retraction actions for the specified city.
+	 * @param pCity The city.
+	*/
+	void Start(cISC4City* pCity);
+
+	/**
+	 * @brief Runs the pending actions and releases the cached game objects.
+	 * This must be called before the city is shut down, while the city is still valid.
+	*/
+	void Stop();
+
+	/**
+	 * @brief Queues the demolition of the Casino and the removal of its menu item.
+	 * If the queue has not been started, the actions are run immediately.
+	*/
+	void RequestRetraction();
+
+	/**
+	 * @brief Discards the pending retraction actions, e.g. when the ordinance is turned back on.
+	*/
+	void CancelRetraction();
+
+	/**
+	 * @brief Runs the pending actions, the target calls this when it receives the process message.
+	*/
+	void ProcessPendingActions();
+
+private:
+
+	// The message that the target receives when the pending actions should be processed.
+	static constexpr uint32_t kProcessPendingActionsMessageID = 0x8B1E5A37;
+
+	// The target of the process message.
+	// Cancelling the messages that are posted to this target only removes the queue's own
+	// message, the other messages that are posted to the DLL director are not affected.
+	class ProcessMessageTarget : public cIGZMessageTarget2
+	{
+	public:
+
+		explicit ProcessMessageTarget(CasinoRetractionQueue& queue);
+
+		bool QueryInterface(uint32_t riid, void** ppvObj) override;
+		uint32_t AddRef() override;
+		uint32_t Release() override;
+
+		bool DoMessage(cIGZMessage2* pMessage) override;
+
+	private:
+
+		CasinoRetractionQueue& queue;
+		uint32_t refCount;
+	};
+
+	enum PendingAction : uint32_t
+	{
+		None = 0,
+		DemolishCasinoLot = 1 << 0,
+		DisableCasinoMenu = 1 << 1,
+	};
+
+	bool PostProcessMessage();
+	void CancelProcessMessage();
+
+	cISC4View3DWin* GetView3DWin();
+	void ReleaseView3DWin();
+
+	const RewardOccupantIndex& rewardOccupantIndex;
+	cRZMessage2Standard processMessage;
+	ProcessMessageTarget processMessageTarget;
+	cISC4City* pCity;
+	cISC4View3DWin* pView3DWin;
+	uint32_t pendingActions;
+	bool processMessagePosted;
+};
@@ -0,0 +1,67 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "CensusSnapshot.h"
+#include "cISC4City.h"
+#include "cISC4Demand.h"
+#include "cISC4DemandSimulator.h"
+
+namespace
+{
+	// The census values for the whole city, the other indexes are for the
+	// neighbor connections.
+	constexpr uint32_t CityCensusIndex = 0;
+}
+
+CensusSnapshot::CensusSnapshot()
+	: values(),
+	  demands(),
+	  pDemandSimulator(nullptr)
+{
+}
+
+void CensusSnapshot::SetCity(cISC4City* pCity)
+{
+	pDemandSimulator = pCity ? pCity->GetDemandSimulator() : nullptr;
+
+	values.fill(0.0f);
+	demands.fill(nullptr);
+}
+
+void CensusSnapshot::Capture(CensusGroupSet groups)
+{
+	for (size_t i = 0; i < GroupCount; i++)
+	{
+		if ((groups & ToCensusGroupSet(static_cast<CensusGroup>(i))) == 0)
+		{
+			values[i] = 0.0f;
+			continue;
+		}
+
+		const cISC4Demand* demand = GetDemand(i);
+
+		values[i] = demand ? demand->QuerySupplyValue() : 0.0f;
+	}
+}
+
+const cISC4Demand* CensusSnapshot::GetDemand(size_t index)
+{
+	// A demand object may not exist yet when the city is initialized,
+	// the lookup is retried until it has been found.
+	if (!demands[index] && pDemandSimulator)
+	{
+		demands[index] = pDemandSimulator->GetDemand(CensusGroupDemandIDs[index], CityCensusIndex);
+	}
+
+	return demands[index];
+}
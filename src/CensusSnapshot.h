@@ -0,0 +1,121 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+class cISC4City;
+class cISC4Demand;
+class cISC4DemandSimulator;
+
+// The census groups of the city's residential, commercial and industrial zones.
+enum class CensusGroup : uint32_t
+{
+	ResidentialLowWealth = 0,
+	ResidentialMedWealth,
+	ResidentialHighWealth,
+	CommercialServiceLowWealth,
+	CommercialServiceMedWealth,
+	CommercialServiceHighWealth,
+	CommercialOfficeMedWealth,
+	CommercialOfficeHighWealth,
+	IndustrialResource,
+	IndustrialDirty,
+	IndustrialManufacturing,
+	IndustrialHighTech,
+	Count
+};
+
+// The demand IDs of the census groups, in CensusGroup order.
+inline constexpr std::array<uint32_t, static_cast<size_t>(CensusGroup::Count)> CensusGroupDemandIDs =
+{
+	0x1011, // R$
+	0x1021, // R$$
+	0x1031, // R$$$
+	0x3110, // Cs$
+	0x3120, // Cs$$
+	0x3130, // Cs$$$
+	0x3320, // Co$$
+	0x3330, // Co$$$
+	0x4100, // I-R
+	0x4200, // I-D
+	0x4300, // I-M
+	0x4400, // I-HT
+};
+
+// A set of census groups, bit N is set for the CensusGroup with the value N.
+using CensusGroupSet = uint32_t;
+
+constexpr CensusGroupSet ToCensusGroupSet(CensusGroup group)
+{
+	return static_cast<CensusGroupSet>(1) << static_cast<uint32_t>(group);
+}
+
+// The residential wealth groups that the built-in income calculation uses.
+inline constexpr CensusGroupSet ResidentialCensusGroups =
+	ToCensusGroupSet(CensusGroup::ResidentialLowWealth)
+	| ToCensusGroupSet(CensusGroup::ResidentialMedWealth)
+	| ToCensusGroupSet(CensusGroup::ResidentialHighWealth);
+
+// The population or job count of each census group, in CensusGroup order.
+using CensusValues = std::array<float, static_cast<size_t>(CensusGroup::Count)>;
+
+// A copy of the city's census values that is captured in a single pass.
+//
+// Each demand object is looked up once, capturing the snapshot only reads the supply
+// values of the groups that the calculation uses. The calculations then read the values
+// from the snapshot instead of calling into the game for each group.
+class CensusSnapshot
+{
+public:
+
+	CensusSnapshot();
+
+	/**
+	 * @brief Resolves the demand objects of the specified city.
+	 * @param pCity The city, or nullptr if no city is loaded.
+	*/
+	void SetCity(cISC4City* pCity);
+
+	/**
+	 * @brief Reads the current census values of the specified groups from the game.
+	 * @param groups The groups to read, the values of the other groups are set to 0.
+	*/
+	void Capture(CensusGroupSet groups);
+
+	/**
+	 * @brief Gets the population or job count of the group when the snapshot was captured.
+	*/
+	float GetValue(CensusGroup group) const
+	{
+		return values[static_cast<size_t>(group)];
+	}
+
+	const CensusValues& GetValues() const
+	{
+		return values;
+	}
+
+private:
+
+	static constexpr size_t GroupCount = static_cast<size_t>(CensusGroup::Count);
+
+	const cISC4Demand* GetDemand(size_t index);
+
+	// The values are read together, they are kept in a single cache line.
+	alignas(64) CensusValues values;
+	std::array<cISC4Demand*, GroupCount> demands;
+	cISC4DemandSimulator* pDemandSimulator;
+};
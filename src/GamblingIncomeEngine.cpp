@@ -0,0 +1,109 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "GamblingIncomeEngine.h"
+#include "Logger.h"
+#include "cISC4City.h"
+#include "cISC4Simulator.h"
+
+GamblingIncomeEngine::GamblingIncomeEngine()
+	: census(),
+	  pSimulator(nullptr),
+	  model(),
+	  breakdown(),
+	  breakdownDateNumber(0),
+	  breakdownValid(false)
+{
+}
+
+void GamblingIncomeEngine::SetCity(cISC4City* pCity)
+{
+	census.SetCity(pCity);
+	pSimulator = pCity ? pCity->GetSimulator() : nullptr;
+
+	Invalidate();
+}
+
+void GamblingIncomeEngine::SetIncomeParameters(
+	int64_t baseMonthlyIncome,
+	float residentialLowWealthFactor,
+	float residentialMedWealthFactor,
+	float residentialHighWealthFactor,
+	const IncomeFormula& incomeFormula)
+{
+	model.SetParameters(
+		baseMonthlyIncome,
+		residentialLowWealthFactor,
+		residentialMedWealthFactor,
+		residentialHighWealthFactor,
+		incomeFormula);
+
+	Invalidate();
+}
+
+void GamblingIncomeEngine::Invalidate()
+{
+	breakdownValid = false;
+}
+
+const GamblingIncomeBreakdown& GamblingIncomeEngine::GetBreakdown()
+{
+	// The cache is keyed on the simulation day, the population that the income is based on
+	// can change every day. Without a simulator the income is calculated on every call.
+	if (pSimulator)
+	{
+		const int32_t dateNumber = pSimulator->GetSimDateNumber();
+
+		if (!breakdownValid || dateNumber != breakdownDateNumber)
+		{
+			Calculate();
+
+			breakdownDateNumber = dateNumber;
+			breakdownValid = true;
+		}
+	}
+	else
+	{
+		Calculate();
+	}
+
+	return breakdown;
+}
+
+void GamblingIncomeEngine::Calculate()
+{
+	// Only the groups that the calculation uses are read from the game, the built-in
+	// calculation needs the three residential wealth groups.
+	census.Capture(model.RequiredCensusGroups());
+
+	breakdown = model.Calculate(census.GetValues());
+
+	if (!model.MonthlyIncomeFormula().IsEmpty())
+	{
+		Logger::GetInstance().WriteLineFormatted<LogOptions::OrdinanceAPI>(
+			"%s: monthly income from the income formula: current=%lld",
+			__FUNCTION__,
+			breakdown.totalIncome);
+	}
+	else
+	{
+		Logger::GetInstance().WriteLineFormatted<LogOptions::OrdinanceAPI>(
+			"%s: monthly income: base=%lld, R$ factor=%f, R$$ factor=%f, R$$$ factor=%f, current=%lld",
+			__FUNCTION__,
+			model.BaseMonthlyIncome(),
+			model.ResidentialLowWealthFactor(),
+			model.ResidentialMedWealthFactor(),
+			model.ResidentialHighWealthFactor(),
+			breakdown.totalIncome);
+	}
+}
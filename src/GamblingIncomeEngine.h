@@ -0,0 +1,71 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "CensusSnapshot.h"
+#include "GamblingIncomeModel.h"
+#include "IncomeFormula.h"
+#include <cstdint>
+
+class cISC4City;
+class cISC4Simulator;
+
+// Calculates the monthly income of the Legalize Gambling ordinance from the city's
+// residential population, or with the income formula from the settings file.
+//
+// The game queries the income several times during a simulation month, e.g. when the
+// budget window is open. The result is cached until the simulation date changes or the
+// income parameters are modified, so the repeated queries do not call into the game's
+// demand simulator.
+class GamblingIncomeEngine
+{
+public:
+
+	GamblingIncomeEngine();
+
+	/**
+	 * @brief Starts using the simulators of the specified city.
+	 * @param pCity The city, or nullptr if no city is loaded.
+	*/
+	void SetCity(cISC4City* pCity);
+
+	void SetIncomeParameters(
+		int64_t baseMonthlyIncome,
+		float residentialLowWealthFactor,
+		float residentialMedWealthFactor,
+		float residentialHighWealthFactor,
+		const IncomeFormula& incomeFormula);
+
+	/**
+	 * @brief Discards the cached income, the next query recalculates it.
+	*/
+	void Invalidate();
+
+	/**
+	 * @brief Gets the monthly income for the current simulation date.
+	*/
+	const GamblingIncomeBreakdown& GetBreakdown();
+
+private:
+
+	void Calculate();
+
+	CensusSnapshot census;
+	cISC4Simulator* pSimulator;
+
+	GamblingIncomeModel model;
+
+	GamblingIncomeBreakdown breakdown;
+	int32_t breakdownDateNumber;
+	bool breakdownValid;
+};
@@ -0,0 +1,194 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "GamblingIncomeModel.h"
+
+static_assert(
+	GamblingIncomeModel::MaxBaseMonthlyIncome
+	+ 3 * GamblingIncomeModel::MaxCensusPopulation * static_cast<int64_t>(GamblingIncomeModel::MaxIncomeFactor)
+	<= Money::MaxWholeValue,
+	"The income settings limits allow the built-in calculation to exceed the Money range.");
+
+namespace
+{
+	Money GetPopulationIncome(const CensusValues& values, CensusGroup group, MoneyFactor incomeFactor)
+	{
+		Money income;
+
+		if (incomeFactor.Raw() > 0)
+		{
+			const float value = values[static_cast<size_t>(group)];
+
+			if (value >= 1.0f)
+			{
+				// The census values are whole people, the fraction is only an artifact of the
+				// game storing them as floats.
+				const int64_t population = value < static_cast<float>(GamblingIncomeModel::MaxCensusPopulation)
+					? static_cast<int64_t>(value)
+					: GamblingIncomeModel::MaxCensusPopulation;
+
+				income = Money::MultiplyAdd(income, population, incomeFactor);
+			}
+		}
+
+		return income;
+	}
+
+	int64_t ClampBaseMonthlyIncome(int64_t value)
+	{
+		if (value > GamblingIncomeModel::MaxBaseMonthlyIncome)
+		{
+			return GamblingIncomeModel::MaxBaseMonthlyIncome;
+		}
+		else if (value < -GamblingIncomeModel::MaxBaseMonthlyIncome)
+		{
+			return -GamblingIncomeModel::MaxBaseMonthlyIncome;
+		}
+
+		return value;
+	}
+
+	float ClampIncomeFactor(float value)
+	{
+		// NaN is treated as 0.0, which excludes the wealth group from the income.
+		if (!(value > 0.0f))
+		{
+			return 0.0f;
+		}
+		else if (value > GamblingIncomeModel::MaxIncomeFactor)
+		{
+			return GamblingIncomeModel::MaxIncomeFactor;
+		}
+
+		return value;
+	}
+}
+
+GamblingIncomeModel::GamblingIncomeModel()
+	: baseMonthlyIncome(100),
+	  residentialLowWealthFactor(0.05f),
+	  residentialMedWealthFactor(0.03f),
+	  residentialHighWealthFactor(0.01f),
+	  incomeFormula(),
+	  baseMonthlyIncomeAmount(Money::FromWhole(100)),
+	  residentialLowWealthIncomeFactor(MoneyFactor::FromFloat(0.05f)),
+	  residentialMedWealthIncomeFactor(MoneyFactor::FromFloat(0.03f)),
+	  residentialHighWealthIncomeFactor(MoneyFactor::FromFloat(0.01f))
+{
+}
+
+bool GamblingIncomeModel::IsValidBaseMonthlyIncome(int64_t value)
+{
+	return value >= -MaxBaseMonthlyIncome && value <= MaxBaseMonthlyIncome;
+}
+
+bool GamblingIncomeModel::IsValidIncomeFactor(float value)
+{
+	return value >= 0.0f && value <= MaxIncomeFactor;
+}
+
+void GamblingIncomeModel::SetParameters(
+	int64_t baseMonthlyIncome,
+	float residentialLowWealthFactor,
+	float residentialMedWealthFactor,
+	float residentialHighWealthFactor,
+	const IncomeFormula& incomeFormula)
+{
+	this->baseMonthlyIncome = ClampBaseMonthlyIncome(baseMonthlyIncome);
+	this->residentialLowWealthFactor = ClampIncomeFactor(residentialLowWealthFactor);
+	this->residentialMedWealthFactor = ClampIncomeFactor(residentialMedWealthFactor);
+	this->residentialHighWealthFactor = ClampIncomeFactor(residentialHighWealthFactor);
+	this->incomeFormula = incomeFormula;
+
+	baseMonthlyIncomeAmount = Money::FromWhole(this->baseMonthlyIncome);
+	residentialLowWealthIncomeFactor = MoneyFactor::FromFloat(this->residentialLowWealthFactor);
+	residentialMedWealthIncomeFactor = MoneyFactor::FromFloat(this->residentialMedWealthFactor);
+	residentialHighWealthIncomeFactor = MoneyFactor::FromFloat(this->residentialHighWealthFactor);
+}
+
+GamblingIncomeBreakdown GamblingIncomeModel::Calculate(const CensusValues& values) const
+{
+	GamblingIncomeBreakdown result{};
+	result.baseIncome = baseMonthlyIncomeAmount;
+
+	if (!incomeFormula.IsEmpty())
+	{
+		// The formula replaces the built-in calculation, the income is not split by wealth group.
+		result.totalIncome = Money::FromDouble(EvaluateIncomeFormula(values)).ToWhole();
+		return result;
+	}
+
+	// Add the monthly income for each of the residential wealth groups.
+	// If the income factor is 0.0 for any group they will not participate
+	// in the Legalize Gambling ordinance income.
+
+	result.lowWealthIncome = GetPopulationIncome(values, CensusGroup::ResidentialLowWealth, residentialLowWealthIncomeFactor);
+	result.medWealthIncome = GetPopulationIncome(values, CensusGroup::ResidentialMedWealth, residentialMedWealthIncomeFactor);
+	result.highWealthIncome = GetPopulationIncome(values, CensusGroup::ResidentialHighWealth, residentialHighWealthIncomeFactor);
+
+	const Money monthlyIncome = result.baseIncome
+		+ result.lowWealthIncome
+		+ result.medWealthIncome
+		+ result.highWealthIncome;
+
+	result.totalIncome = monthlyIncome.ToWhole();
+
+	return result;
+}
+
+CensusGroupSet GamblingIncomeModel::RequiredCensusGroups() const
+{
+	return incomeFormula.IsEmpty() ? ResidentialCensusGroups : incomeFormula.CensusGroups();
+}
+
+int64_t GamblingIncomeModel::BaseMonthlyIncome() const
+{
+	return baseMonthlyIncome;
+}
+
+float GamblingIncomeModel::ResidentialLowWealthFactor() const
+{
+	return residentialLowWealthFactor;
+}
+
+float GamblingIncomeModel::ResidentialMedWealthFactor() const
+{
+	return residentialMedWealthFactor;
+}
+
+float GamblingIncomeModel::ResidentialHighWealthFactor() const
+{
+	return residentialHighWealthFactor;
+}
+
+const IncomeFormula& GamblingIncomeModel::MonthlyIncomeFormula() const
+{
+	return incomeFormula;
+}
+
+double GamblingIncomeModel::EvaluateIncomeFormula(const CensusValues& values) const
+{
+	IncomeFormula::Inputs inputs{};
+
+	for (size_t i = 0; i < values.size(); i++)
+	{
+		inputs[i] = values[i];
+	}
+
+	inputs[static_cast<size_t>(IncomeFormulaVariable::BaseMonthlyIncome)] = static_cast<double>(baseMonthlyIncome);
+	inputs[static_cast<size_t>(IncomeFormulaVariable::ResidentialLowWealthFactor)] = residentialLowWealthFactor;
+	inputs[static_cast<size_t>(IncomeFormulaVariable::ResidentialMedWealthFactor)] = residentialMedWealthFactor;
+	inputs[static_cast<size_t>(IncomeFormulaVariable::ResidentialHighWealthFactor)] = residentialHighWealthFactor;
+
+	return incomeFormula.Evaluate(inputs);
+}
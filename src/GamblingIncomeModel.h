@@ -0,0 +1,98 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "CensusSnapshot.h"
+#include "IncomeFormula.h"
+#include "Money.h"
+#include <cstdint>
+
+// The parts of the ordinance's monthly income.
+struct GamblingIncomeBreakdown
+{
+	Money baseIncome;
+	Money lowWealthIncome;
+	Money medWealthIncome;
+	Money highWealthIncome;
+	int64_t totalIncome;
+};
+
+// The Legalize Gambling ordinance income calculation.
+//
+// The model only depends on the census values and the income settings, it does not
+// call into the game. This allows the same calculation to be used by the ordinance,
+// the region forecast and the host-side tools.
+class GamblingIncomeModel
+{
+public:
+
+	// The limits of the income settings.
+	// With at most MaxCensusPopulation people in each residential wealth group, the built-in
+	// calculation is at most MaxBaseMonthlyIncome + 3 * MaxCensusPopulation * MaxIncomeFactor,
+	// 2^29 + 3 * 2^28, which is within the [-2^31, 2^31) range of a Money amount.
+	static constexpr int64_t MaxBaseMonthlyIncome = int64_t(1) << 29;
+	static constexpr float MaxIncomeFactor = 16.0f;
+	// The census values are floats, which are only exact integers up to 2^24.
+	// Larger populations are clamped to this value.
+	static constexpr int64_t MaxCensusPopulation = int64_t(1) << 24;
+
+	GamblingIncomeModel();
+
+	static bool IsValidBaseMonthlyIncome(int64_t value);
+	static bool IsValidIncomeFactor(float value);
+
+	/**
+	 * @brief Sets the income settings.
+	 * Values that are outside of the limits above are clamped, the settings file readers
+	 * reject them with an error.
+	*/
+	void SetParameters(
+		int64_t baseMonthlyIncome,
+		float residentialLowWealthFactor,
+		float residentialMedWealthFactor,
+		float residentialHighWealthFactor,
+		const IncomeFormula& incomeFormula);
+
+	/**
+	 * @brief Calculates the monthly income for the specified census values.
+	*/
+	GamblingIncomeBreakdown Calculate(const CensusValues& values) const;
+
+	/**
+	 * @brief Gets the census groups that the calculation reads.
+	*/
+	CensusGroupSet RequiredCensusGroups() const;
+
+	int64_t BaseMonthlyIncome() const;
+	float ResidentialLowWealthFactor() const;
+	float ResidentialMedWealthFactor() const;
+	float ResidentialHighWealthFactor() const;
+	const IncomeFormula& MonthlyIncomeFormula() const;
+
+private:
+
+	double EvaluateIncomeFormula(const CensusValues& values) const;
+
+	int64_t baseMonthlyIncome;
+	float residentialLowWealthFactor;
+	float residentialMedWealthFactor;
+	float residentialHighWealthFactor;
+	IncomeFormula incomeFormula;
+
+	// The fixed-point values are converted when the parameters are set,
+	// the monthly calculation only uses integer arithmetic.
+	Money baseMonthlyIncomeAmount;
+	MoneyFactor residentialLowWealthIncomeFactor;
+	MoneyFactor residentialMedWealthIncomeFactor;
+	MoneyFactor residentialHighWealthIncomeFactor;
+};
@@ -13,7 +13,9 @@
 
 #pragma once
 #include "stdint.h"
+#include "IncomeFormula.h"
 #include "OrdinancePropertyHolder.h"
+#include "Logger.h"
 
 class ISettings
 {
@@ -27,5 +29,14 @@ public:
 
 	virtual float ResidentialHighWealthFactor() const = 0;
 
-	virtual OrdinancePropertyHolder OrdinanceEffects() const = 0;
+	// The formula that replaces the built-in income calculation, it is empty if the
+	// settings file does not have a formula.
+	virtual const IncomeFormula& MonthlyIncomeFormula() const = 0;
+
+	// The ordinance effects share the property list of this snapshot, they are only copied when modified.
+	virtual const OrdinancePropertyHolder& OrdinanceEffects() const = 0;
+
+	virtual const LogConfiguration& LoggingConfiguration() const = 0;
+
+	virtual bool TracingEnabled() const = 0;
 };
\ No newline at end of file
@@ -0,0 +1,622 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "IncomeFormula.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace
+{
+	using InstructionArray = std::array<IncomeFormulaInstruction, IncomeFormula::MaxInstructions>;
+
+	struct VariableName
+	{
+		std::string_view name;
+		IncomeFormulaVariable variable;
+	};
+
+	constexpr VariableName VariableNames[] =
+	{
+		{ "R$", IncomeFormulaVariable::ResidentialLowWealth },
+		{ "R$$", IncomeFormulaVariable::ResidentialMedWealth },
+		{ "R$$$", IncomeFormulaVariable::ResidentialHighWealth },
+		{ "Cs$", IncomeFormulaVariable::CommercialServiceLowWealth },
+		{ "Cs$$", IncomeFormulaVariable::CommercialServiceMedWealth },
+		{ "Cs$$$", IncomeFormulaVariable::CommercialServiceHighWealth },
+		{ "Co$$", IncomeFormulaVariable::CommercialOfficeMedWealth },
+		{ "Co$$$", IncomeFormulaVariable::CommercialOfficeHighWealth },
+		{ "IR", IncomeFormulaVariable::IndustrialResource },
+		{ "ID", IncomeFormulaVariable::IndustrialDirty },
+		{ "IM", IncomeFormulaVariable::IndustrialManufacturing },
+		{ "IHT", IncomeFormulaVariable::IndustrialHighTech },
+		{ "BaseMonthlyIncome", IncomeFormulaVariable::BaseMonthlyIncome },
+		{ "R$IncomeFactor", IncomeFormulaVariable::ResidentialLowWealthFactor },
+		{ "R$$IncomeFactor", IncomeFormulaVariable::ResidentialMedWealthFactor },
+		{ "R$$$IncomeFactor", IncomeFormulaVariable::ResidentialHighWealthFactor },
+	};
+
+	struct FunctionInfo
+	{
+		std::string_view name;
+		IncomeFormulaOpcode opcode;
+		uint32_t argumentCount;
+	};
+
+	constexpr FunctionInfo Functions[] =
+	{
+		{ "min", IncomeFormulaOpcode::Min, 2 },
+		{ "max", IncomeFormulaOpcode::Max, 2 },
+		{ "clamp", IncomeFormulaOpcode::Clamp, 3 },
+		{ "sqrt", IncomeFormulaOpcode::Sqrt, 1 },
+		{ "pow", IncomeFormulaOpcode::Pow, 2 },
+		{ "log", IncomeFormulaOpcode::Log, 1 },
+	};
+
+	// The number of values that the instruction takes from the stack, every instruction
+	// pushes one value.
+	uint32_t GetOperandCount(IncomeFormulaOpcode opcode)
+	{
+		switch (opcode)
+		{
+		case IncomeFormulaOpcode::PushConstant:
+		case IncomeFormulaOpcode::PushVariable:
+			return 0;
+		case IncomeFormulaOpcode::Negate:
+		case IncomeFormulaOpcode::Sqrt:
+		case IncomeFormulaOpcode::Log:
+			return 1;
+		case IncomeFormulaOpcode::Clamp:
+			return 3;
+		default:
+			return 2;
+		}
+	}
+
+	bool IsDigit(char c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	bool IsIdentifierStart(char c)
+	{
+		return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+	}
+
+	bool IsIdentifierCharacter(char c)
+	{
+		return IsIdentifierStart(c) || IsDigit(c) || c == '$';
+	}
+
+	bool IsWhitespace(char c)
+	{
+		return c == ' ' || c == '\t';
+	}
+
+	enum class OperatorType : uint8_t
+	{
+		Binary = 0,
+		UnaryMinus,
+		Parenthesis,
+		FunctionParenthesis
+	};
+
+	struct OperatorStackEntry
+	{
+		OperatorType type;
+		IncomeFormulaOpcode opcode;
+		uint8_t precedence;
+		uint32_t argumentCount;
+		uint32_t expectedArgumentCount;
+		size_t offset;
+	};
+
+	// Converts the infix formula to postfix with the shunting-yard algorithm.
+	class FormulaCompiler
+	{
+	public:
+
+		FormulaCompiler(std::string_view expression, InstructionArray& instructions, uint32_t& instructionCount)
+			: expression(expression),
+			  position(0),
+			  instructions(instructions),
+			  instructionCount(instructionCount),
+			  stackDepth(0),
+			  operators(),
+			  operatorCount(0)
+		{
+			instructionCount = 0;
+		}
+
+		void Compile()
+		{
+			bool expectOperand = true;
+
+			for (;;)
+			{
+				SkipWhitespace();
+
+				if (position == expression.size())
+				{
+					break;
+				}
+
+				if (expectOperand)
+				{
+					expectOperand = ReadOperand();
+				}
+				else
+				{
+					expectOperand = ReadOperator();
+				}
+			}
+
+			if (expectOperand)
+			{
+				throw IncomeFormulaError(
+					position,
+					instructionCount == 0 && operatorCount == 0 ? "The formula is empty." : "Unexpected end of the formula.");
+			}
+
+			while (operatorCount > 0)
+			{
+				const OperatorStackEntry& top = operators[operatorCount - 1];
+
+				if (top.type == OperatorType::Parenthesis || top.type == OperatorType::FunctionParenthesis)
+				{
+					throw IncomeFormulaError(top.offset, "Missing ')'.");
+				}
+
+				PopOperator();
+			}
+		}
+
+	private:
+
+		static constexpr size_t MaxOperatorCount = 32;
+
+		// Returns true if the next token must be an operand.
+		bool ReadOperand()
+		{
+			const size_t start = position;
+			const char c = expression[position];
+
+			if (IsDigit(c) || c == '.')
+			{
+				Emit(IncomeFormulaOpcode::PushConstant, start, IncomeFormulaVariable::ResidentialLowWealth, ReadNumber());
+				return false;
+			}
+			else if (IsIdentifierStart(c))
+			{
+				const std::string_view name = ReadIdentifier();
+
+				SkipWhitespace();
+
+				if (position < expression.size() && expression[position] == '(')
+				{
+					const FunctionInfo& function = FindFunction(name, start);
+
+					PushOperator(OperatorStackEntry{ OperatorType::FunctionParenthesis, function.opcode, 0, 1, function.argumentCount, start });
+					position++;
+					return true;
+				}
+
+				Emit(IncomeFormulaOpcode::PushVariable, start, FindVariable(name, start), 0.0);
+				return false;
+			}
+			else if (c == '(')
+			{
+				PushOperator(OperatorStackEntry{ OperatorType::Parenthesis, IncomeFormulaOpcode::PushConstant, 0, 0, 0, start });
+				position++;
+				return true;
+			}
+			else if (c == '-')
+			{
+				PushOperator(OperatorStackEntry{ OperatorType::UnaryMinus, IncomeFormulaOpcode::Negate, 3, 0, 0, start });
+				position++;
+				return true;
+			}
+			else if (c == '+')
+			{
+				// A unary plus has no effect.
+				position++;
+				return true;
+			}
+
+			throw IncomeFormulaError(start, "Expected a number, variable, function or '('.");
+		}
+
+		// Returns true if the next token must be an operand.
+		bool ReadOperator()
+		{
+			const size_t start = position;
+			const char c = expression[position];
+
+			if (c == '+' || c == '-' || c == '*' || c == '/')
+			{
+				IncomeFormulaOpcode opcode = IncomeFormulaOpcode::Add;
+				uint8_t precedence = 1;
+
+				switch (c)
+				{
+				case '-':
+					opcode = IncomeFormulaOpcode::Subtract;
+					break;
+				case '*':
+					opcode = IncomeFormulaOpcode::Multiply;
+					precedence = 2;
+					break;
+				case '/':
+					opcode = IncomeFormulaOpcode::Divide;
+					precedence = 2;
+					break;
+				}
+
+				// All of the binary operators are left-associative.
+				while (operatorCount > 0)
+				{
+					const OperatorStackEntry& top = operators[operatorCount - 1];
+
+					if ((top.type != OperatorType::Binary && top.type != OperatorType::UnaryMinus) || top.precedence < precedence)
+					{
+						break;
+					}
+
+					PopOperator();
+				}
+
+				PushOperator(OperatorStackEntry{ OperatorType::Binary, opcode, precedence, 0, 0, start });
+				position++;
+				return true;
+			}
+			else if (c == ',')
+			{
+				PopOperatorsUntilParenthesis(start, "Unexpected ','.");
+
+				OperatorStackEntry& function = operators[operatorCount - 1];
+
+				if (function.type != OperatorType::FunctionParenthesis)
+				{
+					throw IncomeFormulaError(start, "Unexpected ','.");
+				}
+
+				function.argumentCount++;
+
+				if (function.argumentCount > function.expectedArgumentCount)
+				{
+					ThrowArgumentCountError(function);
+				}
+
+				position++;
+				return true;
+			}
+			else if (c == ')')
+			{
+				PopOperatorsUntilParenthesis(start, "Unmatched ')'.");
+
+				const OperatorStackEntry parenthesis = operators[--operatorCount];
+
+				if (parenthesis.type == OperatorType::FunctionParenthesis)
+				{
+					if (parenthesis.argumentCount != parenthesis.expectedArgumentCount)
+					{
+						ThrowArgumentCountError(parenthesis);
+					}
+
+					Emit(parenthesis.opcode, parenthesis.offset, IncomeFormulaVariable::ResidentialLowWealth, 0.0);
+				}
+
+				position++;
+				return false;
+			}
+
+			throw IncomeFormulaError(start, "Expected an operator or ')'.");
+		}
+
+		double ReadNumber()
+		{
+			const size_t start = position;
+
+			while (position < expression.size() && (IsDigit(expression[position]) || expression[position] == '.'))
+			{
+				position++;
+			}
+
+			if (position < expression.size() && (expression[position] == 'e' || expression[position] == 'E'))
+			{
+				size_t exponent = position + 1;
+
+				if (exponent < expression.size() && (expression[exponent] == '+' || expression[exponent] == '-'))
+				{
+					exponent++;
+				}
+
+				if (exponent < expression.size() && IsDigit(expression[exponent]))
+				{
+					position = exponent;
+
+					while (position < expression.size() && IsDigit(expression[position]))
+					{
+						position++;
+					}
+				}
+			}
+
+			const char* const first = expression.data() + start;
+			const char* const last = expression.data() + position;
+
+			double value = 0.0;
+			const std::from_chars_result result = std::from_chars(first, last, value);
+
+			if (result.ec != std::errc() || result.ptr != last)
+			{
+				throw IncomeFormulaError(start, "Invalid number.");
+			}
+
+			return value;
+		}
+
+		std::string_view ReadIdentifier()
+		{
+			const size_t start = position;
+
+			while (position < expression.size() && IsIdentifierCharacter(expression[position]))
+			{
+				position++;
+			}
+
+			return expression.substr(start, position - start);
+		}
+
+		void SkipWhitespace()
+		{
+			while (position < expression.size() && IsWhitespace(expression[position]))
+			{
+				position++;
+			}
+		}
+
+		static IncomeFormulaVariable FindVariable(std::string_view name, size_t offset)
+		{
+			for (const VariableName& item : VariableNames)
+			{
+				if (item.name == name)
+				{
+					return item.variable;
+				}
+			}
+
+			ThrowNameError("Unknown variable '%.*s'.", name, offset);
+		}
+
+		static const FunctionInfo& FindFunction(std::string_view name, size_t offset)
+		{
+			for (const FunctionInfo& item : Functions)
+			{
+				if (item.name == name)
+				{
+					return item;
+				}
+			}
+
+			ThrowNameError("Unknown function '%.*s'.", name, offset);
+		}
+
+		[[noreturn]] static void ThrowNameError(const char* const format, std::string_view name, size_t offset)
+		{
+			char buffer[256]{};
+
+			std::snprintf(buffer, sizeof(buffer), format, static_cast<int>(name.size()), name.data());
+
+			throw IncomeFormulaError(offset, buffer);
+		}
+
+		[[noreturn]] static void ThrowArgumentCountError(const OperatorStackEntry& function)
+		{
+			char buffer[256]{};
+
+			std::snprintf(
+				buffer,
+				sizeof(buffer),
+				"The function requires %u argument%s.",
+				function.expectedArgumentCount,
+				function.expectedArgumentCount == 1 ? "" : "s");
+
+			throw IncomeFormulaError(function.offset, buffer);
+		}
+
+		void PopOperatorsUntilParenthesis(size_t offset, const char* const unmatchedMessage)
+		{
+			for (;;)
+			{
+				if (operatorCount == 0)
+				{
+					throw IncomeFormulaError(offset, unmatchedMessage);
+				}
+
+				const OperatorStackEntry& top = operators[operatorCount - 1];
+
+				if (top.type == OperatorType::Parenthesis || top.type == OperatorType::FunctionParenthesis)
+				{
+					break;
+				}
+
+				PopOperator();
+			}
+		}
+
+		void PushOperator(const OperatorStackEntry& entry)
+		{
+			if (operatorCount == MaxOperatorCount)
+			{
+				throw IncomeFormulaError(entry.offset, "The formula is nested too deeply.");
+			}
+
+			operators[operatorCount++] = entry;
+		}
+
+		void PopOperator()
+		{
+			const OperatorStackEntry& top = operators[--operatorCount];
+
+			Emit(top.opcode, top.offset, IncomeFormulaVariable::ResidentialLowWealth, 0.0);
+		}
+
+		void Emit(IncomeFormulaOpcode opcode, size_t offset, IncomeFormulaVariable variable, double constant)
+		{
+			if (instructionCount == IncomeFormula::MaxInstructions)
+			{
+				throw IncomeFormulaError(offset, "The formula is too long.");
+			}
+
+			// The grammar ensures that every instruction has its operands.
+			stackDepth = stackDepth - GetOperandCount(opcode) + 1;
+
+			if (stackDepth > IncomeFormula::MaxStackDepth)
+			{
+				throw IncomeFormulaError(offset, "The formula is nested too deeply.");
+			}
+
+			instructions[instructionCount++] = IncomeFormulaInstruction{ opcode, variable, constant };
+		}
+
+		const std::string_view expression;
+		size_t position;
+		InstructionArray& instructions;
+		uint32_t& instructionCount;
+		size_t stackDepth;
+		std::array<OperatorStackEntry, MaxOperatorCount> operators;
+		size_t operatorCount;
+	};
+}
+
+IncomeFormulaError::IncomeFormulaError(size_t offset, const char* message)
+	: std::runtime_error(message),
+	  offset(offset)
+{
+}
+
+size_t IncomeFormulaError::Offset() const
+{
+	return offset;
+}
+
+IncomeFormula::IncomeFormula()
+	: instructions(),
+	  instructionCount(0),
+	  censusGroups(0)
+{
+}
+
+IncomeFormula IncomeFormula::Compile(std::string_view expression)
+{
+	IncomeFormula formula;
+
+	FormulaCompiler compiler(expression, formula.instructions, formula.instructionCount);
+	compiler.Compile();
+
+	for (uint32_t i = 0; i < formula.instructionCount; i++)
+	{
+		const IncomeFormulaInstruction& instruction = formula.instructions[i];
+
+		if (instruction.opcode == IncomeFormulaOpcode::PushVariable
+			&& instruction.variable < static_cast<IncomeFormulaVariable>(CensusGroup::Count))
+		{
+			formula.censusGroups |= ToCensusGroupSet(static_cast<CensusGroup>(instruction.variable));
+		}
+	}
+
+	return formula;
+}
+
+bool IncomeFormula::IsEmpty() const
+{
+	return instructionCount == 0;
+}
+
+CensusGroupSet IncomeFormula::CensusGroups() const
+{
+	return censusGroups;
+}
+
+double IncomeFormula::Evaluate(const Inputs& inputs) const
+{
+	// The compiler has verified that the program does not use more than MaxStackDepth
+	// values and that every instruction has its operands.
+	double stack[MaxStackDepth];
+	size_t top = 0;
+
+	for (uint32_t i = 0; i < instructionCount; i++)
+	{
+		const IncomeFormulaInstruction& instruction = instructions[i];
+
+		switch (instruction.opcode)
+		{
+		case IncomeFormulaOpcode::PushConstant:
+			stack[top++] = instruction.constant;
+			break;
+		case IncomeFormulaOpcode::PushVariable:
+			stack[top++] = inputs[static_cast<size_t>(instruction.variable)];
+			break;
+		case IncomeFormulaOpcode::Add:
+			top--;
+			stack[top - 1] += stack[top];
+			break;
+		case IncomeFormulaOpcode::Subtract:
+			top--;
+			stack[top - 1] -= stack[top];
+			break;
+		case IncomeFormulaOpcode::Multiply:
+			top--;
+			stack[top - 1] *= stack[top];
+			break;
+		case IncomeFormulaOpcode::Divide:
+			top--;
+			stack[top - 1] /= stack[top];
+			break;
+		case IncomeFormulaOpcode::Negate:
+			stack[top - 1] = -stack[top - 1];
+			break;
+		case IncomeFormulaOpcode::Min:
+			top--;
+			stack[top - 1] = stack[top] < stack[top - 1] ? stack[top] : stack[top - 1];
+			break;
+		case IncomeFormulaOpcode::Max:
+			top--;
+			stack[top - 1] = stack[top] > stack[top - 1] ? stack[top] : stack[top - 1];
+			break;
+		case IncomeFormulaOpcode::Clamp:
+		{
+			top -= 2;
+			const double value = stack[top - 1];
+			const double min = stack[top];
+			const double max = stack[top + 1];
+
+			stack[top - 1] = value < min ? min : (value > max ? max : value);
+			break;
+		}
+		case IncomeFormulaOpcode::Sqrt:
+			stack[top - 1] = std::sqrt(stack[top - 1]);
+			break;
+		case IncomeFormulaOpcode::Pow:
+			top--;
+			stack[top - 1] = std::pow(stack[top - 1], stack[top]);
+			break;
+		case IncomeFormulaOpcode::Log:
+			stack[top - 1] = std::log(stack[top - 1]);
+			break;
+		}
+	}
+
+	return top == 1 ? stack[0] : 0.0;
+}
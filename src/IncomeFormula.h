@@ -0,0 +1,133 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "CensusSnapshot.h"
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+// The values that an income formula can use.
+// The census variables are in the same order as the CensusGroup values.
+enum class IncomeFormulaVariable : uint8_t
+{
+	ResidentialLowWealth = 0,
+	ResidentialMedWealth,
+	ResidentialHighWealth,
+	CommercialServiceLowWealth,
+	CommercialServiceMedWealth,
+	CommercialServiceHighWealth,
+	CommercialOfficeMedWealth,
+	CommercialOfficeHighWealth,
+	IndustrialResource,
+	IndustrialDirty,
+	IndustrialManufacturing,
+	IndustrialHighTech,
+	BaseMonthlyIncome,
+	ResidentialLowWealthFactor,
+	ResidentialMedWealthFactor,
+	ResidentialHighWealthFactor,
+	Count
+};
+
+static_assert(static_cast<size_t>(IncomeFormulaVariable::IndustrialHighTech) + 1 == static_cast<size_t>(CensusGroup::Count));
+
+enum class IncomeFormulaOpcode : uint8_t
+{
+	PushConstant = 0,
+	PushVariable,
+	Add,
+	Subtract,
+	Multiply,
+	Divide,
+	Negate,
+	Min,
+	Max,
+	Clamp,
+	Sqrt,
+	Pow,
+	Log
+};
+
+struct IncomeFormulaInstruction
+{
+	IncomeFormulaOpcode opcode;
+	IncomeFormulaVariable variable;
+	double constant;
+};
+
+// The exception that is thrown when a formula cannot be compiled.
+class IncomeFormulaError : public std::runtime_error
+{
+public:
+
+	IncomeFormulaError(size_t offset, const char* message);
+
+	/**
+	 * @brief Gets the offset of the error in the formula text.
+	*/
+	size_t Offset() const;
+
+private:
+
+	size_t offset;
+};
+
+// An income formula that has been compiled into a postfix program.
+//
+// The formula is an arithmetic expression with the + - * / operators, parentheses and the
+// min(a, b), max(a, b), clamp(x, min, max), sqrt(x), pow(x, y) and log(x) functions.
+// The variables are the census groups (R$, R$$, R$$$, Cs$, Cs$$, Cs$$$, Co$$, Co$$$,
+// IR, ID, IM and IHT) and the BaseMonthlyIncome, R$IncomeFactor, R$$IncomeFactor and
+// R$$$IncomeFactor settings.
+//
+// The program is stored in a fixed-size array, so the formula can be copied and cached
+// like a plain value.
+class IncomeFormula
+{
+public:
+
+	static constexpr size_t MaxInstructions = 64;
+	static constexpr size_t MaxStackDepth = 16;
+
+	using Inputs = std::array<double, static_cast<size_t>(IncomeFormulaVariable::Count)>;
+
+	IncomeFormula();
+
+	/**
+	 * @brief Compiles the formula text.
+	 * @param expression The formula text.
+	 * @return The compiled formula.
+	 * @throws IncomeFormulaError The formula is not valid or it is too long.
+	*/
+	static IncomeFormula Compile(std::string_view expression);
+
+	/**
+	 * @brief Gets a value indicating whether the formula has no instructions.
+	*/
+	bool IsEmpty() const;
+
+	/**
+	 * @brief Gets the census groups that the formula reads.
+	*/
+	CensusGroupSet CensusGroups() const;
+
+	double Evaluate(const Inputs& inputs) const;
+
+private:
+
+	std::array<IncomeFormulaInstruction, MaxInstructions> instructions;
+	uint32_t instructionCount;
+	CensusGroupSet censusGroups;
+};
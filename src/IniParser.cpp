@@ -0,0 +1,274 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "IniParser.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace
+{
+	constexpr std::string_view Utf8ByteOrderMark = "\xEF\xBB\xBF";
+
+	std::string FormatErrorMessage(uint32_t line, uint32_t column, const char* message)
+	{
+		char buffer[1024]{};
+
+		std::snprintf(buffer, sizeof(buffer), "Line %u, column %u: %s", line, column, message);
+
+		return std::string(buffer);
+	}
+
+	bool IsWhitespace(char c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	bool IsCommentStart(char c)
+	{
+		return c == ';' || c == '#';
+	}
+
+	size_t SkipLeadingWhitespace(std::string_view text, size_t offset)
+	{
+		while (offset < text.size() && IsWhitespace(text[offset]))
+		{
+			offset++;
+		}
+
+		return offset;
+	}
+
+	std::string_view TrimTrailingWhitespace(std::string_view text)
+	{
+		size_t length = text.size();
+
+		while (length > 0 && IsWhitespace(text[length - 1]))
+		{
+			length--;
+		}
+
+		return text.substr(0, length);
+	}
+
+	char ToLowerAscii(char c)
+	{
+		return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+	}
+
+	// std::from_chars does not accept a leading plus sign.
+	std::string_view RemovePlusSign(std::string_view value)
+	{
+		if (value.size() > 1 && value[0] == '+' && value[1] != '-')
+		{
+			value.remove_prefix(1);
+		}
+
+		return value;
+	}
+
+	template <typename T> bool TryParseNumber(std::string_view value, T& result)
+	{
+		value = RemovePlusSign(value);
+
+		if (value.empty())
+		{
+			return false;
+		}
+
+		const char* const first = value.data();
+		const char* const last = first + value.size();
+
+		T parsed{};
+		const std::from_chars_result fromCharsResult = std::from_chars(first, last, parsed);
+
+		if (fromCharsResult.ec != std::errc() || fromCharsResult.ptr != last)
+		{
+			return false;
+		}
+
+		result = parsed;
+		return true;
+	}
+}
+
+IniParseError::IniParseError(uint32_t line, uint32_t column, const char* message)
+	: std::runtime_error(FormatErrorMessage(line, column, message)),
+	  line(line),
+	  column(column)
+{
+}
+
+uint32_t IniParseError::Line() const
+{
+	return line;
+}
+
+uint32_t IniParseError::Column() const
+{
+	return column;
+}
+
+void IniParser::Parse(std::string_view text, EntryCallback callback, void* context)
+{
+	if (text.starts_with(Utf8ByteOrderMark))
+	{
+		text.remove_prefix(Utf8ByteOrderMark.size());
+	}
+
+	std::string_view section;
+	uint32_t lineNumber = 0;
+	size_t lineStart = 0;
+
+	while (lineStart < text.size())
+	{
+		lineNumber++;
+
+		size_t lineEnd = text.find('\n', lineStart);
+
+		if (lineEnd == std::string_view::npos)
+		{
+			lineEnd = text.size();
+		}
+
+		const std::string_view line = text.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+
+		const size_t first = SkipLeadingWhitespace(line, 0);
+
+		if (first == line.size() || IsCommentStart(line[first]))
+		{
+			continue;
+		}
+
+		if (line[first] == '[')
+		{
+			const size_t sectionEnd = line.find(']', first + 1);
+
+			if (sectionEnd == std::string_view::npos)
+			{
+				throw IniParseError(
+					lineNumber,
+					static_cast<uint32_t>(TrimTrailingWhitespace(line).size() + 1),
+					"Expected ']' after the section name.");
+			}
+
+			const size_t nameStart = SkipLeadingWhitespace(line, first + 1);
+			section = TrimTrailingWhitespace(line.substr(nameStart, sectionEnd - nameStart));
+
+			if (section.empty())
+			{
+				throw IniParseError(lineNumber, static_cast<uint32_t>(first + 1), "The section name is empty.");
+			}
+
+			const size_t trailing = SkipLeadingWhitespace(line, sectionEnd + 1);
+
+			if (trailing < line.size() && !IsCommentStart(line[trailing]))
+			{
+				throw IniParseError(
+					lineNumber,
+					static_cast<uint32_t>(trailing + 1),
+					"Unexpected characters after the section name.");
+			}
+		}
+		else
+		{
+			const size_t separator = line.find('=', first);
+
+			if (separator == std::string_view::npos)
+			{
+				throw IniParseError(
+					lineNumber,
+					static_cast<uint32_t>(TrimTrailingWhitespace(line).size() + 1),
+					"Expected '=' after the key name.");
+			}
+
+			const std::string_view key = TrimTrailingWhitespace(line.substr(first, separator - first));
+
+			if (key.empty())
+			{
+				throw IniParseError(lineNumber, static_cast<uint32_t>(first + 1), "The key name is empty.");
+			}
+
+			const size_t valueStart = SkipLeadingWhitespace(line, separator + 1);
+
+			IniEntry entry{};
+			entry.section = section;
+			entry.key = key;
+			entry.value = TrimTrailingWhitespace(line.substr(valueStart));
+			entry.line = lineNumber;
+			entry.valueColumn = static_cast<uint32_t>(valueStart + 1);
+
+			callback(entry, context);
+		}
+	}
+}
+
+bool IniParser::EqualsIgnoreCase(std::string_view lhs, std::string_view rhs)
+{
+	if (lhs.size() != rhs.size())
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < lhs.size(); i++)
+	{
+		if (ToLowerAscii(lhs[i]) != ToLowerAscii(rhs[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool IniParser::TryParseBool(std::string_view value, bool& result)
+{
+	if (EqualsIgnoreCase(value, "true") || value == "1")
+	{
+		result = true;
+		return true;
+	}
+	else if (EqualsIgnoreCase(value, "false") || value == "0")
+	{
+		result = false;
+		return true;
+	}
+
+	return false;
+}
+
+bool IniParser::TryParseInt64(std::string_view value, int64_t& result)
+{
+	return TryParseNumber(value, result);
+}
+
+bool IniParser::TryParseUInt32(std::string_view value, uint32_t& result)
+{
+	return TryParseNumber(value, result);
+}
+
+bool IniParser::TryParseFloat(std::string_view value, float& result)
+{
+	float parsed = 0.0f;
+
+	// std::from_chars accepts nan, inf and infinity, the settings values must be finite.
+	if (!TryParseNumber(value, parsed) || !std::isfinite(parsed))
+	{
+		return false;
+	}
+
+	result = parsed;
+	return true;
+}
@@ -0,0 +1,76 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+
+// A key and value from an INI file.
+// The strings point into the parsed text, they are only valid during the entry callback.
+struct IniEntry
+{
+	std::string_view section;
+	std::string_view key;
+	std::string_view value;
+	// The 1-based line number of the entry.
+	uint32_t line;
+	// The 1-based column of the first character of the value.
+	uint32_t valueColumn;
+};
+
+// The exception that is thrown for a syntax error or an invalid value in an INI file.
+// The message starts with the line and column of the error.
+class IniParseError : public std::runtime_error
+{
+public:
+
+	IniParseError(uint32_t line, uint32_t column, const char* message);
+
+	uint32_t Line() const;
+	uint32_t Column() const;
+
+private:
+
+	uint32_t line;
+	uint32_t column;
+};
+
+// A single-pass INI parser that does not allocate any memory.
+//
+// Lines starting with a semicolon or number sign are comments. The whitespace around
+// the section names, keys and values is ignored. Keys that appear before the first
+// section have an empty section name.
+namespace IniParser
+{
+	using EntryCallback = void(*)(const IniEntry& entry, void* context);
+
+	/**
+	 * @brief Parses the INI file text and calls the callback for each key.
+	 * @param text The INI file text, a UTF-8 byte order mark is skipped.
+	 * @param callback The callback that receives the entries.
+	 * @param context The context value that is passed to the callback.
+	 * @throws IniParseError The text has a syntax error.
+	*/
+	void Parse(std::string_view text, EntryCallback callback, void* context);
+
+	bool EqualsIgnoreCase(std::string_view lhs, std::string_view rhs);
+
+	// The value conversion functions return false if the value is not valid
+	// or it is outside the range of the type. TryParseFloat also rejects NaN and infinity.
+
+	bool TryParseBool(std::string_view value, bool& result);
+	bool TryParseInt64(std::string_view value, int64_t& result);
+	bool TryParseUInt32(std::string_view value, uint32_t& result);
+	bool TryParseFloat(std::string_view value, float& result);
+}
@@ -0,0 +1,122 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "LatencyHistogram.h"
+#include <bit>
+#include <cmath>
+
+LatencyHistogram::LatencyHistogram()
+	: buckets(), count(0), max(0)
+{
+}
+
+void LatencyHistogram::Record(uint64_t value)
+{
+	const uint32_t index = GetBucketIndex(value);
+
+	if (buckets[index] < UINT32_MAX)
+	{
+		buckets[index]++;
+	}
+
+	count++;
+
+	if (value > max)
+	{
+		max = value;
+	}
+}
+
+void LatencyHistogram::Reset()
+{
+	buckets.fill(0);
+	count = 0;
+	max = 0;
+}
+
+uint64_t LatencyHistogram::GetCount() const
+{
+	return count;
+}
+
+uint64_t LatencyHistogram::GetMax() const
+{
+	return max;
+}
+
+uint64_t LatencyHistogram::GetValueAtPercentile(double percentile) const
+{
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	uint64_t target = static_cast<uint64_t>(std::ceil((percentile / 100.0) * static_cast<double>(count)));
+
+	if (target == 0)
+	{
+		target = 1;
+	}
+
+	uint64_t total = 0;
+
+	for (uint32_t i = 0; i < BucketCount; i++)
+	{
+		total += buckets[i];
+
+		if (total >= target)
+		{
+			const uint64_t upperBound = GetBucketUpperBound(i);
+
+			// The largest recorded value is more accurate than the bucket bound.
+			return upperBound < max ? upperBound : max;
+		}
+	}
+
+	return max;
+}
+
+uint32_t LatencyHistogram::GetBucketIndex(uint64_t value)
+{
+	if (value < SubBucketCount)
+	{
+		return static_cast<uint32_t>(value);
+	}
+
+	uint32_t exponent = static_cast<uint32_t>(std::bit_width(value)) - 1;
+
+	if (exponent >= MaxValueBits)
+	{
+		return BucketCount - 1;
+	}
+
+	const uint32_t shift = exponent - SubBucketBits;
+	const uint32_t subBucket = static_cast<uint32_t>(value >> shift) & (SubBucketCount - 1);
+
+	return ((shift + 1) * SubBucketCount) + subBucket;
+}
+
+uint64_t LatencyHistogram::GetBucketUpperBound(uint32_t index)
+{
+	if (index < SubBucketCount)
+	{
+		return index;
+	}
+
+	const uint32_t shift = (index / SubBucketCount) - 1;
+	const uint64_t subBucket = index % SubBucketCount;
+
+	const uint64_t lowerBound = (SubBucketCount + subBucket) << shift;
+
+	return lowerBound + ((uint64_t(1) << shift) - 1);
+}
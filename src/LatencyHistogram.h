@@ -0,0 +1,61 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <array>
+#include <cstdint>
+
+// A fixed size log-linear histogram, in the style of HdrHistogram.
+//
+// Values below SubBucketCount are counted exactly, larger values are grouped into
+// SubBucketCount linear sub-buckets for each power of two. This gives a relative
+// error of at most 1 / SubBucketCount (6.25%) for any value.
+//
+// Recording a value does not allocate or lock, the class is not thread safe.
+class LatencyHistogram
+{
+public:
+
+	static constexpr uint32_t SubBucketBits = 4;
+	static constexpr uint32_t SubBucketCount = 1 << SubBucketBits;
+	// Values with more significant bits than this are counted in the last bucket.
+	static constexpr uint32_t MaxValueBits = 48;
+	static constexpr uint32_t BucketCount = (MaxValueBits - SubBucketBits + 1) * SubBucketCount;
+
+	LatencyHistogram();
+
+	void Record(uint64_t value);
+
+	void Reset();
+
+	uint64_t GetCount() const;
+
+	uint64_t GetMax() const;
+
+	/**
+	 * @brief Gets the value at the specified percentile.
+	 * @param percentile The percentile, in the range of [0, 100].
+	 * @return The highest value that is in the same bucket as the percentile, or zero if
+	 * no values have been recorded.
+	*/
+	uint64_t GetValueAtPercentile(double percentile) const;
+
+private:
+
+	static uint32_t GetBucketIndex(uint64_t value);
+	static uint64_t GetBucketUpperBound(uint32_t index);
+
+	std::array<uint32_t, BucketCount> buckets;
+	uint64_t count;
+	uint64_t max;
+};
@@ -12,91 +12,13 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "LegalizeGamblingOrdinanceUpgrade.h"
+#include "CasinoRetractionQueue.h"
 #include "ISettings.h"
-#include "cIGZWin.h"
-#include "cISC4App.h"
-#include "cISC4City.h"
-#include "cISC4CivicBuildingSimulator.h"
-#include "cISC4Demand.h"
-#include "cISC4DemandSimulator.h"
-#include "cISC4Lot.h"
-#include "cISC4LotDeveloper.h"
-#include "cISC4LotManager.h"
-#include "cISC4Occupant.h"
-#include "cISC4OccupantManager.h"
-#include "cISC4View3DWin.h"
-#include "cISC4ViewInputControl.h"
-#include "GZServPtrs.h"
-
-static const uint32_t kGZWin_WinSC4App = 0x6104489A;
-static const uint32_t kSC4CLSID_cSC4View3DWin = 0x9A47B417;
-
-static const uint32_t kGZIID_cISC4View3DWin = 0xFA47B3F9;
-
-static const uint32_t kSCPROP_CityExclusionGroup = 0xEA2E078B;
-static const uint32_t kOccupantGroup_Reward = 0x150B;
-static const uint32_t kOccupantType_Building = 0x278128A0;
-
-static const uint32_t kCasinoCityExclusionGroup = 0xCA78B74B;
+#include "SettingsManager.h"
+#include "TraceSpan.h"
 
 namespace
 {
-	struct CasinoIteratorData
-	{
-		CasinoIteratorData() : casinoOccupant(nullptr)
-		{
-		}
-
-		cISC4Occupant* casinoOccupant;
-	};
-
-	static bool CasinoIterator(cISC4Occupant* pOccupant, void* pData)
-	{
-		if (pOccupant->GetType() == kOccupantType_Building)
-		{
-			if (pOccupant->IsOccupantGroup(kOccupantGroup_Reward))
-			{
-				cISCPropertyHolder* pPoperties = pOccupant->AsPropertyHolder();
-
-				if (pPoperties)
-				{
-					uint32_t cityExclusionGroup = 0;
-
-					if (pPoperties->GetProperty(kSCPROP_CityExclusionGroup, cityExclusionGroup))
-					{
-						if (cityExclusionGroup == kCasinoCityExclusionGroup)
-						{
-							CasinoIteratorData* data = static_cast<CasinoIteratorData*>(pData);
-
-							data->casinoOccupant = pOccupant;
-
-							// Stop the enumeration.
-							return false;
-						}
-					}
-				}
-			}
-		}
-
-		return true;
-	}
-
-	cISC4Occupant* GetCasinoOccupant(cISC4City* pCity)
-	{
-		cISC4OccupantManager* pOccupantManager = pCity->GetOccupantManager();
-
-		if (pOccupantManager)
-		{
-			CasinoIteratorData iteratorData;
-
-			pOccupantManager->IterateOccupants(CasinoIterator, &iteratorData, nullptr, nullptr, kOccupantType_Building);
-
-			return iteratorData.casinoOccupant;
-		}
-
-		return nullptr;
-	}
-
 	OrdinancePropertyHolder CreateDefaultOrdinanceEffects()
 	{
 		OrdinancePropertyHolder properties;
@@ -106,88 +28,6 @@ namespace
 
 		return properties;
 	}
-
-	void DemolishCasino(cISC4City* pCity)
-	{
-		cISC4Occupant* pCasinoOccupant = GetCasinoOccupant(pCity);
-
-		if (pCasinoOccupant)
-		{
-			cISC4LotManager* pLotManager = pCity->GetLotManager();
-
-			if (pLotManager)
-			{
-				cISC4Lot* pCasinoLot = pLotManager->GetOccupantLot(pCasinoOccupant);
-
-				if (pCasinoLot)
-				{
-					cISC4LotDeveloper* pLotDeveloper = pCity->GetLotDeveloper();
-
-					if (pLotDeveloper)
-					{
-						pLotDeveloper->StartDemolishLot(pCasinoLot);
-						pLotDeveloper->EndDemolishLot(pCasinoLot);
-					}
-				}
-			}
-		}
-	}
-
-	void DisableCasinoMenuItem(cISC4App* pSC4App, cISC4City* pCity)
-	{
-		constexpr uint32_t casinoBuildingID = 0x33a0000;
-
-		// Disable the Casino item in the Rewards menu.
-
-		cISC4CivicBuildingSimulator* pCivicBuildingSim = pCity->GetCivicBuildingSimulator();
-
-		if (pCivicBuildingSim)
-		{
-			const cISC4CivicBuildingSimulator::ConditionalBuildingStatus* status = pCivicBuildingSim->GetConditionalBuildingStatus(casinoBuildingID);
-
-			if (status)
-			{
-				constexpr int16_t Status_BuildingDisabled = 1;
-
-				// We create a copy of the existing ConditionalBuildingStatus class and
-				// disable the Casino building in the Rewards menu.
-
-				cISC4CivicBuildingSimulator::ConditionalBuildingStatus newStatus(*status);
-				newStatus.status = Status_BuildingDisabled;
-
-				pCivicBuildingSim->UpdateConditionalBuildingStatus(casinoBuildingID, &newStatus);
-			}
-		}
-
-		// Turn off the Place Lot control, if it is active.
-
-		cIGZWin* pMainWin = pSC4App->GetMainWindow();
-
-		if (pMainWin)
-		{
-			cIGZWin* pParentWin = pMainWin->GetChildWindowFromID(kGZWin_WinSC4App);
-
-			if (pParentWin)
-			{
-				cISC4View3DWin* pView3DWin = nullptr;
-
-				if (pParentWin->GetChildAs(kSC4CLSID_cSC4View3DWin, kGZIID_cISC4View3DWin, reinterpret_cast<void**>(&pView3DWin)))
-				{
-					cISC4ViewInputControl* pCurrentViewInputControl = pView3DWin->GetCurrentViewInputControl();
-
-					if (pCurrentViewInputControl)
-					{
-						constexpr uint32_t placeLotViewInputControl = 0x88F154FBl;
-
-						if (pCurrentViewInputControl->GetID() == placeLotViewInputControl)
-						{
-							pView3DWin->RemoveCurrentViewInputControl(false);
-						}
-					}
-				}
-			}
-		}
-	}
 }
 
 LegalizeGamblingOrdinanceUpgrade::LegalizeGamblingOrdinanceUpgrade()
@@ -207,89 +47,36 @@ LegalizeGamblingOrdinanceUpgrade::LegalizeGamblingOrdinanceUpgrade()
 		/* advisor ID */ 0,
 		/* income ordinance */		  true,
 		CreateDefaultOrdinanceEffects()),
-		pDemandSimulator(nullptr),
-		baseMonthlyIncome(100),
-		residentialLowWealthIncomeFactor(0.05f),
-		residentialMedWealthIncomeFactor(0.03f),
-		residentialHighWealthIncomeFactor(0.01f),
+		incomeEngine(),
+		pCasinoRetractionQueue(nullptr),
+		pSettingsManager(nullptr),
+		settingsGeneration(0),
+		cityInitialized(false),
+		ordinanceEffectsPending(false),
 		ignoreSetOnCallCount(0)
 {
 }
 
 int64_t LegalizeGamblingOrdinanceUpgrade::GetCurrentMonthlyIncome()
 {
-	// We use our own monthly income value instead of the one in the base class.
-	// This prevents our values from altering the save game data, and vice versa.
-
-	double monthlyIncome = static_cast<double>(baseMonthlyIncome);
-
-	// Add the monthly income for each of the residential wealth groups.
-	// If the income factor is 0.0 for any group they will not participate
-	// in the Legalize Gambling ordinance income.
+	Trace::MethodScope timer(methodStatistics, OrdinanceMethod::GetCurrentMonthlyIncome);
+	TraceSpan span("LegalizeGamblingOrdinanceUpgrade::GetCurrentMonthlyIncome");
 
-	if (residentialLowWealthIncomeFactor > 0.0f)
-	{
-		const double lowWealthPopulation = GetCityPopulation(0x1011);
-		if (lowWealthPopulation > 0.0)
-		{
-			const double gamblingPopulationIncome = lowWealthPopulation * static_cast<double>(residentialLowWealthIncomeFactor);
-
-			monthlyIncome += gamblingPopulationIncome;
-		}
-	}
-
-	if (residentialMedWealthIncomeFactor > 0.0f)
-	{
-		const double medWealthPopulation = GetCityPopulation(0x1021);
-		if (medWealthPopulation > 0.0)
-		{
-			const double gamblingPopulationIncome = medWealthPopulation * static_cast<double>(residentialMedWealthIncomeFactor);
-
-			monthlyIncome += gamblingPopulationIncome;
-		}
-	}
-
-	if (residentialHighWealthIncomeFactor > 0.0f)
-	{
-		const double highWealthPopulation = GetCityPopulation(0x1031);
-		if (highWealthPopulation > 0.0)
-		{
-			const double gamblingPopulationIncome = highWealthPopulation * static_cast<double>(residentialHighWealthIncomeFactor);
-
-			monthlyIncome += gamblingPopulationIncome;
-		}
-	}
-
-	int64_t monthlyIncomeInteger = 0;
-
-	if (monthlyIncome < std::numeric_limits<int64_t>::min())
-	{
-		monthlyIncomeInteger = std::numeric_limits<int64_t>::min();
-	}
-	else if (monthlyIncome > std::numeric_limits<int64_t>::max())
-	{
-		monthlyIncomeInteger = std::numeric_limits<int64_t>::max();
-	}
-	else
-	{
-		monthlyIncomeInteger = static_cast<int64_t>(monthlyIncome);
-	}
+	// The game calls this method from the monthly simulation and when the budget
+	// window is open, it is a safe point to apply the settings that were reloaded.
+	ApplySettingsUpdate();
 
-	logger.WriteLineFormatted(
-		LogOptions::OrdinanceAPI,
-		"%s: monthly income: base=%lld, R$ factor=%f, R$$ factor=%f, R$$$ factor=%f, current=%lld",
-		__FUNCTION__,
-		baseMonthlyIncome,
-		residentialLowWealthIncomeFactor,
-		residentialMedWealthIncomeFactor,
-		residentialHighWealthIncomeFactor,
-		monthlyIncomeInteger);
+	// We use our own monthly income value instead of the one in the base class.
+	// This prevents our values from altering the save game data, and vice versa.
 
-	return monthlyIncomeInteger;
+	return incomeEngine.GetBreakdown().totalIncome;
 }
 
 bool LegalizeGamblingOrdinanceUpgrade::SetOn(bool isOn)
 {
+	Trace::MethodScope timer(methodStatistics, OrdinanceMethod::SetOn);
+	TraceSpan span("LegalizeGamblingOrdinanceUpgrade::SetOn");
+
 	// The ordinance simulator turns the ordinance off and on when adding or removing it.
 	// Because this ordinance destroys the Casino building when it is turned off, we ignore
 	// the calls that the ordinance simulator sends when adding or removing the ordinance.
@@ -297,20 +84,19 @@ bool LegalizeGamblingOrdinanceUpgrade::SetOn(bool isOn)
 	if (ignoreSetOnCallCount == 0)
 	{
 		SC4BuiltInOrdinanceBase::SetOn(isOn);
+		incomeEngine.Invalidate();
 
-		if (!isOn)
+		// The Casino is demolished on the next tick, this keeps the UI click that turned the
+		// ordinance off responsive and coalesces repeated toggles into a single retraction.
+		if (pCasinoRetractionQueue)
 		{
-			cISC4AppPtr pSC4App;
-
-			if (pSC4App)
+			if (isOn)
 			{
-				cISC4City* pCity = pSC4App->GetCity();
-
-				if (pCity)
-				{
-					DemolishCasino(pCity);
-					DisableCasinoMenuItem(pSC4App, pCity);
-				}
+				pCasinoRetractionQueue->CancelRetraction();
+			}
+			else
+			{
+				pCasinoRetractionQueue->RequestRetraction();
 			}
 		}
 	}
@@ -320,18 +106,29 @@ bool LegalizeGamblingOrdinanceUpgrade::SetOn(bool isOn)
 
 void LegalizeGamblingOrdinanceUpgrade::InitializeOrdinanceComponents(cISC4City* pCity)
 {
-	SC4BuiltInOrdinanceBase::InitializeOrdinanceComponents(pCity);
-
-	if (pCity)
+	if (ordinanceEffectsPending && pSettingsManager)
 	{
-		pDemandSimulator = pCity->GetDemandSimulator();
+		miscProperties = pSettingsManager->GetSettings()->OrdinanceEffects();
+		ordinanceEffectsPending = false;
+
+		logger.WriteLine(LogOptions::Info, "Applied the reloaded ordinance effects.");
 	}
+
+	SC4BuiltInOrdinanceBase::InitializeOrdinanceComponents(pCity);
+	incomeEngine.SetCity(pCity);
+	cityInitialized = true;
 }
 
 void LegalizeGamblingOrdinanceUpgrade::ShutdownOrdinanceComponents(cISC4City* pCity)
 {
 	SC4BuiltInOrdinanceBase::ShutdownOrdinanceComponents(pCity);
-	pDemandSimulator = nullptr;
+	incomeEngine.SetCity(nullptr);
+	cityInitialized = false;
+}
+
+void LegalizeGamblingOrdinanceUpgrade::AttachCasinoRetractionQueue(CasinoRetractionQueue* pQueue)
+{
+	pCasinoRetractionQueue = pQueue;
 }
 
 void LegalizeGamblingOrdinanceUpgrade::PushIgnoreSetOnCalls()
@@ -349,28 +146,46 @@ void LegalizeGamblingOrdinanceUpgrade::PopIgnoreSetOnCalls()
 
 void LegalizeGamblingOrdinanceUpgrade::UpdateOrdinanceData(const ISettings& settings)
 {
-	this->baseMonthlyIncome = settings.BaseMonthlyIncome();
-	this->residentialLowWealthIncomeFactor = settings.ResidentialLowWealthFactor();
-	this->residentialMedWealthIncomeFactor = settings.ResidentialMedWealthFactor();
-	this->residentialHighWealthIncomeFactor = settings.ResidentialHighWealthFactor();
-	this->miscProperties = settings.OrdinanceEffects();
+	incomeEngine.SetIncomeParameters(
+		settings.BaseMonthlyIncome(),
+		settings.ResidentialLowWealthFactor(),
+		settings.ResidentialMedWealthFactor(),
+		settings.ResidentialHighWealthFactor(),
+		settings.MonthlyIncomeFormula());
+
+	if (cityInitialized)
+	{
+		// Replacing the property list would leave the game with pointers into the old list.
+		ordinanceEffectsPending = true;
+	}
+	else
+	{
+		this->miscProperties = settings.OrdinanceEffects();
+		ordinanceEffectsPending = false;
+	}
 }
 
-float LegalizeGamblingOrdinanceUpgrade::GetCityPopulation(uint32_t groupID)
+void LegalizeGamblingOrdinanceUpgrade::AttachSettings(const SettingsManager& settingsManager)
 {
-	float value = 0.0f;
+	pSettingsManager = &settingsManager;
+	settingsGeneration = settingsManager.GetGeneration();
 
-	if (pDemandSimulator)
-	{
-		constexpr uint32_t cityCensusIndex = 0;
+	UpdateOrdinanceData(*settingsManager.GetSettings());
+}
 
-		const cISC4Demand* demand = pDemandSimulator->GetDemand(groupID, cityCensusIndex);
+void LegalizeGamblingOrdinanceUpgrade::ApplySettingsUpdate()
+{
+	if (pSettingsManager)
+	{
+		const uint32_t generation = pSettingsManager->GetGeneration();
 
-		if (demand)
+		if (generation != settingsGeneration)
 		{
-			value = demand->QuerySupplyValue();
+			settingsGeneration = generation;
+
+			UpdateOrdinanceData(*pSettingsManager->GetSettings());
+
+			logger.WriteLine(LogOptions::Info, "Applied the reloaded settings to the ordinance.");
 		}
 	}
-
-	return value;
 }
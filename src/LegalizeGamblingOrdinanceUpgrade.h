@@ -12,13 +12,13 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #pragma once
+#include "GamblingIncomeEngine.h"
 #include "SC4BuiltInOrdinanceBase.h"
 
+class CasinoRetractionQueue;
 class cISC4City;
-class cISC4DemandSimulator;
-class cISC4Occupant;
-class cISC4OccupantManager;
 class ISettings;
+class SettingsManager;
 
 class LegalizeGamblingOrdinanceUpgrade final : public SC4BuiltInOrdinanceBase
 {
@@ -30,27 +30,43 @@ public:
 
 	bool SetOn(bool isOn) override;
 
+	/**
+	 * @brief Sets the queue that runs the Casino retraction when the ordinance is turned off.
+	 * @param pQueue The queue, or nullptr to leave the Casino in place.
+	*/
+	void AttachCasinoRetractionQueue(CasinoRetractionQueue* pQueue);
+
 	void PushIgnoreSetOnCalls();
 	void PopIgnoreSetOnCalls();
 
 	void UpdateOrdinanceData(const ISettings& settings);
 
+	/**
+	 * @brief Applies the current settings and uses the settings manager to apply
+	 * the settings that are reloaded while the game is running.
+	 * @param settingsManager The settings manager.
+	*/
+	void AttachSettings(const SettingsManager& settingsManager);
+
 private:
 
-	float GetCityPopulation(uint32_t groupID);
+	void ApplySettingsUpdate();
 	void InitializeOrdinanceComponents(cISC4City* pCity) override;
 	void ShutdownOrdinanceComponents(cISC4City* pCity) override;
 
-	cISC4DemandSimulator* pDemandSimulator;
-
-	// We use our own fields for the current monthly income calculations.
+	// We use our own income parameters for the current monthly income calculations.
 	// This is done to avoid modifying that data in the save game.
+	GamblingIncomeEngine incomeEngine;
+
+	CasinoRetractionQueue* pCasinoRetractionQueue;
+
+	const SettingsManager* pSettingsManager;
+	uint32_t settingsGeneration;
 
-	int64_t baseMonthlyIncome;
-	float residentialLowWealthIncomeFactor;
-	float residentialMedWealthIncomeFactor;
-	float residentialHighWealthIncomeFactor;
+	// The game keeps pointers into the ordinance effect properties while a city is running,
+	// so the effects from reloaded settings are applied when the next city is loaded.
+	bool cityInitialized;
+	bool ordinanceEffectsPending;
 
-	
 	uint32_t ignoreSetOnCallCount;
 };
@@ -12,15 +12,21 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "version.h"
+#include "CasinoRetractionQueue.h"
 #include "LegalizeGamblingOrdinanceUpgrade.h"
 #include "Logger.h"
 #include "OrdinancePropertyHolder.h"
-#include "Settings.h"
+#include "RegionIncomeForecast.h"
+#include "RewardOccupantIndex.h"
+#include "SettingsManager.h"
+#include "Tracer.h"
+#include "TraceSpan.h"
 #include "cIGZFrameWork.h"
 #include "cIGZApp.h"
 #include "cISC4App.h"
 #include "cISC4City.h"
 #include "cISC4CivicBuildingSimulator.h"
+#include "cISC4Occupant.h"
 #include "cISC4Ordinance.h"
 #include "cISC4OrdinanceSimulator.h"
 #include "cISC4ResidentialSimulator.h"
@@ -38,6 +44,7 @@
 #include <fstream>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <Windows.h>
 #include "wil/resource.h"
@@ -45,17 +52,21 @@
 
 static constexpr uint32_t kSC4MessagePostCityInit = 0x26d31EC1;
 static constexpr uint32_t kSC4MessagePreCityShutdown = 0x26D31EC2;
+static constexpr uint32_t kSC4MessageInsertOccupant = 0x99EF1142;
+static constexpr uint32_t kSC4MessageRemoveOccupant = 0xC566A2B5;
 
 static constexpr uint32_t kLegalizeGamblingUpgradePluginDirectorID = 0x464631d7;
 
 static constexpr std::string_view PluginConfigFileName = "SC4LegalizeGamblingUpgrade.ini";
 static constexpr std::string_view PluginLogFileName = "SC4LegalizeGamblingUpgrade.log";
+static constexpr std::string_view PluginTraceFileName = "SC4LegalizeGamblingUpgrade.trace.json";
 
 class LegalizeGamblingUpgradeDllDirector : public cRZMessage2COMDirector
 {
 public:
 
 	LegalizeGamblingUpgradeDllDirector()
+		: casinoRetractionQueue(rewardOccupantIndex)
 	{
 		std::filesystem::path dllFolderPath = GetDllFolderPath();
 
@@ -68,6 +79,11 @@ public:
 		Logger& logger = Logger::GetInstance();
 		logger.Init(logFilePath, LogOptions::Errors);
 		logger.WriteLogFileHeader("SC4LegalizeGamblingUpgrade v" PLUGIN_VERSION_STR);
+
+		std::filesystem::path traceFilePath = dllFolderPath;
+		traceFilePath /= PluginTraceFileName;
+
+		Tracer::GetInstance().Init(traceFilePath);
 	}
 
 	uint32_t GetDirectorID() const
@@ -139,12 +155,17 @@ public:
 
 	void PostCityInit(cIGZMessage2Standard* pStandardMsg)
 	{
+		TraceSpan span("PostCityInit");
+
 		cISC4City* pCity = reinterpret_cast<cISC4City*>(pStandardMsg->GetIGZUnknown());
 
 		if (pCity)
 		{
 			//DumpConditionalBuildingStatus(pCity);
 
+			StartRewardOccupantIndex(pCity);
+			casinoRetractionQueue.Start(pCity);
+
 			cISC4OrdinanceSimulator* pOrdinanceSimulator = pCity->GetOrdinanceSimulator();
 
 			if (pOrdinanceSimulator)
@@ -159,12 +180,14 @@ public:
 					LegalizeGamblingOrdinanceUpgrade* item = reinterpret_cast<LegalizeGamblingOrdinanceUpgrade*>(pOrdinance);
 
 					item->Init();
-					item->UpdateOrdinanceData(settings);
+					item->AttachSettings(settingsManager);
+					item->AttachCasinoRetractionQueue(&casinoRetractionQueue);
 				}
 				else
 				{
 					legalizeGamblingOrdinanceUpgrade.Init();
-					legalizeGamblingOrdinanceUpgrade.UpdateOrdinanceData(settings);
+					legalizeGamblingOrdinanceUpgrade.AttachSettings(settingsManager);
+					legalizeGamblingOrdinanceUpgrade.AttachCasinoRetractionQueue(&casinoRetractionQueue);
 
 					// The ordinance simulator turns the ordinance off and on when adding or removing it.
 					// Because this ordinance destroys the Casino building when it is turned off, we ignore
@@ -178,11 +201,52 @@ public:
 
 				//DumpRegisteredOrdinances(pCity, pOrdinanceSimulator);
 			}
+
+			WriteRegionIncomeForecast();
+		}
+	}
+
+	void StartRewardOccupantIndex(cISC4City* pCity)
+	{
+		TraceSpan span("StartRewardOccupantIndex");
+
+		// The occupant notifications are only needed while the index is in use, this avoids
+		// handling the notifications for every occupant that is created when a city is loaded.
+		cIGZMessageServer2Ptr pMsgServ;
+
+		if (pMsgServ
+			&& pMsgServ->AddNotification(this, kSC4MessageInsertOccupant)
+			&& pMsgServ->AddNotification(this, kSC4MessageRemoveOccupant))
+		{
+			rewardOccupantIndex.Build(pCity);
+		}
+		else
+		{
+			Logger::GetInstance().WriteLine(
+				LogOptions::Errors,
+				"Failed to subscribe to the occupant notifications, the Casino will be found by searching the city.");
 		}
 	}
 
+	void StopRewardOccupantIndex()
+	{
+		cIGZMessageServer2Ptr pMsgServ;
+
+		if (pMsgServ)
+		{
+			pMsgServ->RemoveNotification(this, kSC4MessageInsertOccupant);
+			pMsgServ->RemoveNotification(this, kSC4MessageRemoveOccupant);
+		}
+
+		rewardOccupantIndex.Clear();
+	}
+
 	void PreCityShutdown(cIGZMessage2Standard* pStandardMsg)
 	{
+		TraceSpan span("PreCityShutdown");
+
+		casinoRetractionQueue.Stop();
+
 		cISC4City* pCity = reinterpret_cast<cISC4City*>(pStandardMsg->GetIGZUnknown());
 
 		if (pCity)
@@ -212,6 +276,10 @@ public:
 				legalizeGamblingOrdinanceUpgrade.PopIgnoreSetOnCalls();
 			}
 		}
+
+		StopRewardOccupantIndex();
+
+		Logger::GetInstance().Flush();
 	}
 
 	bool DoMessage(cIGZMessage2* pMessage)
@@ -226,6 +294,14 @@ public:
 			break;
 		case kSC4MessagePreCityShutdown:
 			PreCityShutdown(pStandardMsg);
+			// The trace is written after PreCityShutdown, this allows it to include that span.
+			Tracer::GetInstance().Flush();
+			break;
+		case kSC4MessageInsertOccupant:
+			rewardOccupantIndex.OnOccupantInserted(static_cast<cISC4Occupant*>(pStandardMsg->GetVoid1()));
+			break;
+		case kSC4MessageRemoveOccupant:
+			rewardOccupantIndex.OnOccupantRemoved(static_cast<cISC4Occupant*>(pStandardMsg->GetVoid1()));
 			break;
 		}
 
@@ -238,7 +314,7 @@ public:
 
 		try
 		{
-			settings.Load(configFilePath);
+			settingsManager.Load(configFilePath);
 		}
 		catch (const std::exception& e)
 		{
@@ -246,6 +322,14 @@ public:
 			return false;
 		}
 
+		// The logging and tracing settings are only applied at startup.
+		std::shared_ptr<const Settings> settings = settingsManager.GetSettings();
+
+		logger.Configure(settings->LoggingConfiguration());
+		Tracer::GetInstance().SetEnabled(settings->TracingEnabled());
+
+		settingsManager.StartWatching();
+
 		cIGZMessageServer2Ptr pMsgServ;
 		if (pMsgServ)
 		{
@@ -272,6 +356,17 @@ public:
 		return true;
 	}
 
+	bool PostAppShutdown()
+	{
+		// Stop the background log writer while the game is still running, the
+		// writer thread cannot be safely joined when the DLL is being unloaded.
+		settingsManager.StopWatching();
+		WaitForRegionIncomeForecast();
+		Logger::GetInstance().Shutdown();
+		Tracer::GetInstance().Shutdown();
+		return true;
+	}
+
 	bool OnStart(cIGZCOM* pCOM)
 	{
 		cIGZFrameWork* const pFramework = RZGetFrameWork();
@@ -298,6 +393,55 @@ private:
 		return temp.parent_path();
 	}
 
+	void WriteRegionIncomeForecast()
+	{
+		if (!Logger::GetInstance().IsEnabled(LogOptions::RegionIncomeForecast))
+		{
+			return;
+		}
+
+		TraceSpan span("WriteRegionIncomeForecast");
+
+		cISC4AppPtr pSC4App;
+
+		if (pSC4App)
+		{
+			RegionIncomeForecast forecast;
+
+			if (forecast.Capture(pSC4App->GetRegion()))
+			{
+				// The region is read on the game thread, the income of each city is calculated
+				// and logged on a worker thread so that it does not delay the city load.
+				WaitForRegionIncomeForecast();
+
+				try
+				{
+					forecastThread = std::thread(
+						[forecast = std::move(forecast), settings = settingsManager.GetSettings()]() mutable
+						{
+							forecast.Calculate(*settings);
+							forecast.WriteToLog();
+						});
+				}
+				catch (const std::exception& e)
+				{
+					Logger::GetInstance().WriteLineFormatted(
+						LogOptions::Errors,
+						"Failed to start the region income forecast: %s",
+						e.what());
+				}
+			}
+		}
+	}
+
+	void WaitForRegionIncomeForecast()
+	{
+		if (forecastThread.joinable())
+		{
+			forecastThread.join();
+		}
+	}
+
 	void DumpRegisteredOrdinances(cISC4City* pCity, cISC4OrdinanceSimulator* pOrdinanceSimulator)
 	{
 		Logger& logger = Logger::GetInstance();
@@ -379,8 +523,11 @@ private:
 	}
 
 	std::filesystem::path configFilePath;
-	Settings settings;
+	SettingsManager settingsManager;
+	RewardOccupantIndex rewardOccupantIndex;
+	CasinoRetractionQueue casinoRetractionQueue;
 	LegalizeGamblingOrdinanceUpgrade legalizeGamblingOrdinanceUpgrade;
+	std::thread forecastThread;
 };
 
 cRZCOMDllDirector* RZGetCOMDllDirector() {
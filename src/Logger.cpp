@@ -12,6 +12,10 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "Logger.h"
+#include "AsyncLogWriter.h"
+#include "BinaryLogEncoder.h"
+#include <cstring>
+#include <thread>
 #include <Windows.h>
 
 
@@ -56,12 +60,23 @@ Logger& Logger::GetInstance()
 	return logger;
 }
 
-Logger::Logger() : initialized(false), logFile(), logOptions(LogOptions::Errors)
+Logger::Logger()
+	: initialized(false),
+	  logOptions(LogOptions::Errors),
+	  logFilePath(),
+	  logFileHeader(),
+	  logFile(),
+	  writeMutex(),
+	  asyncWriter(),
+	  binaryEncoder(),
+	  asyncWriterAccepting(false),
+	  asyncWriterUserCount(0)
 {
 }
 
 Logger::~Logger()
 {
+	Shutdown();
 	initialized = false;
 }
 
@@ -71,21 +86,132 @@ void Logger::Init(std::filesystem::path logFilePath, LogOptions options)
 	{
 		initialized = true;
 
-		logFile.open(logFilePath, std::ofstream::out | std::ofstream::trunc);
-		logOptions = options;
+		logFile.SetPrologueCallback(&Logger::GetLogFilePrologueCallback, this);
+		logFile.Open(logFilePath);
+		logOptions = options & CompiledLogOptions;
+		this->logFilePath = logFilePath;
 	}
 }
 
-bool Logger::IsEnabled(LogOptions option) const
+void Logger::Configure(const LogConfiguration& configuration)
 {
-	return (logOptions & option) != LogOptions::None;
+	if (!initialized)
+	{
+		return;
+	}
+
+	// The options that were not compiled into the plugin cannot be enabled.
+	logOptions = configuration.options & CompiledLogOptions;
+
+	// The log file configuration cannot be changed while the writer thread is using it,
+	// the writer is stopped and then restarted with the new configuration.
+	const uint64_t droppedMessageCount = StopAsyncWriter();
+	bool formatChangeRejected = false;
+
+	{
+		std::scoped_lock lock(writeMutex);
+
+		logFile.SetLimits(
+			configuration.maxFileSize,
+			configuration.rotatedFileCount,
+			configuration.flushIntervalMilliseconds);
+
+		if (configuration.format == LogFormat::Binary)
+		{
+			if (!binaryEncoder)
+			{
+				// The binary log replaces the text log that was started in Init.
+				// Reset writes the binary file header to the new file through the prologue callback.
+				binaryEncoder = std::make_unique<BinaryLogEncoder>();
+				logFile.Reset();
+			}
+		}
+		else if (binaryEncoder)
+		{
+			// The other threads read the encoder without a lock, so it is kept until the logger is destroyed.
+			formatChangeRejected = true;
+		}
+	}
+
+	if (logFile && configuration.backgroundWriter)
+	{
+		StartAsyncWriter(configuration.overflowPolicy);
+	}
+
+	if (droppedMessageCount > 0)
+	{
+		WriteLineFormatted(
+			LogOptions::Errors,
+			"The background log writer dropped %llu message(s) because its queue was full.",
+			droppedMessageCount);
+	}
+
+	if (formatChangeRejected)
+	{
+		WriteLine(LogOptions::Errors, "The log format cannot be changed from binary to text while the game is running.");
+	}
 }
 
-void Logger::WriteLogFileHeader(const char* const text)
+void Logger::Flush()
 {
+	AsyncWriterScope writer(*this);
+
+	if (writer)
+	{
+		writer->Flush();
+	}
+	else if (initialized && logFile)
+	{
+		std::scoped_lock lock(writeMutex);
+
+		logFile.Flush();
+	}
+}
+
+void Logger::Shutdown()
+{
+	const uint64_t droppedMessageCount = StopAsyncWriter();
+
+	if (droppedMessageCount > 0)
+	{
+		WriteLineFormatted(
+			LogOptions::Errors,
+			"The background log writer dropped %llu message(s) because its queue was full.",
+			droppedMessageCount);
+	}
+
 	if (initialized && logFile)
 	{
-		logFile << text << std::endl;
+		std::scoped_lock lock(writeMutex);
+
+		logFile.Flush();
+	}
+}
+
+void Logger::WriteLogFileHeader(const char* const text)
+{
+	logFileHeader = text;
+
+	if (binaryEncoder)
+	{
+		BinaryLogEncoder::RecordBuffer record;
+
+		WriteBinaryRecord(record.data(), BinaryLogEncoder::EncodeHeader(text, record));
+		return;
+	}
+
+	AsyncWriterScope writer(*this);
+
+	if (writer)
+	{
+		writer->WriteLine(text, false);
+	}
+	else if (initialized && logFile)
+	{
+		std::scoped_lock lock(writeMutex);
+
+		logFile.Write(text, std::strlen(text));
+		logFile.Write("\n", 1);
 	}
 }
 
@@ -109,6 +235,40 @@ void Logger::WriteLineFormatted(LogOptions options, const char* const format, ..
 	va_list args;
 	va_start(args, format);
 
+	WriteLineFormattedV(format, args);
+
+	va_end(args);
+}
+
+void Logger::WriteLineFormattedCore(const char* const format, ...)
+{
+	va_list args;
+	va_start(args, format);
+
+	WriteLineFormattedV(format, args);
+
+	va_end(args);
+}
+
+void Logger::WriteLineFormattedV(const char* const format, va_list args)
+{
+	if (binaryEncoder)
+	{
+		WriteBinaryFormatted(format, args);
+		return;
+	}
+
+	{
+		AsyncWriterScope writer(*this);
+
+		if (writer)
+		{
+			// The background writer formats the message directly into its queue.
+			writer->WriteLineFormatted(format, args);
+			return;
+		}
+	}
+
 	va_list argsCopy;
 	va_copy(argsCopy, args);
 
@@ -126,18 +286,193 @@ void Logger::WriteLineFormatted(LogOptions options, const char* const format, ..
 
 		WriteLineCore(buffer.get());
 	}
-
-	va_end(args);
 }
 
 void Logger::WriteLineCore(const char* const message)
 {
+	if (binaryEncoder)
+	{
+		BinaryLogEncoder::RecordBuffer record;
+
+		WriteBinaryRecord(record.data(), BinaryLogEncoder::EncodeMessage(message, record));
+		return;
+	}
+
+	{
+		AsyncWriterScope writer(*this);
+
+		if (writer)
+		{
+			writer->WriteLine(message, true);
+			return;
+		}
+	}
+
 #ifdef _DEBUG
 	PrintLineToDebugOutput(message);
 #endif // _DEBUG
 
 	if (initialized && logFile)
 	{
-		logFile << GetTimeStamp() << message << std::endl;
+		std::string line = GetTimeStamp();
+		line.append(message);
+		line.append(1, '\n');
+
+		std::scoped_lock lock(writeMutex);
+
+		logFile.Write(line.data(), line.size());
+	}
+}
+
+void Logger::WriteBinaryFormatted(const char* const format, va_list args)
+{
+	BinaryLogEncoder::RecordBuffer record;
+
+	size_t recordSize = binaryEncoder->EncodeFormattedMessage(
+		format,
+		args,
+		record,
+		&Logger::WriteBinaryRecordCallback,
+		this);
+
+	if (recordSize == 0)
+	{
+		// The message cannot be stored as a format id and its arguments,
+		// so it is formatted and written as a plain message.
+		char message[BinaryLogFormat::MaxRecordSize]{};
+
+		std::vsnprintf(message, sizeof(message), format, args);
+
+		recordSize = BinaryLogEncoder::EncodeMessage(message, record);
+	}
+
+	WriteBinaryRecord(record.data(), recordSize);
+}
+
+void Logger::WriteBinaryRecord(const uint8_t* data, size_t size)
+{
+	AsyncWriterScope writer(*this);
+
+	if (writer)
+	{
+		writer->WriteBinaryRecord(data, size);
 	}
-}
\ No newline at end of file
+	else if (initialized && logFile)
+	{
+		std::scoped_lock lock(writeMutex);
+
+		logFile.Write(data, size);
+	}
+}
+
+void Logger::StartAsyncWriter(LogOverflowPolicy overflowPolicy)
+{
+	// The lock keeps the producers that write on their own thread out of the log file
+	// until the writer thread owns it.
+	std::scoped_lock lock(writeMutex);
+
+	asyncWriter = std::make_unique<AsyncLogWriter>(logFile, overflowPolicy);
+	asyncWriter->Start();
+
+	asyncWriterAccepting.store(true, std::memory_order_seq_cst);
+}
+
+uint64_t Logger::StopAsyncWriter()
+{
+	uint64_t droppedMessageCount = 0;
+
+	if (asyncWriter)
+	{
+		// The producers that arrive after the flag is cleared fall back to writing on their
+		// own thread, they wait on the lock until the writer thread has stopped.
+		std::scoped_lock lock(writeMutex);
+
+		asyncWriterAccepting.store(false, std::memory_order_seq_cst);
+
+		// Wait for the producers that are still using the writer.
+		while (asyncWriterUserCount.load(std::memory_order_seq_cst) != 0)
+		{
+			std::this_thread::yield();
+		}
+
+		asyncWriter->Stop();
+		droppedMessageCount = asyncWriter->GetDroppedMessageCount();
+		asyncWriter.reset();
+	}
+
+	return droppedMessageCount;
+}
+
+void Logger::WriteBinaryRecordCallback(const uint8_t* data, size_t size, void* context)
+{
+	static_cast<Logger*>(context)->WriteBinaryRecord(data, size);
+}
+
+void Logger::GetLogFilePrologueCallback(std::string& prologue, void* context)
+{
+	// The prologue is written at the start of every log file, this allows each
+	// file to be read without the files that were rotated before it.
+	const Logger* logger = static_cast<const Logger*>(context);
+
+	if (logger->binaryEncoder)
+	{
+		BinaryLogEncoder::RecordBuffer record;
+
+		size_t recordSize = BinaryLogEncoder::EncodeFileHeader(record);
+		prologue.append(reinterpret_cast<const char*>(record.data()), recordSize);
+
+		if (!logger->logFileHeader.empty())
+		{
+			recordSize = BinaryLogEncoder::EncodeHeader(logger->logFileHeader.c_str(), record);
+			prologue.append(reinterpret_cast<const char*>(record.data()), recordSize);
+		}
+
+		// The messages in the new file may use any of the format strings that were
+		// defined in the previous files.
+		logger->binaryEncoder->AppendFormatDefinitions(prologue);
+	}
+	else if (!logger->logFileHeader.empty())
+	{
+		prologue.append(logger->logFileHeader);
+		prologue.append(1, '\n');
+	}
+}
+
+Logger::AsyncWriterScope::AsyncWriterScope(Logger& logger)
+	: logger(logger),
+	  writer(nullptr)
+{
+	if (logger.asyncWriterAccepting.load(std::memory_order_relaxed))
+	{
+		// The user count is incremented before the flag is checked again, StopAsyncWriter
+		// clears the flag before it waits for the count to reach zero.
+		logger.asyncWriterUserCount.fetch_add(1, std::memory_order_seq_cst);
+
+		if (logger.asyncWriterAccepting.load(std::memory_order_seq_cst))
+		{
+			writer = logger.asyncWriter.get();
+		}
+		else
+		{
+			logger.asyncWriterUserCount.fetch_sub(1, std::memory_order_seq_cst);
+		}
+	}
+}
+
+Logger::AsyncWriterScope::~AsyncWriterScope()
+{
+	if (writer)
+	{
+		logger.asyncWriterUserCount.fetch_sub(1, std::memory_order_seq_cst);
+	}
+}
+
+Logger::AsyncWriterScope::operator bool() const
+{
+	return writer != nullptr;
+}
+
+AsyncLogWriter* Logger::AsyncWriterScope::operator->() const
+{
+	return writer;
+}
@@ -13,8 +13,13 @@
 
 #pragma once
 
+#include "MappedLogFile.h"
+#include <atomic>
+#include <cstdarg>
 #include <filesystem>
-#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
 
 enum class LogOptions : int32_t
 {
@@ -24,11 +29,13 @@ enum class LogOptions : int32_t
 	OrdinanceAPI = 1 << 2,
 	OrdinancePropertyAPI = 1 << 3,
 	DumpRegisteredOrdinances = 1 << 4,
+	OrdinanceStatistics = 1 << 5,
+	RegionIncomeForecast = 1 << 6,
 	InfoAndErrors = Info | Errors,
-	All = Info | Errors | OrdinanceAPI | OrdinancePropertyAPI | DumpRegisteredOrdinances
+	All = Info | Errors | OrdinanceAPI | OrdinancePropertyAPI | DumpRegisteredOrdinances | OrdinanceStatistics | RegionIncomeForecast
 };
 
-inline LogOptions operator|(LogOptions lhs, LogOptions rhs)
+constexpr LogOptions operator|(LogOptions lhs, LogOptions rhs)
 {
 	return static_cast<LogOptions>(
 		static_cast<std::underlying_type<LogOptions>::type>(lhs) |
@@ -36,7 +43,7 @@ inline LogOptions operator|(LogOptions lhs, LogOptions rhs)
 		);
 }
 
-inline LogOptions operator&(LogOptions lhs, LogOptions rhs)
+constexpr LogOptions operator&(LogOptions lhs, LogOptions rhs)
 {
 	return static_cast<LogOptions>(
 		static_cast<std::underlying_type<LogOptions>::type>(lhs) &
@@ -44,6 +51,63 @@ inline LogOptions operator&(LogOptions lhs, LogOptions rhs)
 		);
 }
 
+// The log options that are compiled into the plugin.
+// The logging calls that use the template overloads of Logger::WriteLine and Logger::WriteLineFormatted
+// are removed by the compiler when their option is not in this set.
+// The default can be replaced by defining SC4LGU_COMPILED_LOG_OPTIONS in the project settings,
+// e.g. SC4LGU_COMPILED_LOG_OPTIONS=LogOptions::All to enable the ordinance API logging and the getter
+// statistics in a release build.
+#ifndef SC4LGU_COMPILED_LOG_OPTIONS
+#ifdef _DEBUG
+#define SC4LGU_COMPILED_LOG_OPTIONS LogOptions::All
+#else
+#define SC4LGU_COMPILED_LOG_OPTIONS LogOptions::InfoAndErrors | LogOptions::DumpRegisteredOrdinances | LogOptions::OrdinanceStatistics | LogOptions::RegionIncomeForecast
+#endif // _DEBUG
+#endif // !SC4LGU_COMPILED_LOG_OPTIONS
+
+static constexpr LogOptions CompiledLogOptions = SC4LGU_COMPILED_LOG_OPTIONS;
+
+template <LogOptions Options>
+struct LogOptionsPolicy
+{
+	static constexpr bool IsCompiled = (CompiledLogOptions & Options) != LogOptions::None;
+};
+
+// Controls what the background writer does when its message queue is full.
+enum class LogOverflowPolicy : int32_t
+{
+	// Discard the new message.
+	Drop = 0,
+	// Wait until the writer thread has made room for the new message.
+	Block
+};
+
+enum class LogFormat : int32_t
+{
+	Text = 0,
+	// A compact binary format that is converted to text by the log decoder tool.
+	Binary
+};
+
+struct LogConfiguration
+{
+	// The log options that are enabled, this replaces the options that were set when the logger was initialized.
+	LogOptions options = LogOptions::Errors;
+	LogFormat format = LogFormat::Text;
+	// Writes the log file from a background thread instead of the game thread.
+	bool backgroundWriter = false;
+	LogOverflowPolicy overflowPolicy = LogOverflowPolicy::Drop;
+	// The maximum size of a log file before it is rotated, zero for no limit.
+	uint64_t maxFileSize = 10 * 1024 * 1024;
+	// The number of old log files that are kept.
+	uint32_t rotatedFileCount = 3;
+	// The minimum time between the flushes of the memory-mapped log file.
+	uint32_t flushIntervalMilliseconds = 1000;
+};
+
+class AsyncLogWriter;
+class BinaryLogEncoder;
+
 class Logger
 {
 public:
@@ -52,7 +116,40 @@ public:
 
 	void Init(std::filesystem::path logFilePath, LogOptions logLevel);
 
-	bool IsEnabled(LogOptions option) const;
+	/**
+	 * @brief Applies the configuration from the settings file.
+	 * If the background writer is running it is stopped and restarted with the new configuration.
+	 * @param configuration The logger configuration.
+	*/
+	void Configure(const LogConfiguration& configuration);
+
+	/**
+	 * @brief Waits until all of the pending messages have been written to disk.
+	*/
+	void Flush();
+
+	/**
+	 * @brief Stops the background writer and flushes the log file.
+	 * Any messages written after this call are written on the calling thread.
+	*/
+	void Shutdown();
+
+	bool IsEnabled(LogOptions option) const
+	{
+		return (logOptions & option) != LogOptions::None;
+	}
+
+	template <LogOptions Option> bool IsEnabled() const
+	{
+		if constexpr (LogOptionsPolicy<Option>::IsCompiled)
+		{
+			return IsEnabled(Option);
+		}
+		else
+		{
+			return false;
+		}
+	}
 
 	void WriteLogFileHeader(const char* const message);
 
@@ -60,15 +157,88 @@ public:
 
 	void WriteLineFormatted(LogOptions level, const char* const format, ...);
 
+	/**
+	 * @brief Writes a message if the option is enabled.
+	 * The call is removed at compile time if the option is not in CompiledLogOptions.
+	*/
+	template <LogOptions Option> void WriteLine(const char* const message)
+	{
+		if constexpr (LogOptionsPolicy<Option>::IsCompiled)
+		{
+			if (IsEnabled(Option))
+			{
+				WriteLineCore(message);
+			}
+		}
+	}
+
+	/**
+	 * @brief Writes a formatted message if the option is enabled.
+	 * The call is removed at compile time if the option is not in CompiledLogOptions.
+	*/
+	template <LogOptions Option, typename... Args> void WriteLineFormatted(const char* const format, Args... args)
+	{
+		if constexpr (LogOptionsPolicy<Option>::IsCompiled)
+		{
+			if (IsEnabled(Option))
+			{
+				WriteLineFormattedCore(format, args...);
+			}
+		}
+	}
+
 private:
 
+	// Registers the calling thread as a user of the background writer, Shutdown waits
+	// until all of the users have released the writer before it is destroyed.
+	class AsyncWriterScope
+	{
+	public:
+
+		explicit AsyncWriterScope(Logger& logger);
+		~AsyncWriterScope();
+
+		AsyncWriterScope(const AsyncWriterScope&) = delete;
+		AsyncWriterScope& operator=(const AsyncWriterScope&) = delete;
+
+		explicit operator bool() const;
+		AsyncLogWriter* operator->() const;
+
+	private:
+
+		Logger& logger;
+		AsyncLogWriter* writer;
+	};
+
 	Logger();
 	~Logger();
 
+	void StartAsyncWriter(LogOverflowPolicy overflowPolicy);
+	uint64_t StopAsyncWriter();
+
 	void WriteLineCore(const char* const message);
+	void WriteLineFormattedCore(const char* const format, ...);
+	void WriteLineFormattedV(const char* const format, va_list args);
+
+	void WriteBinaryFormatted(const char* const format, va_list args);
+	void WriteBinaryRecord(const uint8_t* data, size_t size);
+	static void WriteBinaryRecordCallback(const uint8_t* data, size_t size, void* context);
+	static void GetLogFilePrologueCallback(std::string& prologue, void* context);
 
 	bool initialized;
 	LogOptions logOptions;
-	std::ofstream logFile;
+	std::filesystem::path logFilePath;
+	std::string logFileHeader;
+	MappedLogFile logFile;
+	// Serializes the writes to the log file when the background writer is not used,
+	// the settings file watcher thread can write to the log.
+	std::mutex writeMutex;
+	std::unique_ptr<AsyncLogWriter> asyncWriter;
+	std::unique_ptr<BinaryLogEncoder> binaryEncoder;
+	// The producers only use the background writer while this is true, it is cleared
+	// before the writer is stopped.
+	std::atomic<bool> asyncWriterAccepting;
+	// The number of threads that are currently using the background writer.
+	std::atomic<uint32_t> asyncWriterUserCount;
 };
 
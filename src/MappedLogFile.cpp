@@ -0,0 +1,331 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "MappedLogFile.h"
+#include <cstring>
+#include <system_error>
+#include <Windows.h>
+
+namespace
+{
+	// The size of the mapped view, it must be a multiple of the system allocation granularity (64 KB).
+	// The file is extended one view at a time, the unused part of the last view is trimmed when
+	// the file is closed.
+	constexpr uint64_t ViewSize = 1024 * 1024;
+
+	constexpr uint64_t DefaultMaxFileSize = 10 * 1024 * 1024;
+	constexpr uint32_t DefaultRotatedFileCount = 3;
+	constexpr uint32_t DefaultFlushIntervalMilliseconds = 1000;
+}
+
+MappedLogFile::MappedLogFile()
+	: path(),
+	  file(),
+	  mapping(),
+	  view(nullptr),
+	  viewOffset(0),
+	  fileSize(0),
+	  prologueSize(0),
+	  maxFileSize(DefaultMaxFileSize),
+	  rotatedFileCount(DefaultRotatedFileCount),
+	  flushIntervalMilliseconds(DefaultFlushIntervalMilliseconds),
+	  lastFlushTime(0),
+	  viewModified(false),
+	  getPrologue(nullptr),
+	  getPrologueContext(nullptr),
+	  prologueBuffer()
+{
+}
+
+MappedLogFile::~MappedLogFile()
+{
+	Close();
+}
+
+bool MappedLogFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	this->path = path;
+
+	// The previous log files are kept, the log from the last session becomes <name>.1<ext>.
+	std::error_code ec;
+
+	if (std::filesystem::file_size(path, ec) > 0 && !ec)
+	{
+		RotateFiles();
+	}
+
+	return CreateCurrentFile();
+}
+
+void MappedLogFile::Close()
+{
+	CloseCurrentFile();
+}
+
+bool MappedLogFile::IsOpen() const
+{
+	return view != nullptr;
+}
+
+MappedLogFile::operator bool() const
+{
+	return IsOpen();
+}
+
+void MappedLogFile::SetLimits(uint64_t maxFileSize, uint32_t rotatedFileCount, uint32_t flushIntervalMilliseconds)
+{
+	this->maxFileSize = maxFileSize;
+	this->rotatedFileCount = rotatedFileCount;
+	this->flushIntervalMilliseconds = flushIntervalMilliseconds;
+}
+
+void MappedLogFile::SetPrologueCallback(GetPrologueCallback callback, void* context)
+{
+	getPrologue = callback;
+	getPrologueContext = context;
+}
+
+void MappedLogFile::Reset()
+{
+	if (file)
+	{
+		CloseCurrentFile();
+		CreateCurrentFile();
+	}
+}
+
+void MappedLogFile::Write(const void* data, size_t size)
+{
+	if (!view)
+	{
+		return;
+	}
+
+	// The file is rotated when the data does not fit, unless the file only contains
+	// the prologue. In that case the data is larger than the maximum file size and
+	// it is written to the current file.
+	if (maxFileSize > 0 && (fileSize + size) > maxFileSize && fileSize > prologueSize)
+	{
+		StartNewFile();
+
+		if (!view)
+		{
+			return;
+		}
+	}
+
+	const uint8_t* source = static_cast<const uint8_t*>(data);
+	size_t remaining = size;
+
+	while (remaining > 0)
+	{
+		const uint64_t viewEnd = viewOffset + ViewSize;
+
+		if (fileSize >= viewEnd)
+		{
+			if (!MapView(viewEnd))
+			{
+				return;
+			}
+
+			continue;
+		}
+
+		size_t count = remaining;
+
+		if (count > (viewEnd - fileSize))
+		{
+			count = static_cast<size_t>(viewEnd - fileSize);
+		}
+
+		std::memcpy(view + (fileSize - viewOffset), source, count);
+
+		source += count;
+		remaining -= count;
+		fileSize += count;
+		viewModified = true;
+	}
+
+	const uint64_t now = GetTickCount64();
+
+	if ((now - lastFlushTime) >= flushIntervalMilliseconds)
+	{
+		Flush();
+		lastFlushTime = now;
+	}
+}
+
+void MappedLogFile::Flush()
+{
+	if (view && viewModified)
+	{
+		FlushViewOfFile(view, 0);
+		viewModified = false;
+	}
+}
+
+bool MappedLogFile::CreateCurrentFile()
+{
+	file.reset(CreateFileW(
+		path.c_str(),
+		GENERIC_READ | GENERIC_WRITE,
+		FILE_SHARE_READ | FILE_SHARE_DELETE,
+		nullptr,
+		CREATE_ALWAYS,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr));
+
+	if (!file)
+	{
+		return false;
+	}
+
+	fileSize = 0;
+	prologueSize = 0;
+
+	if (!MapView(0))
+	{
+		file.reset();
+		return false;
+	}
+
+	lastFlushTime = GetTickCount64();
+
+	WritePrologue();
+
+	return true;
+}
+
+void MappedLogFile::CloseCurrentFile()
+{
+	if (file)
+	{
+		Flush();
+		UnmapView();
+
+		// Remove the unused part of the last view from the end of the file.
+		LARGE_INTEGER size{};
+		size.QuadPart = static_cast<LONGLONG>(fileSize);
+
+		if (SetFilePointerEx(file.get(), size, nullptr, FILE_BEGIN))
+		{
+			SetEndOfFile(file.get());
+		}
+
+		file.reset();
+	}
+
+	fileSize = 0;
+	prologueSize = 0;
+}
+
+bool MappedLogFile::MapView(uint64_t offset)
+{
+	Flush();
+	UnmapView();
+
+	// The file mapping must cover the whole view, this extends the file.
+	const uint64_t mappingSize = offset + ViewSize;
+
+	mapping.reset(CreateFileMappingW(
+		file.get(),
+		nullptr,
+		PAGE_READWRITE,
+		static_cast<DWORD>(mappingSize >> 32),
+		static_cast<DWORD>(mappingSize & 0xFFFFFFFF),
+		nullptr));
+
+	if (!mapping)
+	{
+		return false;
+	}
+
+	view = static_cast<uint8_t*>(MapViewOfFile(
+		mapping.get(),
+		FILE_MAP_WRITE,
+		static_cast<DWORD>(offset >> 32),
+		static_cast<DWORD>(offset & 0xFFFFFFFF),
+		static_cast<size_t>(ViewSize)));
+
+	if (!view)
+	{
+		mapping.reset();
+		return false;
+	}
+
+	viewOffset = offset;
+
+	return true;
+}
+
+void MappedLogFile::UnmapView()
+{
+	if (view)
+	{
+		UnmapViewOfFile(view);
+		view = nullptr;
+	}
+
+	mapping.reset();
+	viewOffset = 0;
+	viewModified = false;
+}
+
+void MappedLogFile::RotateFiles()
+{
+	std::error_code ec;
+
+	if (rotatedFileCount == 0)
+	{
+		std::filesystem::remove(path, ec);
+		return;
+	}
+
+	std::filesystem::remove(GetRotatedFilePath(rotatedFileCount), ec);
+
+	for (uint32_t number = rotatedFileCount - 1; number > 0; number--)
+	{
+		std::filesystem::rename(GetRotatedFilePath(number), GetRotatedFilePath(number + 1), ec);
+	}
+
+	std::filesystem::rename(path, GetRotatedFilePath(1), ec);
+}
+
+void MappedLogFile::StartNewFile()
+{
+	CloseCurrentFile();
+	RotateFiles();
+	CreateCurrentFile();
+}
+
+void MappedLogFile::WritePrologue()
+{
+	if (getPrologue)
+	{
+		prologueBuffer.clear();
+		getPrologue(prologueBuffer, getPrologueContext);
+
+		Write(prologueBuffer.data(), prologueBuffer.size());
+		prologueSize = fileSize;
+	}
+}
+
+std::filesystem::path MappedLogFile::GetRotatedFilePath(uint32_t number) const
+{
+	std::filesystem::path rotatedPath = path;
+	rotatedPath.replace_filename(path.stem().wstring() + L"." + std::to_wstring(number) + path.extension().wstring());
+
+	return rotatedPath;
+}
@@ -0,0 +1,107 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include "wil/resource.h"
+
+// A size-capped log file that is written through a memory-mapped view.
+//
+// The messages are copied into the view instead of being written with a file I/O call,
+// the operating system writes the modified pages to disk in the background and they
+// are explicitly flushed at most once per flush interval.
+// When the file reaches its maximum size it is renamed to <name>.1<ext>, the older
+// files are renamed to <name>.2<ext> and so on, and a new file is started.
+//
+// This class is not thread safe, the Logger ensures that only one thread writes to it.
+class MappedLogFile
+{
+public:
+
+	// Called when a new file is started, the callback appends the data that must be
+	// written at the start of every file, e.g. the log file header.
+	using GetPrologueCallback = void(*)(std::string& prologue, void* context);
+
+	MappedLogFile();
+	~MappedLogFile();
+
+	MappedLogFile(const MappedLogFile&) = delete;
+	MappedLogFile& operator=(const MappedLogFile&) = delete;
+
+	/**
+	 * @brief Opens the log file, the existing log files are rotated.
+	 * @param path The log file path.
+	 * @return True if the file was opened; otherwise, false.
+	*/
+	bool Open(const std::filesystem::path& path);
+
+	/**
+	 * @brief Closes the file and trims it to the size of the data that was written.
+	*/
+	void Close();
+
+	bool IsOpen() const;
+
+	explicit operator bool() const;
+
+	/**
+	 * @brief Sets the file size and rotation limits.
+	 * @param maxFileSize The maximum size of a log file in bytes, or zero for no limit.
+	 * @param rotatedFileCount The number of old log files to keep.
+	 * @param flushIntervalMilliseconds The minimum time between the flushes of the mapped view.
+	*/
+	void SetLimits(uint64_t maxFileSize, uint32_t rotatedFileCount, uint32_t flushIntervalMilliseconds);
+
+	void SetPrologueCallback(GetPrologueCallback callback, void* context);
+
+	/**
+	 * @brief Discards the contents of the current file and writes the prologue.
+	*/
+	void Reset();
+
+	void Write(const void* data, size_t size);
+
+	/**
+	 * @brief Flushes the modified pages of the mapped view to disk.
+	*/
+	void Flush();
+
+private:
+
+	bool CreateCurrentFile();
+	void CloseCurrentFile();
+	bool MapView(uint64_t offset);
+	void UnmapView();
+	void RotateFiles();
+	void StartNewFile();
+	void WritePrologue();
+	std::filesystem::path GetRotatedFilePath(uint32_t number) const;
+
+	std::filesystem::path path;
+	wil::unique_hfile file;
+	wil::unique_handle mapping;
+	uint8_t* view;
+	uint64_t viewOffset;
+	uint64_t fileSize;
+	uint64_t prologueSize;
+	uint64_t maxFileSize;
+	uint32_t rotatedFileCount;
+	uint32_t flushIntervalMilliseconds;
+	uint64_t lastFlushTime;
+	bool viewModified;
+	GetPrologueCallback getPrologue;
+	void* getPrologueContext;
+	std::string prologueBuffer;
+};
@@ -0,0 +1,305 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <limits>
+
+// Integer arithmetic that clamps the result to the range of int64_t instead of overflowing.
+namespace SaturatingArithmetic
+{
+	constexpr int64_t Add(int64_t lhs, int64_t rhs)
+	{
+		if (rhs > 0 && lhs > std::numeric_limits<int64_t>::max() - rhs)
+		{
+			return std::numeric_limits<int64_t>::max();
+		}
+		else if (rhs < 0 && lhs < std::numeric_limits<int64_t>::min() - rhs)
+		{
+			return std::numeric_limits<int64_t>::min();
+		}
+
+		return lhs + rhs;
+	}
+
+	constexpr int64_t Multiply(int64_t lhs, int64_t rhs)
+	{
+		if (lhs == 0 || rhs == 0)
+		{
+			return 0;
+		}
+
+		const bool negative = (lhs < 0) != (rhs < 0);
+
+		// The magnitudes are computed as unsigned values, this handles the minimum int64_t value.
+		const uint64_t lhsMagnitude = lhs < 0 ? 0 - static_cast<uint64_t>(lhs) : static_cast<uint64_t>(lhs);
+		const uint64_t rhsMagnitude = rhs < 0 ? 0 - static_cast<uint64_t>(rhs) : static_cast<uint64_t>(rhs);
+
+		const uint64_t limit = negative
+			? static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1
+			: static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+
+		// The product of two 32-bit magnitudes cannot overflow 64 bits, this skips the division
+		// for the common case of a population multiplied by a factor that is less than 1.
+		if (((lhsMagnitude | rhsMagnitude) >> 32) != 0 && lhsMagnitude > limit / rhsMagnitude)
+		{
+			return negative ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+		}
+
+		const uint64_t product = lhsMagnitude * rhsMagnitude;
+
+		if (product > limit)
+		{
+			return negative ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+		}
+
+		return negative ? static_cast<int64_t>(0 - product) : static_cast<int64_t>(product);
+	}
+
+	/**
+	 * @brief Multiplies a quantity by a fixed-point factor with 32 fraction bits.
+	 * The result is truncated toward zero and clamped to the range of int64_t.
+	*/
+	constexpr int64_t MultiplyQ32(int64_t quantity, int64_t factor)
+	{
+		if (quantity == 0 || factor == 0)
+		{
+			return 0;
+		}
+
+		constexpr uint64_t LowMask = 0xFFFFFFFF;
+
+		const bool negative = (quantity < 0) != (factor < 0);
+
+		const uint64_t quantityMagnitude = quantity < 0 ? 0 - static_cast<uint64_t>(quantity) : static_cast<uint64_t>(quantity);
+		const uint64_t factorMagnitude = factor < 0 ? 0 - static_cast<uint64_t>(factor) : static_cast<uint64_t>(factor);
+
+		const uint64_t limit = negative
+			? static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1
+			: static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+
+		// The magnitudes are split into 32-bit halves, so each partial product fits in 64 bits:
+		// (qh * 2^32 + ql) * (fh * 2^32 + fl) / 2^32 = qh * fh * 2^32 + qh * fl + ql * fh + ql * fl / 2^32
+		const uint64_t quantityHigh = quantityMagnitude >> 32;
+		const uint64_t quantityLow = quantityMagnitude & LowMask;
+		const uint64_t factorHigh = factorMagnitude >> 32;
+		const uint64_t factorLow = factorMagnitude & LowMask;
+
+		const uint64_t highProduct = quantityHigh * factorHigh;
+
+		if (highProduct > (limit >> 32))
+		{
+			return negative ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+		}
+
+		// Each term is at most 2^63, so adding one to a sum within the limit cannot wrap.
+		const uint64_t terms[] =
+		{
+			highProduct << 32,
+			quantityHigh * factorLow,
+			quantityLow * factorHigh,
+			(quantityLow * factorLow) >> 32,
+		};
+
+		uint64_t product = 0;
+
+		for (const uint64_t term : terms)
+		{
+			product += term;
+
+			if (product > limit)
+			{
+				return negative ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+			}
+		}
+
+		return negative ? static_cast<int64_t>(0 - product) : static_cast<int64_t>(product);
+	}
+}
+
+// A multiplier for a money amount, e.g. the income per resident.
+// The value is stored as a fixed-point number with 32 fraction bits.
+class MoneyFactor
+{
+public:
+
+	static constexpr int FractionBits = 32;
+
+	constexpr MoneyFactor() : raw(0)
+	{
+	}
+
+	/**
+	 * @brief Converts the factor to fixed-point, rounding to the nearest value.
+	 * A float has 24 significant bits, so the conversion is exact for the factor
+	 * values that are used in the settings file.
+	*/
+	static constexpr MoneyFactor FromFloat(float value)
+	{
+		constexpr double Scale = static_cast<double>(1ULL << FractionBits);
+		constexpr double MaxScaledValue = static_cast<double>(std::numeric_limits<int64_t>::max());
+
+		const double scaled = static_cast<double>(value) * Scale;
+
+		if (!(scaled == scaled))
+		{
+			// NaN.
+			return MoneyFactor(0);
+		}
+		else if (scaled >= MaxScaledValue)
+		{
+			return MoneyFactor(std::numeric_limits<int64_t>::max());
+		}
+		else if (scaled <= -MaxScaledValue)
+		{
+			return MoneyFactor(std::numeric_limits<int64_t>::min());
+		}
+
+		return MoneyFactor(static_cast<int64_t>(scaled >= 0.0 ? scaled + 0.5 : scaled - 0.5));
+	}
+
+	constexpr int64_t Raw() const
+	{
+		return raw;
+	}
+
+private:
+
+	explicit constexpr MoneyFactor(int64_t raw) : raw(raw)
+	{
+	}
+
+	int64_t raw;
+};
+
+// A money amount that is stored as a fixed-point number with 32 fraction bits.
+//
+// All of the operations saturate instead of overflowing, and the results only depend
+// on integer arithmetic, so they are the same for every compiler and floating point mode.
+// The whole part of the amount has a range of [-2^31, 2^31), which is about $2.1 billion.
+// The income settings are limited so that the built-in income calculation cannot leave
+// that range, see GamblingIncomeModel::MaxBaseMonthlyIncome and GamblingIncomeModel::MaxIncomeFactor.
+// Other amounts saturate at the limits of the range. The income of the game's built-in ordinances
+// is not limited to that range, it uses SaturatingArithmetic::MultiplyQ32 instead.
+class Money
+{
+public:
+
+	static constexpr int FractionBits = MoneyFactor::FractionBits;
+	static constexpr int64_t MaxWholeValue = std::numeric_limits<int64_t>::max() >> FractionBits;
+	static constexpr int64_t MinWholeValue = std::numeric_limits<int64_t>::min() >> FractionBits;
+
+	constexpr Money() : raw(0)
+	{
+	}
+
+	static constexpr Money FromWhole(int64_t value)
+	{
+		if (value > MaxWholeValue)
+		{
+			return Money(std::numeric_limits<int64_t>::max());
+		}
+		else if (value < MinWholeValue)
+		{
+			return Money(std::numeric_limits<int64_t>::min());
+		}
+
+		return Money(static_cast<int64_t>(static_cast<uint64_t>(value) << FractionBits));
+	}
+
+	/**
+	 * @brief Converts a floating point amount, e.g. the result of an income formula.
+	 * Values that are out of range are clamped, and NaN is converted to zero.
+	*/
+	static constexpr Money FromDouble(double value)
+	{
+		constexpr double Scale = static_cast<double>(1ULL << FractionBits);
+		constexpr double MaxScaledValue = static_cast<double>(std::numeric_limits<int64_t>::max());
+
+		const double scaled = value * Scale;
+
+		if (!(scaled == scaled))
+		{
+			return Money();
+		}
+		else if (scaled >= MaxScaledValue)
+		{
+			return Money(std::numeric_limits<int64_t>::max());
+		}
+		else if (scaled <= -MaxScaledValue)
+		{
+			return Money(std::numeric_limits<int64_t>::min());
+		}
+
+		return Money(static_cast<int64_t>(scaled));
+	}
+
+	/**
+	 * @brief Returns accumulator + (quantity * factor).
+	*/
+	static constexpr Money MultiplyAdd(Money accumulator, int64_t quantity, MoneyFactor factor)
+	{
+		return Money(SaturatingArithmetic::Add(accumulator.raw, SaturatingArithmetic::Multiply(quantity, factor.Raw())));
+	}
+
+	/**
+	 * @brief Gets the whole part of the amount, the fraction is truncated toward zero.
+	*/
+	constexpr int64_t ToWhole() const
+	{
+		constexpr int64_t FractionMask = (int64_t(1) << FractionBits) - 1;
+
+		if (raw < 0)
+		{
+			// An arithmetic shift rounds toward negative infinity, the result is adjusted
+			// when the amount has a fraction.
+			return (raw >> FractionBits) + ((raw & FractionMask) != 0 ? 1 : 0);
+		}
+
+		return raw >> FractionBits;
+	}
+
+	constexpr int64_t Raw() const
+	{
+		return raw;
+	}
+
+	friend constexpr Money operator+(Money lhs, Money rhs)
+	{
+		return Money(SaturatingArithmetic::Add(lhs.raw, rhs.raw));
+	}
+
+	friend constexpr bool operator==(Money lhs, Money rhs)
+	{
+		return lhs.raw == rhs.raw;
+	}
+
+private:
+
+	explicit constexpr Money(int64_t raw) : raw(raw)
+	{
+	}
+
+	int64_t raw;
+};
+
+static_assert(SaturatingArithmetic::MultiplyQ32(1000, MoneyFactor::FromFloat(0.05f).Raw()) == 50);
+static_assert(SaturatingArithmetic::MultiplyQ32(-3, MoneyFactor::FromFloat(0.5f).Raw()) == -1);
+static_assert(SaturatingArithmetic::MultiplyQ32(int64_t(1) << 40, MoneyFactor::FromFloat(4.0f).Raw()) == int64_t(1) << 42);
+static_assert(SaturatingArithmetic::MultiplyQ32(std::numeric_limits<int64_t>::max(), MoneyFactor::FromFloat(2.0f).Raw()) == std::numeric_limits<int64_t>::max());
+static_assert(SaturatingArithmetic::MultiplyQ32(std::numeric_limits<int64_t>::min(), MoneyFactor::FromFloat(1.0f).Raw()) == std::numeric_limits<int64_t>::min());
+static_assert(Money::FromWhole(250).ToWhole() == 250);
+static_assert(Money::FromWhole(-250).ToWhole() == -250);
+static_assert(Money::MultiplyAdd(Money::FromWhole(250), 1000, MoneyFactor::FromFloat(0.05f)).ToWhole() == 300);
+static_assert(Money::MultiplyAdd(Money(), -3, MoneyFactor::FromFloat(0.5f)).ToWhole() == -1);
+static_assert(Money::MultiplyAdd(Money(), std::numeric_limits<int64_t>::max(), MoneyFactor::FromFloat(2.0f)).Raw() == std::numeric_limits<int64_t>::max());
@@ -0,0 +1,127 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "OrdinanceMethodStatistics.h"
+#include "Logger.h"
+
+namespace
+{
+	constexpr std::array<const char*, static_cast<size_t>(OrdinanceMethod::Count)> MethodNames =
+	{
+		"Init",
+		"GetCurrentMonthlyIncome",
+		"GetID",
+		"GetName",
+		"GetDescription",
+		"GetYearFirstAvailable",
+		"GetChanceAvailability",
+		"GetEnactmentIncome",
+		"GetRetracmentIncome",
+		"GetMonthlyConstantIncome",
+		"GetMonthlyIncomeFactor",
+		"GetAdvisorID",
+		"GetMiscProperties",
+		"IsAvailable",
+		"IsOn",
+		"IsEnabled",
+		"GetMonthlyAdjustedIncome",
+		"CheckConditions",
+		"IsIncomeOrdinance",
+		"Simulate",
+		"SetAvailable",
+		"SetOn",
+		"SetEnabled",
+		"ForceAvailable",
+		"ForceOn",
+		"ForceEnabled",
+		"ForceMonthlyAdjustedIncome",
+	};
+}
+
+OrdinanceMethodStatistics::ScopedTimer::ScopedTimer(OrdinanceMethodStatistics& statistics, OrdinanceMethod method)
+	: statistics(statistics),
+	  method(method),
+	  recording(Logger::GetInstance().IsEnabled<LogOptions::OrdinanceStatistics>()
+		  && !statistics.methods[static_cast<size_t>(method)].active),
+	  startTicks(recording ? PerformanceCounter::GetTicks() : 0)
+{
+	if (recording)
+	{
+		statistics.methods[static_cast<size_t>(method)].active = true;
+	}
+}
+
+OrdinanceMethodStatistics::ScopedTimer::~ScopedTimer()
+{
+	if (recording)
+	{
+		MethodEntry& entry = statistics.methods[static_cast<size_t>(method)];
+
+		entry.histogram.Record(static_cast<uint64_t>(PerformanceCounter::GetTicks() - startTicks));
+		entry.active = false;
+	}
+}
+
+OrdinanceMethodStatistics::OrdinanceMethodStatistics()
+	: methods()
+{
+}
+
+void OrdinanceMethodStatistics::WriteToLog(const char* const ordinanceName) const
+{
+	Logger& logger = Logger::GetInstance();
+
+	if (!logger.IsEnabled<LogOptions::OrdinanceStatistics>())
+	{
+		return;
+	}
+
+	bool headerWritten = false;
+
+	for (size_t i = 0; i < methods.size(); i++)
+	{
+		const LatencyHistogram& histogram = methods[i].histogram;
+		const uint64_t count = histogram.GetCount();
+
+		if (count == 0)
+		{
+			continue;
+		}
+
+		if (!headerWritten)
+		{
+			logger.WriteLineFormatted(
+				LogOptions::OrdinanceStatistics,
+				"%s method statistics (latency in microseconds):",
+				ordinanceName);
+			headerWritten = true;
+		}
+
+		logger.WriteLineFormatted(
+			LogOptions::OrdinanceStatistics,
+			"%s: calls=%llu, p50=%.3f, p99=%.3f, max=%.3f",
+			MethodNames[i],
+			count,
+			PerformanceCounter::TicksToMicroseconds(static_cast<int64_t>(histogram.GetValueAtPercentile(50.0))),
+			PerformanceCounter::TicksToMicroseconds(static_cast<int64_t>(histogram.GetValueAtPercentile(99.0))),
+			PerformanceCounter::TicksToMicroseconds(static_cast<int64_t>(histogram.GetMax())));
+	}
+}
+
+void OrdinanceMethodStatistics::Reset()
+{
+	for (MethodEntry& entry : methods)
+	{
+		entry.histogram.Reset();
+	}
+}
@@ -0,0 +1,101 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "LatencyHistogram.h"
+#include "PerformanceCounter.h"
+#include <array>
+
+// The cISC4Ordinance methods that are measured by OrdinanceMethodStatistics.
+enum class OrdinanceMethod : uint32_t
+{
+	Init = 0,
+	GetCurrentMonthlyIncome,
+	GetID,
+	GetName,
+	GetDescription,
+	GetYearFirstAvailable,
+	GetChanceAvailability,
+	GetEnactmentIncome,
+	GetRetracmentIncome,
+	GetMonthlyConstantIncome,
+	GetMonthlyIncomeFactor,
+	GetAdvisorID,
+	GetMiscProperties,
+	IsAvailable,
+	IsOn,
+	IsEnabled,
+	GetMonthlyAdjustedIncome,
+	CheckConditions,
+	IsIncomeOrdinance,
+	Simulate,
+	SetAvailable,
+	SetOn,
+	SetEnabled,
+	ForceAvailable,
+	ForceOn,
+	ForceEnabled,
+	ForceMonthlyAdjustedIncome,
+	Count
+};
+
+// Records the call count and latency histogram of each cISC4Ordinance method.
+//
+// The statistics are only updated by the game thread, so no locking is required.
+class OrdinanceMethodStatistics
+{
+public:
+
+	// Measures the time from its construction to its destruction.
+	// The timer does nothing when the OrdinanceStatistics log option is disabled.
+	// A nested timer for a method that is already being measured does nothing,
+	// this prevents a derived class override that calls the base class method
+	// from being counted twice.
+	class ScopedTimer
+	{
+	public:
+
+		ScopedTimer(OrdinanceMethodStatistics& statistics, OrdinanceMethod method);
+		~ScopedTimer();
+
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+	private:
+
+		OrdinanceMethodStatistics& statistics;
+		const OrdinanceMethod method;
+		const bool recording;
+		const int64_t startTicks;
+	};
+
+	OrdinanceMethodStatistics();
+
+	/**
+	 * @brief Writes the p50, p99 and max latency of each method that was called to the log.
+	 * @param ordinanceName The name of the ordinance.
+	*/
+	void WriteToLog(const char* const ordinanceName) const;
+
+	void Reset();
+
+private:
+
+	struct MethodEntry
+	{
+		LatencyHistogram histogram;
+		bool active;
+	};
+
+	std::array<MethodEntry, static_cast<size_t>(OrdinanceMethod::Count)> methods;
+};
@@ -14,156 +14,96 @@
 #include "OrdinancePropertyHolder.h"
 #include "cIGZIStream.h"
 #include "cIGZOStream.h"
+#include "cISC4DBSegmentIStream.h"
+#include "cISC4DBSegmentOStream.h"
 #include "Logger.h"
+#include "OrdinancePropertySchema.h"
+#include <algorithm>
 
 static constexpr uint32_t GZCLSID_OrdinancePropertyHolder = 0xd0f95c79;
 static constexpr uint32_t GZIID_OrdinancePropertyHolder = 0x84672560;
 
+// The most properties that Read accepts, the game only defines a few dozen ordinance effects.
+static constexpr uint32_t MaxSerializedPropertyCount = 4096;
+
 namespace
 {
-	const char* GetPropertyDescription(uint32_t propertyID)
+	void WritePropertyIdLogEntry(const char* methodName, uint32_t propertyId)
 	{
-		const char* value = nullptr;
+		Logger& logger = Logger::GetInstance();
+
+		const OrdinancePropertyDescriptor* descriptor = OrdinancePropertySchema::Find(propertyId);
 
-		switch (propertyID)
+		if (!descriptor)
 		{
-		case 0x28ed0380:
-			value = "Crime Effect (float32[1])";
-			break;
-		case 0xaa5b8407:
-			value = "Mayor Rating (int32[1])";
-			break;
-		case 0x08f79b8e:
-			value = "Air Effect (float32[1])";
-			break;
-		case 0x28f42aa0:
-			value = "Flammability Effect (float32[1])";
-			break;
-		case 0xe8f79c8b:
-			value = "Water Effect (float32[1])";
-			break;
-		case 0xe8f79c90:
-			value = "Garbage Effect (float32[1])";
-			break;
-		case 0xa8f4eb0c:
-			value = "Water Use Reduction (float32[1])";
-			break;
-		case 0x0911e117:
-			value = "Power Reduction Effect (float32[1])";
-			break;
-		case 0x2a633000:
-			value = "Commercial Demand Effect (float32[1])";
-			break;
-		case 0x2a653110:
-			value = "Demand Effect:Cs$ (float32[1])";
-			break;
-		case 0x2a653120:
-			value = "Demand Effect:Cs$$ (float32[1])";
-			break;
-		case 0x2a653130:
-			value = "Demand Effect:Cs$$$ (float32[1])";
-			break;
-		case 0x2a653320:
-			value = "Demand Effect:Co$$ (float32[1])";
-			break;
-		case 0x2a653330:
-			value = "Demand Effect:Co$$$ (float32[1])";
-			break;
-		case 0x2a634000:
-			value = "Industrial Demand Effect (float32[1])";
-			break;
-		case 0x2a654100:
-			value = "Demand Effect:IR (float32[1])";
-			break;
-		case 0x2a654200:
-			value = "Demand Effect:ID (float32[1])";
-			break;
-		case 0x2a654300:
-			value = "Demand Effect:IM (float32[1])";
-			break;
-		case 0x2a654400:
-			value = "Demand Effect:IHT (float32[1])";
-			break;
-		case 0x491b3ad5:
-			value = "Health Coverage Radius % Effect (float32[1])";
-			break;
-		case 0x891b3ae6:
-			value = "Health Effectiveness vs. Distance Effect (float32, general response curve)";
-			break;
-		case 0xe91b3aee:
-			value = "Health Quotient Boost Effect (float32[1])";
-			break;
-		case 0xc92d9c7a:
-			value = "Health Quotient Decay Effect (float32[1])";
-			break;
-		case 0x092d909b:
-			value = "Health Capacity Effect (float32[1])";
-			break;
-		case 0xe92d9db4:
-			value = "Health Effectiveness vs. Average Age Effect (float32, general response curve)";
-			break;
-		case 0xa91b3af4:
-			value = "School Coverage Radius % Effect (float32[1])";
-			break;
-		case 0xa91b3afa:
-			value = "School Effectiveness vs. Distance Effect (float32, general response curve)";
-			break;
-		case 0xa92d9d7a:
-			value = "School EQ Boost Effect (float32[1])";
-			break;
-		case 0x692ef65a:
-			value = "School EQ Decay Effect (float32[1])";
-			break;
-		case 0x892d9d02:
-			value = "School Capacity Effect (float32[1])";
-			break;
-		case 0xc91b3b02:
-			value = "School Effectiveness vs. Average Age Effect (float32, general response curve)";
-			break;
-		case 0x8a612fee:
-			value = "Travel Strategy Modifier (int32[9])";
-			break;
-		case 0x8a67e373:
-			value = "Air Effect by zone type (float32[16])";
-			break;
-		case 0x8a67e374:
-			value = "Water Effect by zone type (float32[16])";
-			break;
-		case 0x8a67e376:
-			value = "Garbage Effect by zone type (float32[16])";
-			break;
-		case 0x8a67e378:
-			value = "Traffic Air Pollution Effect (float32[1])";
-			break;
+			logger.WriteLineFormatted<LogOptions::OrdinancePropertyAPI>(
+				"%s: propertyId=0x%08x",
+				methodName,
+				propertyId);
+		}
+		else if (descriptor->count == OrdinancePropertySchema::ResponseCurve)
+		{
+			logger.WriteLineFormatted<LogOptions::OrdinancePropertyAPI>(
+				"%s: propertyId=0x%08x (%s (%s, general response curve))",
+				methodName,
+				propertyId,
+				descriptor->name,
+				OrdinancePropertySchema::GetElementTypeName(descriptor->elementType));
+		}
+		else
+		{
+			logger.WriteLineFormatted<LogOptions::OrdinancePropertyAPI>(
+				"%s: propertyId=0x%08x (%s (%s[%u]))",
+				methodName,
+				propertyId,
+				descriptor->name,
+				OrdinancePropertySchema::GetElementTypeName(descriptor->elementType),
+				descriptor->count);
 		}
-
-		return value;
 	}
 
-	void LogPropertyId(const char* methodName, uint32_t propertyId)
+	bool IsValidPropertyValue(const cSCBaseProperty& property)
 	{
-		Logger& logger = Logger::GetInstance();
+		const OrdinancePropertyDescriptor* descriptor = OrdinancePropertySchema::Find(property.GetPropertyID());
+
+		if (!descriptor)
+		{
+			// The properties that are not in the schema are stored as-is.
+			return true;
+		}
 
-		const char* propertyDescription = GetPropertyDescription(propertyId);
+		const cIGZVariant* value = property.GetPropertyValue();
 
-		if (propertyDescription)
+		if (value && OrdinancePropertySchema::IsValidValue(*descriptor, value->GetType(), value->GetCount()))
 		{
-			logger.WriteLineFormatted(
-				LogOptions::OrdinancePropertyAPI,
-				"%s: propertyId=0x%08x (%s)",
-				methodName,
-				propertyId,
-				propertyDescription);
+			return true;
 		}
-		else
+
+		Logger::GetInstance().WriteLineFormatted(
+			LogOptions::Errors,
+			"Rejected the %s property (0x%08x), its value type is 0x%04x with %u values.",
+			descriptor->name,
+			descriptor->id,
+			value ? value->GetType() : 0,
+			value ? value->GetCount() : 0);
+
+		return false;
+	}
+
+	inline void LogPropertyId(const char* methodName, uint32_t propertyId)
+	{
+		// The property lookups are called for every ordinance when the game recalculates
+		// the ordinance effects, the description is only looked up when the log entry is written.
+		if (Logger::GetInstance().IsEnabled<LogOptions::OrdinancePropertyAPI>())
 		{
-			logger.WriteLineFormatted(
-				LogOptions::OrdinancePropertyAPI,
-				"%s: propertyId=0x%08x",
-				methodName,
-				propertyId);
+			WritePropertyIdLogEntry(methodName, propertyId);
 		}
 	}
+
+	bool PropertyIdLess(const cSCBaseProperty& lhs, const cSCBaseProperty& rhs)
+	{
+		return lhs.GetPropertyID() < rhs.GetPropertyID();
+	}
 }
 
 OrdinancePropertyHolder::OrdinancePropertyHolder()
@@ -172,14 +112,17 @@ OrdinancePropertyHolder::OrdinancePropertyHolder()
 }
 
 OrdinancePropertyHolder::OrdinancePropertyHolder(const std::vector<cSCBaseProperty>& properties)
-	: refCount(0), properties(properties)
+	: refCount(0), properties(properties.empty() ? nullptr : std::make_shared<PropertyList>(properties))
 {
+	if (this->properties)
+	{
+		CompactList(*this->properties);
+	}
 }
 
 OrdinancePropertyHolder::OrdinancePropertyHolder(const OrdinancePropertyHolder& other)
 	: refCount(0), properties(other.properties)
 {
-
 }
 
 OrdinancePropertyHolder::OrdinancePropertyHolder(OrdinancePropertyHolder&& other) noexcept
@@ -268,15 +211,7 @@ bool OrdinancePropertyHolder::HasProperty(uint32_t dwProperty)
 {
 	LogPropertyId(__FUNCTION__, dwProperty);
 
-	for (const auto& property : properties)
-	{
-		if (property.GetPropertyID() == dwProperty)
-		{
-			return true;
-		}
-	}
-
-	return false;
+	return FindProperty(dwProperty) != nullptr;
 }
 
 bool OrdinancePropertyHolder::GetPropertyList(cIGZUnknownList** ppList)
@@ -288,38 +223,31 @@ cISCProperty* OrdinancePropertyHolder::GetProperty(uint32_t dwProperty)
 {
 	LogPropertyId(__FUNCSIG__, dwProperty);
 
-	for (auto& property : properties)
-	{
-		if (property.GetPropertyID() == dwProperty)
-		{
-			cISCProperty* pProperty = static_cast<cISCProperty*>(&property);
-			pProperty->AddRef();
+	// The property is not copied, it is shared with the other holders that use the same list.
+	cISCProperty* pProperty = FindProperty(dwProperty);
 
-			return pProperty;
-		}
+	if (pProperty)
+	{
+		pProperty->AddRef();
 	}
 
-	return nullptr;
+	return pProperty;
 }
 
 bool OrdinancePropertyHolder::GetProperty(uint32_t dwProperty, uint32_t& dwValueOut)
 {
 	LogPropertyId(__FUNCSIG__, dwProperty);
 
-	bool result = false;
+	const cSCBaseProperty* pProperty = FindProperty(dwProperty);
 
-	for (const auto& property : properties)
+	if (pProperty)
 	{
-		if (property.GetPropertyID() == dwProperty)
-		{
-			const auto variant = property.GetPropertyValue();
+		const auto variant = pProperty->GetPropertyValue();
 
-			result = variant && variant->GetValUint32(dwValueOut);
-			break;
-		}
+		return variant && variant->GetValUint32(dwValueOut);
 	}
 
-	return result;
+	return false;
 }
 
 bool OrdinancePropertyHolder::GetProperty(uint32_t dwProperty, cIGZString& szValueOut)
@@ -347,8 +275,7 @@ bool OrdinancePropertyHolder::AddProperty(cISCProperty* pProperty, bool bUnknown
 {
 	if (pProperty)
 	{
-		properties.push_back(cSCBaseProperty(*pProperty));
-		return true;
+		return InsertProperty(cSCBaseProperty(*pProperty));
 	}
 
 	return false;
@@ -356,14 +283,12 @@ bool OrdinancePropertyHolder::AddProperty(cISCProperty* pProperty, bool bUnknown
 
 bool OrdinancePropertyHolder::AddProperty(uint32_t dwProperty, cIGZVariant const* pVariant, bool bUnknown)
 {
-	properties.push_back(cSCBaseProperty(dwProperty, pVariant));
-	return true;
+	return InsertProperty(cSCBaseProperty(dwProperty, pVariant));
 }
 
 bool OrdinancePropertyHolder::AddProperty(uint32_t dwProperty, uint32_t dwValue, bool bUnknown)
 {
-	properties.push_back(cSCBaseProperty(dwProperty, dwValue));
-	return true;
+	return InsertProperty(cSCBaseProperty(dwProperty, dwValue));
 }
 
 bool OrdinancePropertyHolder::AddProperty(uint32_t dwProperty, cIGZString const& szValue)
@@ -373,8 +298,7 @@ bool OrdinancePropertyHolder::AddProperty(uint32_t dwProperty, cIGZString const&
 
 bool OrdinancePropertyHolder::AddProperty(uint32_t dwProperty, int32_t lValue, bool bUnknown)
 {
-	properties.push_back(cSCBaseProperty(dwProperty, lValue));
-	return true;
+	return InsertProperty(cSCBaseProperty(dwProperty, lValue));
 }
 
 bool OrdinancePropertyHolder::AddProperty(uint32_t dwProperty, void* pUnknown, uint32_t dwUnknown, bool bUnknown)
@@ -384,8 +308,7 @@ bool OrdinancePropertyHolder::AddProperty(uint32_t dwProperty, void* pUnknown, u
 
 bool OrdinancePropertyHolder::AddProperty(uint32_t dwProperty, float value)
 {
-	properties.push_back(cSCBaseProperty(dwProperty, value));
-	return true;
+	return InsertProperty(cSCBaseProperty(dwProperty, value));
 }
 
 bool OrdinancePropertyHolder::CopyAddProperty(cISCProperty* pProperty, bool bUnknown)
@@ -395,31 +318,42 @@ bool OrdinancePropertyHolder::CopyAddProperty(cISCProperty* pProperty, bool bUnk
 
 bool OrdinancePropertyHolder::RemoveProperty(uint32_t dwProperty)
 {
-	for (std::vector<cSCBaseProperty>::iterator it = properties.begin(); it != properties.end();)
+	const cSCBaseProperty* pProperty = FindProperty(dwProperty);
+
+	if (!pProperty)
 	{
-		if (it->GetPropertyID() == dwProperty)
-		{
-			properties.erase(it);
-			return true;
-		}
+		return false;
 	}
 
-	return false;
+	// The index is used because MutableProperties may copy the list.
+	const size_t index = static_cast<size_t>(pProperty - properties->data());
+
+	PropertyList& propertyList = MutableProperties();
+	propertyList.erase(propertyList.begin() + index);
+
+	return true;
 }
 
 bool OrdinancePropertyHolder::RemoveAllProperties(void)
 {
-	properties.clear();
+	// The list is released instead of cleared, the other holders that share it are not modified.
+	properties.reset();
 	return true;
 }
 
 bool OrdinancePropertyHolder::EnumProperties(FunctionPtr1 pFunction1, void* pData)
 {
-	size_t propertyCount = properties.size();
+	if (!properties)
+	{
+		return true;
+	}
+
+	PropertyList& propertyList = *properties;
+	size_t propertyCount = propertyList.size();
 
 	for (size_t i = 0; i < propertyCount; i++)
 	{
-		cISCProperty* property = &properties[i];
+		cISCProperty* property = &propertyList[i];
 
 		pFunction1(property, pData);
 	}
@@ -429,12 +363,55 @@ bool OrdinancePropertyHolder::EnumProperties(FunctionPtr1 pFunction1, void* pDat
 
 bool OrdinancePropertyHolder::EnumProperties(FunctionPtr2 pFunction2, FunctionPtr1 pFunctionPipe)
 {
-	return false;
+	// The interface does not provide a context value for the callbacks.
+	return EnumProperties(pFunction2, nullptr, pFunctionPipe, nullptr);
+}
+
+bool OrdinancePropertyHolder::EnumProperties(FunctionPtr2 pFilter, void* pFilterData, FunctionPtr1 pFunction, void* pData)
+{
+	if (!pFilter || !pFunction)
+	{
+		return false;
+	}
+
+	if (!properties)
+	{
+		return true;
+	}
+
+	// The matching properties are passed to the function as they are found, they are not collected first.
+	for (cSCBaseProperty& property : *properties)
+	{
+		cISCProperty* pProperty = &property;
+
+		if (pFilter(pProperty, pFilterData))
+		{
+			pFunction(pProperty, pData);
+		}
+	}
+
+	return true;
 }
 
 bool OrdinancePropertyHolder::CompactProperties(void)
 {
-	return false;
+	if (properties)
+	{
+		PropertyList& propertyList = MutableProperties();
+
+		CompactList(propertyList);
+
+		if (propertyList.empty())
+		{
+			properties.reset();
+		}
+		else
+		{
+			propertyList.shrink_to_fit();
+		}
+	}
+
+	return true;
 }
 
 bool OrdinancePropertyHolder::Write(cIGZOStream& stream)
@@ -444,23 +421,43 @@ bool OrdinancePropertyHolder::Write(cIGZOStream& stream)
 		return false;
 	}
 
+	const PropertyList& propertyList = Properties();
+
 	const uint32_t version = 1;
-	const uint32_t propertyCount = static_cast<uint32_t>(properties.size());
+	const uint32_t propertyCount = static_cast<uint32_t>(propertyList.size());
 
 	if (!stream.SetUint32(version) || !stream.SetUint32(propertyCount))
 	{
 		return false;
 	}
 
-	for (uint32_t i = 0; i < propertyCount; i++)
+	if (propertyCount == 0)
 	{
-		if (!properties[i].Write(stream))
+		return true;
+	}
+
+	// The properties are written through the DB segment stream, it is resolved once for the whole list.
+	cISC4DBSegmentOStream* pDBSegment = nullptr;
+
+	if (!stream.QueryInterface(GZIID_cISC4DBSegmentOStream, reinterpret_cast<void**>(&pDBSegment)))
+	{
+		return false;
+	}
+
+	bool result = true;
+
+	for (const cSCBaseProperty& property : propertyList)
+	{
+		if (!property.WriteToSegment(*pDBSegment))
 		{
-			return false;
+			result = false;
+			break;
 		}
 	}
 
-	return true;
+	pDBSegment->Release();
+
+	return result;
 }
 
 bool OrdinancePropertyHolder::Read(cIGZIStream& stream)
@@ -477,29 +474,217 @@ bool OrdinancePropertyHolder::Read(cIGZIStream& stream)
 	}
 
 	uint32_t propertyCount = 0;
-	if (!stream.GetUint32(propertyCount))
+	if (!stream.GetUint32(propertyCount) || propertyCount > MaxSerializedPropertyCount)
+	{
+		// A larger count can only come from a damaged save, it is rejected before the list is allocated.
+		return false;
+	}
+
+	if (propertyCount == 0)
+	{
+		properties.reset();
+		return true;
+	}
+
+	cISC4DBSegmentIStream* pDBSegment = nullptr;
+
+	if (!stream.QueryInterface(GZIID_cISC4DBSegmentIStream, reinterpret_cast<void**>(&pDBSegment)))
 	{
 		return false;
 	}
 
-	properties.clear();
+	// The properties are read into a new list, the list that was shared with other holders is not modified.
+	std::shared_ptr<PropertyList> propertyList = std::make_shared<PropertyList>();
+	propertyList->reserve(propertyCount);
+
+	bool result = true;
 
 	for (uint32_t i = 0; i < propertyCount; i++)
 	{
-		cSCBaseProperty prop;
+		// The property is read in place, it is not copied into the list.
+		cSCBaseProperty& property = propertyList->emplace_back();
 
-		if (!prop.Read(stream))
+		if (!property.ReadFromSegment(*pDBSegment))
 		{
-			return false;
+			result = false;
+			break;
 		}
 
-		properties.push_back(prop);
+		// A property with an invalid value is skipped, the rest of the list is still loaded.
+		if (!IsValidPropertyValue(property))
+		{
+			propertyList->pop_back();
+		}
 	}
 
+	pDBSegment->Release();
+
+	if (!result)
+	{
+		return false;
+	}
+
+	// The lookups require the list to be sorted by ID, the order in the saved city is not relied on.
+	CompactList(*propertyList);
+
+	properties = !propertyList->empty() ? std::move(propertyList) : nullptr;
+
 	return true;
 }
 
+std::span<const float> OrdinancePropertyHolder::GetFloat32Array(uint32_t dwProperty) const
+{
+	const cSCBaseProperty* pProperty = FindProperty(dwProperty);
+
+	if (pProperty)
+	{
+		const cIGZVariant* value = pProperty->GetPropertyValue();
+
+		if (value && value->GetType() == cIGZVariant::Type::Float32Array && value->RefFloat32())
+		{
+			return std::span<const float>(value->RefFloat32(), value->GetCount());
+		}
+	}
+
+	return std::span<const float>();
+}
+
+std::span<const int32_t> OrdinancePropertyHolder::GetSint32Array(uint32_t dwProperty) const
+{
+	const cSCBaseProperty* pProperty = FindProperty(dwProperty);
+
+	if (pProperty)
+	{
+		const cIGZVariant* value = pProperty->GetPropertyValue();
+
+		if (value && value->GetType() == cIGZVariant::Type::Sint32Array && value->RefSint32())
+		{
+			return std::span<const int32_t>(value->RefSint32(), value->GetCount());
+		}
+	}
+
+	return std::span<const int32_t>();
+}
+
+bool OrdinancePropertyHolder::GetFloat32(uint32_t dwProperty, float& value) const
+{
+	const cSCBaseProperty* pProperty = FindProperty(dwProperty);
+
+	if (pProperty)
+	{
+		const cIGZVariant* variant = pProperty->GetPropertyValue();
+
+		if (variant)
+		{
+			if (variant->GetType() == cIGZVariant::Type::Float32)
+			{
+				return variant->GetValFloat32(value);
+			}
+			else if (variant->GetType() == cIGZVariant::Type::Float32Array && variant->GetCount() == 1 && variant->RefFloat32())
+			{
+				value = variant->RefFloat32()[0];
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
 uint32_t OrdinancePropertyHolder::GetGZCLSID()
 {
 	return GZCLSID_OrdinancePropertyHolder;
 }
+
+cSCBaseProperty* OrdinancePropertyHolder::FindProperty(uint32_t dwProperty) const
+{
+	if (!properties)
+	{
+		return nullptr;
+	}
+
+	PropertyList& propertyList = *properties;
+
+	const auto it = std::lower_bound(
+		propertyList.begin(),
+		propertyList.end(),
+		dwProperty,
+		[](const cSCBaseProperty& property, uint32_t id) { return property.GetPropertyID() < id; });
+
+	return it != propertyList.end() && it->GetPropertyID() == dwProperty ? &*it : nullptr;
+}
+
+bool OrdinancePropertyHolder::InsertProperty(cSCBaseProperty&& property)
+{
+	if (!IsValidPropertyValue(property))
+	{
+		return false;
+	}
+
+	PropertyList& propertyList = MutableProperties();
+
+	const auto it = std::lower_bound(propertyList.begin(), propertyList.end(), property, PropertyIdLess);
+
+	if (it != propertyList.end() && it->GetPropertyID() == property.GetPropertyID())
+	{
+		// The holder has one property per ID, the last value that is added wins.
+		*it = std::move(property);
+	}
+	else
+	{
+		propertyList.insert(it, std::move(property));
+	}
+
+	return true;
+}
+
+void OrdinancePropertyHolder::CompactList(PropertyList& propertyList)
+{
+	if (!std::is_sorted(propertyList.begin(), propertyList.end(), PropertyIdLess))
+	{
+		// A stable sort keeps the duplicate IDs in the order they were added.
+		std::stable_sort(propertyList.begin(), propertyList.end(), PropertyIdLess);
+	}
+
+	// Keep the last property of each run of duplicate IDs.
+	size_t count = 0;
+
+	for (size_t i = 0; i < propertyList.size(); i++)
+	{
+		if (i + 1 < propertyList.size() && propertyList[i + 1].GetPropertyID() == propertyList[i].GetPropertyID())
+		{
+			continue;
+		}
+
+		if (count != i)
+		{
+			propertyList[count] = std::move(propertyList[i]);
+		}
+
+		count++;
+	}
+
+	propertyList.erase(propertyList.begin() + count, propertyList.end());
+}
+
+const OrdinancePropertyHolder::PropertyList& OrdinancePropertyHolder::Properties() const
+{
+	static const PropertyList emptyList;
+
+	return properties ? *properties : emptyList;
+}
+
+OrdinancePropertyHolder::PropertyList& OrdinancePropertyHolder::MutableProperties()
+{
+	if (!properties)
+	{
+		properties = std::make_shared<PropertyList>();
+	}
+	else if (properties.use_count() > 1)
+	{
+		// The list is shared with another holder, it is copied before it is modified.
+		properties = std::make_shared<PropertyList>(*properties);
+	}
+
+	return *properties;
+}
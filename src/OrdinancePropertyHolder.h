@@ -15,8 +15,26 @@
 #include "cISCPropertyHolder.h"
 #include "cIGZSerializable.h"
 #include "cSCBaseProperty.h"
+#include <memory>
+#include <span>
 #include <vector>
 
+// A property holder that shares its property list with the holders it is copied from.
+//
+// Copying a holder only adds a reference to the property list, the list is copied
+// when one of the holders that share it adds or removes a property.
+// The property pointers that are returned by GetProperty and EnumProperties point
+// into the shared list, callers must treat them as read-only.
+// The list stores the properties by value and the short arrays are stored inside the
+// property, so those pointers and the spans that are returned by GetFloat32Array and
+// GetSint32Array are only valid until the holder is next modified. Adding, removing,
+// compacting or reading the properties can move the other properties in the list.
+// The holders that share the list are not affected when one of them is modified.
+//
+// The list is kept sorted by property ID with one property per ID, so the lookups are
+// binary searches and EnumProperties visits the properties in ID order. Adding a property
+// with an existing ID replaces the existing value.
+// The values of the properties in OrdinancePropertySchema are checked when they are added or read.
 class OrdinancePropertyHolder : public cISCPropertyHolder, cIGZSerializable
 {
 public:
@@ -62,15 +80,70 @@ public:
 	virtual bool EnumProperties(FunctionPtr1 pFunction1, void* pData);
 	virtual bool EnumProperties(FunctionPtr2 pFunction2, FunctionPtr1 pFunctionPipe);
 
+	/**
+	 * @brief Calls a function for each property that matches a filter.
+	 * @param pFilter The filter, it returns true for the properties that are passed to the function.
+	 * @param pFilterData The context value that is passed to the filter.
+	 * @param pFunction The function that is called for each matching property.
+	 * @param pData The context value that is passed to the function.
+	*/
+	bool EnumProperties(FunctionPtr2 pFilter, void* pFilterData, FunctionPtr1 pFunction, void* pData);
+
 	virtual bool CompactProperties(void);
 
+	/**
+	 * @brief Gets the values of a float32 array property without copying them.
+	 * @return A span over the property's storage, or an empty span if the holder
+	 * does not have the property or it is not a float32 array.
+	 * The span is invalidated when the holder is modified, the values must be
+	 * looked up again after a property is added or removed.
+	*/
+	std::span<const float> GetFloat32Array(uint32_t dwProperty) const;
+
+	/**
+	 * @brief Gets the values of an int32 array property without copying them.
+	 * @return A span over the property's storage, or an empty span if the holder
+	 * does not have the property or it is not an int32 array.
+	 * The span is invalidated when the holder is modified, the values must be
+	 * looked up again after a property is added or removed.
+	*/
+	std::span<const int32_t> GetSint32Array(uint32_t dwProperty) const;
+
+	/**
+	 * @brief Gets a float32 property that has a single value.
+	 * The value may be stored as a scalar or as a one element array.
+	*/
+	bool GetFloat32(uint32_t dwProperty, float& value) const;
+
 	bool Write(cIGZOStream& stream);
 	bool Read(cIGZIStream& stream);
 	uint32_t GetGZCLSID();
 
 private:
 
+	using PropertyList = std::vector<cSCBaseProperty>;
+
+	/**
+	 * @brief Sorts the list by ID and removes the duplicate IDs, keeping the last one that was added.
+	*/
+	static void CompactList(PropertyList& propertyList);
+
+	/**
+	 * @brief Finds the property with the specified ID.
+	 * @return The property, or nullptr if the holder does not have the property.
+	*/
+	cSCBaseProperty* FindProperty(uint32_t dwProperty) const;
+	/**
+	 * @brief Adds a property after checking its value against the schema.
+	 * @return True if the property was added; otherwise, false.
+	*/
+	bool InsertProperty(cSCBaseProperty&& property);
+
+	const PropertyList& Properties() const;
+	PropertyList& MutableProperties();
+
 	uint32_t refCount;
-	std::vector<cSCBaseProperty> properties;
+	// The property list is null when the holder is empty.
+	std::shared_ptr<PropertyList> properties;
 };
 
@@ -0,0 +1,165 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "cIGZVariant.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// The name, value type and value count of an ordinance effect property.
+struct OrdinancePropertyDescriptor
+{
+	uint32_t id;
+	const char* name;
+	// The element type, without the cIGZVariant::TypeArray flag.
+	uint16_t elementType;
+	// The number of values, or 0 for a response curve that has any number of x/y pairs.
+	uint32_t count;
+};
+
+// The ordinance effect properties that the game reads, sorted by ID.
+namespace OrdinancePropertySchema
+{
+	inline constexpr uint32_t ResponseCurve = 0;
+
+	inline constexpr std::array<OrdinancePropertyDescriptor, 36> Properties =
+	{{
+		{ 0x08f79b8e, "Air Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0x0911e117, "Power Reduction Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0x092d909b, "Health Capacity Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0x28ed0380, "Crime Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0x28f42aa0, "Flammability Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0x2a633000, "Commercial Demand Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0x2a634000, "Industrial Demand Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0x2a653110, "Demand Effect:Cs$", cIGZVariant::Type::Float32, 1 },
+		{ 0x2a653120, "Demand Effect:Cs$$", cIGZVariant::Type::Float32, 1 },
+		{ 0x2a653130, "Demand Effect:Cs$$$", cIGZVariant::Type::Float32, 1 },
+		{ 0x2a653320, "Demand Effect:Co$$", cIGZVariant::Type::Float32, 1 },
+		{ 0x2a653330, "Demand Effect:Co$$$", cIGZVariant::Type::Float32, 1 },
+		{ 0x2a654100, "Demand Effect:IR", cIGZVariant::Type::Float32, 1 },
+		{ 0x2a654200, "Demand Effect:ID", cIGZVariant::Type::Float32, 1 },
+		{ 0x2a654300, "Demand Effect:IM", cIGZVariant::Type::Float32, 1 },
+		{ 0x2a654400, "Demand Effect:IHT", cIGZVariant::Type::Float32, 1 },
+		{ 0x491b3ad5, "Health Coverage Radius % Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0x692ef65a, "School EQ Decay Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0x891b3ae6, "Health Effectiveness vs. Distance Effect", cIGZVariant::Type::Float32, ResponseCurve },
+		{ 0x892d9d02, "School Capacity Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0x8a612fee, "Travel Strategy Modifier", cIGZVariant::Type::Sint32, 9 },
+		{ 0x8a67e373, "Air Effect by zone type", cIGZVariant::Type::Float32, 16 },
+		{ 0x8a67e374, "Water Effect by zone type", cIGZVariant::Type::Float32, 16 },
+		{ 0x8a67e376, "Garbage Effect by zone type", cIGZVariant::Type::Float32, 16 },
+		{ 0x8a67e378, "Traffic Air Pollution Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0xa8f4eb0c, "Water Use Reduction", cIGZVariant::Type::Float32, 1 },
+		{ 0xa91b3af4, "School Coverage Radius % Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0xa91b3afa, "School Effectiveness vs. Distance Effect", cIGZVariant::Type::Float32, ResponseCurve },
+		{ 0xa92d9d7a, "School EQ Boost Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0xaa5b8407, "Mayor Rating", cIGZVariant::Type::Sint32, 1 },
+		{ 0xc91b3b02, "School Effectiveness vs. Average Age Effect", cIGZVariant::Type::Float32, ResponseCurve },
+		{ 0xc92d9c7a, "Health Quotient Decay Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0xe8f79c8b, "Water Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0xe8f79c90, "Garbage Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0xe91b3aee, "Health Quotient Boost Effect", cIGZVariant::Type::Float32, 1 },
+		{ 0xe92d9db4, "Health Effectiveness vs. Average Age Effect", cIGZVariant::Type::Float32, ResponseCurve },
+	}};
+
+	/**
+	 * @brief Gets the descriptor of an ordinance effect property.
+	 * @return The descriptor, or nullptr if the property is not in the schema.
+	*/
+	constexpr const OrdinancePropertyDescriptor* Find(uint32_t id)
+	{
+		size_t first = 0;
+		size_t last = Properties.size();
+
+		while (first < last)
+		{
+			const size_t middle = first + ((last - first) / 2);
+
+			if (Properties[middle].id < id)
+			{
+				first = middle + 1;
+			}
+			else
+			{
+				last = middle;
+			}
+		}
+
+		return first < Properties.size() && Properties[first].id == id ? &Properties[first] : nullptr;
+	}
+
+	/**
+	 * @brief Checks that a variant's type and count match the property descriptor.
+	 * A single value may be stored as either a scalar or a one element array.
+	*/
+	constexpr bool IsValidValue(const OrdinancePropertyDescriptor& descriptor, uint16_t variantType, uint32_t variantCount)
+	{
+		const bool isArray = (variantType & cIGZVariant::TypeArray) != 0;
+		const uint16_t elementType = static_cast<uint16_t>(variantType & ~cIGZVariant::TypeArray);
+
+		if (elementType != descriptor.elementType)
+		{
+			return false;
+		}
+
+		if (!isArray)
+		{
+			return descriptor.count == 1;
+		}
+
+		if (descriptor.count == ResponseCurve)
+		{
+			// A response curve is a list of x/y pairs.
+			return variantCount > 0 && (variantCount % 2) == 0;
+		}
+
+		return variantCount == descriptor.count;
+	}
+
+	constexpr const char* GetElementTypeName(uint16_t elementType)
+	{
+		switch (elementType)
+		{
+		case cIGZVariant::Type::Sint32:
+			return "int32";
+		case cIGZVariant::Type::Float32:
+			return "float32";
+		default:
+			return "unknown";
+		}
+	}
+
+	constexpr bool IsSortedById()
+	{
+		for (size_t i = 1; i < Properties.size(); i++)
+		{
+			if (Properties[i - 1].id >= Properties[i].id)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	static_assert(IsSortedById(), "The schema must be sorted by ID, Find uses a binary search.");
+	// Dereferencing a null descriptor is not a constant expression, the asserts
+	// below fail to compile if one of their IDs is missing from the schema.
+	static_assert(Find(0x28ed0380) == &Properties[3] && Find(0x28ed0380)->count == 1);
+	static_assert(Find(0x12345678) == nullptr);
+	static_assert(IsValidValue(*Find(0x28ed0380), cIGZVariant::Type::Float32, 0));
+	static_assert(IsValidValue(*Find(0x8a67e373), cIGZVariant::Type::Float32Array, 16));
+	static_assert(!IsValidValue(*Find(0x8a67e373), cIGZVariant::Type::Float32Array, 15));
+	static_assert(!IsValidValue(*Find(0x8a612fee), cIGZVariant::Type::Float32Array, 9));
+}
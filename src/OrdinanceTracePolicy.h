@@ -0,0 +1,139 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "Logger.h"
+#include "OrdinanceMethodStatistics.h"
+#include <type_traits>
+
+// The tracing policies control the per-call instrumentation of the cISC4Ordinance methods.
+// A policy combines a statistics policy, which supplies the storage and the scopes that record
+// the method latency statistics, and an API log policy, which supplies the OrdinanceAPI log entries.
+// The two parts are selected separately, so the statistics can be recorded in a build that
+// removes the per-call logging.
+//
+// The statistics policy has two scopes. MethodScope is used by the methods that do some work,
+// e.g. CheckConditions, Simulate and GetMonthlyAdjustedIncome. GetterScope is used by the getters
+// that only return a field, e.g. GetEnactmentIncome and IsIncomeOrdinance, timing those would
+// cost more than the method itself.
+
+// A scope that does not record anything.
+class NullOrdinanceMethodScope
+{
+public:
+
+	template <typename Statistics> NullOrdinanceMethodScope(Statistics&, OrdinanceMethod)
+	{
+	}
+};
+
+// Does not record the method statistics.
+struct NullOrdinanceStatisticsPolicy
+{
+	// Takes the place of OrdinanceMethodStatistics, the ordinance does not store any histograms.
+	class Statistics
+	{
+	public:
+
+		void WriteToLog(const char* const) const
+		{
+		}
+
+		void Reset()
+		{
+		}
+	};
+
+	using MethodScope = NullOrdinanceMethodScope;
+	using GetterScope = NullOrdinanceMethodScope;
+};
+
+// Records the call count and latency of the methods that use MethodScope, the getters
+// are reduced to a field load. The recording is enabled at run time by the
+// OrdinanceStatistics log option.
+struct InstrumentedOrdinanceStatisticsPolicy
+{
+	using Statistics = OrdinanceMethodStatistics;
+	using MethodScope = OrdinanceMethodStatistics::ScopedTimer;
+	using GetterScope = NullOrdinanceMethodScope;
+};
+
+// Records the call count and latency of every method, including the getters.
+struct RecordingOrdinanceStatisticsPolicy
+{
+	using Statistics = OrdinanceMethodStatistics;
+	using MethodScope = OrdinanceMethodStatistics::ScopedTimer;
+	using GetterScope = OrdinanceMethodStatistics::ScopedTimer;
+};
+
+// Removes the OrdinanceAPI log entries.
+struct NullOrdinanceApiLogPolicy
+{
+	static void WriteLine(Logger&, const char* const)
+	{
+	}
+
+	template <typename... Args> static void WriteLineFormatted(Logger&, const char* const, Args...)
+	{
+	}
+};
+
+// Writes the OrdinanceAPI log entries.
+struct LoggingOrdinanceApiLogPolicy
+{
+	static void WriteLine(Logger& logger, const char* const message)
+	{
+		logger.WriteLine<LogOptions::OrdinanceAPI>(message);
+	}
+
+	template <typename... Args> static void WriteLineFormatted(Logger& logger, const char* const format, Args... args)
+	{
+		logger.WriteLineFormatted<LogOptions::OrdinanceAPI>(format, args...);
+	}
+};
+
+template <typename StatisticsPolicy, typename ApiLogPolicy>
+struct OrdinanceTracePolicy : StatisticsPolicy, ApiLogPolicy
+{
+};
+
+// Removes all of the instrumentation, the methods only contain their own code.
+using NullOrdinanceTracePolicy = OrdinanceTracePolicy<NullOrdinanceStatisticsPolicy, NullOrdinanceApiLogPolicy>;
+
+// Records the statistics of the methods that do some work, the getters only contain their own code.
+using InstrumentedOrdinanceTracePolicy = OrdinanceTracePolicy<InstrumentedOrdinanceStatisticsPolicy, NullOrdinanceApiLogPolicy>;
+
+// Records the method statistics and writes the OrdinanceAPI log entries.
+using LoggingOrdinanceTracePolicy = OrdinanceTracePolicy<RecordingOrdinanceStatisticsPolicy, LoggingOrdinanceApiLogPolicy>;
+
+// Each part is compiled when its log category is in CompiledLogOptions. The getters are only
+// timed in the diagnostic builds that also compile the OrdinanceAPI logging. The release builds
+// compile OrdinanceStatistics without OrdinanceAPI, so they use InstrumentedOrdinanceTracePolicy.
+using DefaultOrdinanceTracePolicy = OrdinanceTracePolicy<
+	std::conditional_t<
+		LogOptionsPolicy<LogOptions::OrdinanceStatistics>::IsCompiled,
+		std::conditional_t<
+			LogOptionsPolicy<LogOptions::OrdinanceAPI>::IsCompiled,
+			RecordingOrdinanceStatisticsPolicy,
+			InstrumentedOrdinanceStatisticsPolicy>,
+		NullOrdinanceStatisticsPolicy>,
+	std::conditional_t<
+		LogOptionsPolicy<LogOptions::OrdinanceAPI>::IsCompiled,
+		LoggingOrdinanceApiLogPolicy,
+		NullOrdinanceApiLogPolicy>>;
+
+static_assert(
+	LogOptionsPolicy<LogOptions::OrdinanceAPI>::IsCompiled
+	|| (std::is_same_v<DefaultOrdinanceTracePolicy::GetterScope, NullOrdinanceMethodScope>
+		&& std::is_base_of_v<NullOrdinanceApiLogPolicy, DefaultOrdinanceTracePolicy>),
+	"A build without the OrdinanceAPI category must reduce the ordinance getters to a field load.");
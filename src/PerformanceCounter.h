@@ -0,0 +1,47 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <Windows.h>
+
+// Helper functions for the high resolution performance counter.
+namespace PerformanceCounter
+{
+	inline int64_t GetTicks()
+	{
+		LARGE_INTEGER value{};
+		QueryPerformanceCounter(&value);
+
+		return value.QuadPart;
+	}
+
+	inline int64_t GetFrequency()
+	{
+		// The frequency is fixed at system boot, so it only needs to be queried once.
+		static const int64_t frequency = []()
+		{
+			LARGE_INTEGER value{};
+			QueryPerformanceFrequency(&value);
+
+			return value.QuadPart;
+		}();
+
+		return frequency;
+	}
+
+	inline double TicksToMicroseconds(int64_t ticks)
+	{
+		return static_cast<double>(ticks) * 1000000.0 / static_cast<double>(GetFrequency());
+	}
+}
@@ -0,0 +1,241 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// The argument types that a printf conversion specification can consume.
+// The values are part of the binary log file format.
+enum class PrintfArgumentType : uint8_t
+{
+	None = 0,
+	Int32 = 1,
+	Int64 = 2,
+	Float64 = 3,
+	String = 4,
+	Pointer = 5
+};
+
+struct PrintfConversion
+{
+	// The offset of the '%' character in the format string.
+	size_t offset;
+	// The length of the conversion specification, including the '%' character.
+	size_t length;
+	// The length of the '%', flags, width and precision, excluding the length modifier.
+	size_t prefixLength;
+	// The conversion specifier character, '%' for an escaped percent sign.
+	char specifier;
+	// The number of '*' width or precision values, each of those consumes an int argument.
+	uint8_t starArgumentCount;
+	PrintfArgumentType argumentType;
+};
+
+namespace PrintfFormat
+{
+	inline bool IsIntegerSpecifier(char specifier)
+	{
+		switch (specifier)
+		{
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	inline bool IsSignedSpecifier(char specifier)
+	{
+		return specifier == 'd' || specifier == 'i';
+	}
+
+	/**
+	 * @brief Checks if the arguments of a conversion specification can be read without formatting it.
+	 * @return True for an escaped percent sign or a conversion with a known argument type;
+	 * otherwise, false. The arguments that follow an unsupported conversion cannot be located.
+	*/
+	inline bool IsSupported(const PrintfConversion& conversion)
+	{
+		return conversion.specifier == '%' || conversion.argumentType != PrintfArgumentType::None;
+	}
+
+	/**
+	 * @brief Finds the next conversion specification in a printf format string.
+	 * @param format The format string.
+	 * @param startOffset The offset to start searching from.
+	 * @param conversion Receives the conversion specification.
+	 * @return True if a conversion specification was found; otherwise, false.
+	 * @remarks The argument sizes are the ones used by the platform that this is compiled for.
+	*/
+	inline bool FindNextConversion(std::string_view format, size_t startOffset, PrintfConversion& conversion)
+	{
+		const size_t percentOffset = format.find('%', startOffset);
+
+		if (percentOffset == std::string_view::npos)
+		{
+			return false;
+		}
+
+		size_t i = percentOffset + 1;
+
+		conversion.offset = percentOffset;
+		conversion.starArgumentCount = 0;
+		conversion.argumentType = PrintfArgumentType::None;
+
+		// Flags
+		while (i < format.size() && std::string_view("-+ #0").find(format[i]) != std::string_view::npos)
+		{
+			i++;
+		}
+
+		// Width
+		if (i < format.size() && format[i] == '*')
+		{
+			conversion.starArgumentCount++;
+			i++;
+		}
+		else
+		{
+			while (i < format.size() && format[i] >= '0' && format[i] <= '9')
+			{
+				i++;
+			}
+		}
+
+		// Precision
+		if (i < format.size() && format[i] == '.')
+		{
+			i++;
+
+			if (i < format.size() && format[i] == '*')
+			{
+				conversion.starArgumentCount++;
+				i++;
+			}
+			else
+			{
+				while (i < format.size() && format[i] >= '0' && format[i] <= '9')
+				{
+					i++;
+				}
+			}
+		}
+
+		conversion.prefixLength = i - percentOffset;
+
+		// Length modifier
+		size_t integerSize = sizeof(int);
+
+		if (format.substr(i, 2) == "hh")
+		{
+			i += 2;
+		}
+		else if (format.substr(i, 2) == "ll")
+		{
+			integerSize = sizeof(long long);
+			i += 2;
+		}
+		else if (format.substr(i, 3) == "I64")
+		{
+			integerSize = sizeof(int64_t);
+			i += 3;
+		}
+		else if (format.substr(i, 3) == "I32")
+		{
+			integerSize = sizeof(int32_t);
+			i += 3;
+		}
+		else if (i < format.size())
+		{
+			switch (format[i])
+			{
+			case 'h':
+			case 'L':
+				i++;
+				break;
+			case 'l':
+				integerSize = sizeof(long);
+				i++;
+				break;
+			case 'j':
+				integerSize = sizeof(intmax_t);
+				i++;
+				break;
+			case 'z':
+			case 'I':
+				integerSize = sizeof(size_t);
+				i++;
+				break;
+			case 't':
+				integerSize = sizeof(ptrdiff_t);
+				i++;
+				break;
+			}
+		}
+
+		conversion.specifier = i < format.size() ? format[i] : '\0';
+
+		switch (conversion.specifier)
+		{
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			conversion.argumentType = integerSize == sizeof(int64_t) ? PrintfArgumentType::Int64 : PrintfArgumentType::Int32;
+			break;
+		case 'c':
+			conversion.argumentType = PrintfArgumentType::Int32;
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			conversion.argumentType = PrintfArgumentType::Float64;
+			break;
+		case 's':
+			conversion.argumentType = PrintfArgumentType::String;
+			break;
+		case 'p':
+			conversion.argumentType = PrintfArgumentType::Pointer;
+			break;
+		case '%':
+		default:
+			// Escaped percent signs do not consume an argument. The argument size of an
+			// unsupported conversion is unknown, see IsSupported.
+			conversion.starArgumentCount = 0;
+			break;
+		}
+
+		if (i < format.size())
+		{
+			i++;
+		}
+
+		conversion.length = i - percentOffset;
+
+		return true;
+	}
+}
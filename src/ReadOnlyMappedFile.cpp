@@ -0,0 +1,105 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "ReadOnlyMappedFile.h"
+#include <Windows.h>
+
+ReadOnlyMappedFile::ReadOnlyMappedFile()
+	: file(),
+	  mapping(),
+	  view(nullptr),
+	  size(0)
+{
+}
+
+ReadOnlyMappedFile::~ReadOnlyMappedFile()
+{
+	Close();
+}
+
+bool ReadOnlyMappedFile::Open(const std::filesystem::path& path)
+{
+	Close();
+
+	file.reset(CreateFileW(
+		path.c_str(),
+		GENERIC_READ,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL,
+		nullptr));
+
+	if (!file)
+	{
+		return false;
+	}
+
+	LARGE_INTEGER fileSize{};
+
+	if (!GetFileSizeEx(file.get(), &fileSize) || fileSize.QuadPart < 0)
+	{
+		Close();
+		return false;
+	}
+
+	// A file mapping cannot be created for an empty file.
+	if (fileSize.QuadPart == 0)
+	{
+		return true;
+	}
+
+	if (static_cast<uint64_t>(fileSize.QuadPart) > SIZE_MAX)
+	{
+		Close();
+		return false;
+	}
+
+	mapping.reset(CreateFileMappingW(file.get(), nullptr, PAGE_READONLY, 0, 0, nullptr));
+
+	if (!mapping)
+	{
+		Close();
+		return false;
+	}
+
+	view = static_cast<const char*>(MapViewOfFile(mapping.get(), FILE_MAP_READ, 0, 0, 0));
+
+	if (!view)
+	{
+		Close();
+		return false;
+	}
+
+	size = static_cast<size_t>(fileSize.QuadPart);
+
+	return true;
+}
+
+void ReadOnlyMappedFile::Close()
+{
+	if (view)
+	{
+		UnmapViewOfFile(view);
+		view = nullptr;
+	}
+
+	size = 0;
+	mapping.reset();
+	file.reset();
+}
+
+std::string_view ReadOnlyMappedFile::GetContents() const
+{
+	return view ? std::string_view(view, size) : std::string_view();
+}
@@ -0,0 +1,55 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include "wil/resource.h"
+
+// Maps the contents of a file into memory for reading.
+//
+// The file is opened with write and delete sharing so that a text editor can
+// save the file while it is mapped.
+class ReadOnlyMappedFile
+{
+public:
+
+	ReadOnlyMappedFile();
+	~ReadOnlyMappedFile();
+
+	ReadOnlyMappedFile(const ReadOnlyMappedFile&) = delete;
+	ReadOnlyMappedFile& operator=(const ReadOnlyMappedFile&) = delete;
+
+	/**
+	 * @brief Opens and maps the file.
+	 * @param path The file path.
+	 * @return True if the file was opened; otherwise, false.
+	*/
+	bool Open(const std::filesystem::path& path);
+
+	void Close();
+
+	/**
+	 * @brief Gets the contents of the file.
+	 * The view is valid until the file is closed, an empty file has an empty view.
+	*/
+	std::string_view GetContents() const;
+
+private:
+
+	wil::unique_hfile file;
+	wil::unique_handle mapping;
+	const char* view;
+	size_t size;
+};
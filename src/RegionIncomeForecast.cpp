@@ -0,0 +1,145 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "RegionIncomeForecast.h"
+#include "GamblingIncomeModel.h"
+#include "ISettings.h"
+#include "Logger.h"
+#include "Money.h"
+#include "cISC4Region.h"
+#include "cISC4RegionalCity.h"
+#include "cRZBaseString.h"
+#include <list>
+
+RegionIncomeForecast::RegionIncomeForecast()
+	: cities(),
+	  cityCensusValues(),
+	  totalIncome(0)
+{
+}
+
+bool RegionIncomeForecast::Capture(cISC4Region* pRegion)
+{
+	cities.clear();
+	cityCensusValues.clear();
+	totalIncome = 0;
+
+	if (!pRegion)
+	{
+		return false;
+	}
+
+	std::list<cRZAutoRefCount<cISC4RegionalCity>> regionCities;
+
+	if (!pRegion->GetAllCities(regionCities))
+	{
+		return false;
+	}
+
+	cities.reserve(regionCities.size());
+	cityCensusValues.reserve(regionCities.size());
+
+	for (const cRZAutoRefCount<cISC4RegionalCity>& pRegionalCity : regionCities)
+	{
+		// The region has a city for every tile, the tiles that have never been
+		// played are skipped.
+		if (!pRegionalCity || !pRegionalCity->GetEstablished())
+		{
+			continue;
+		}
+
+		RegionCityIncome& city = cities.emplace_back();
+		city.x = 0;
+		city.y = 0;
+		city.monthlyIncome = 0;
+
+		pRegionalCity->GetPosition(city.x, city.y);
+
+		cRZBaseString name;
+
+		if (pRegionalCity->GetCityName(name))
+		{
+			city.name.assign(name.ToChar(), name.Strlen());
+		}
+
+		// The regional city uses the demand IDs as its population types.
+		CensusValues& values = cityCensusValues.emplace_back();
+
+		for (size_t i = 0; i < values.size(); i++)
+		{
+			values[i] = static_cast<float>(pRegionalCity->GetPopulation(CensusGroupDemandIDs[i]));
+		}
+	}
+
+	return true;
+}
+
+void RegionIncomeForecast::Calculate(const ISettings& settings)
+{
+	GamblingIncomeModel incomeModel;
+	incomeModel.SetParameters(
+		settings.BaseMonthlyIncome(),
+		settings.ResidentialLowWealthFactor(),
+		settings.ResidentialMedWealthFactor(),
+		settings.ResidentialHighWealthFactor(),
+		settings.MonthlyIncomeFormula());
+
+	Money total;
+
+	for (size_t i = 0; i < cities.size(); i++)
+	{
+		const int64_t monthlyIncome = incomeModel.Calculate(cityCensusValues[i]).totalIncome;
+
+		cities[i].monthlyIncome = monthlyIncome;
+		total = total + Money::FromWhole(monthlyIncome);
+	}
+
+	totalIncome = total.ToWhole();
+}
+
+void RegionIncomeForecast::WriteToLog() const
+{
+	Logger& logger = Logger::GetInstance();
+
+	if (!logger.IsEnabled(LogOptions::RegionIncomeForecast))
+	{
+		return;
+	}
+
+	logger.WriteLineFormatted(
+		LogOptions::RegionIncomeForecast,
+		"Region gambling income forecast: cities=%u, total monthly income=%lld",
+		static_cast<uint32_t>(cities.size()),
+		totalIncome);
+
+	for (const RegionCityIncome& city : cities)
+	{
+		logger.WriteLineFormatted(
+			LogOptions::RegionIncomeForecast,
+			"%s (%d, %d): monthly income=%lld",
+			city.name.c_str(),
+			city.x,
+			city.y,
+			city.monthlyIncome);
+	}
+}
+
+const std::vector<RegionCityIncome>& RegionIncomeForecast::GetCities() const
+{
+	return cities;
+}
+
+int64_t RegionIncomeForecast::GetTotalIncome() const
+{
+	return totalIncome;
+}
@@ -0,0 +1,65 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "CensusSnapshot.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class cISC4Region;
+class ISettings;
+
+struct RegionCityIncome
+{
+	std::string name;
+	int32_t x;
+	int32_t y;
+	int64_t monthlyIncome;
+};
+
+// Projects the Legalize Gambling ordinance income of every established city in the region.
+//
+// The game's region objects are not thread safe, so the populations are copied on the game
+// thread before the income is calculated. The income uses the same model as the ordinance,
+// with the populations that the region view has cached for each city.
+class RegionIncomeForecast
+{
+public:
+
+	RegionIncomeForecast();
+
+	/**
+	 * @brief Copies the name, position and populations of the region's cities.
+	 * @param pRegion The region.
+	 * @return True if the cities were read; otherwise, false.
+	*/
+	bool Capture(cISC4Region* pRegion);
+
+	/**
+	 * @brief Calculates the monthly income of each city with the specified settings.
+	*/
+	void Calculate(const ISettings& settings);
+
+	void WriteToLog() const;
+
+	const std::vector<RegionCityIncome>& GetCities() const;
+
+	int64_t GetTotalIncome() const;
+
+private:
+
+	std::vector<RegionCityIncome> cities;
+	std::vector<CensusValues> cityCensusValues;
+	int64_t totalIncome;
+};
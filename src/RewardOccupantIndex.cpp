@@ -0,0 +1,151 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "RewardOccupantIndex.h"
+#include "cISC4City.h"
+#include "cISC4Occupant.h"
+#include "cISC4OccupantManager.h"
+#include "cISCPropertyHolder.h"
+
+static const uint32_t kSCPROP_CityExclusionGroup = 0xEA2E078B;
+static const uint32_t kOccupantGroup_Reward = 0x150B;
+static const uint32_t kOccupantType_Building = 0x278128A0;
+
+RewardOccupantIndex::RewardOccupantIndex()
+	: occupants(),
+	  built(false)
+{
+}
+
+RewardOccupantIndex::~RewardOccupantIndex()
+{
+	Clear();
+}
+
+void RewardOccupantIndex::Build(cISC4City* pCity)
+{
+	Clear();
+
+	if (pCity)
+	{
+		cISC4OccupantManager* pOccupantManager = pCity->GetOccupantManager();
+
+		if (pOccupantManager)
+		{
+			pOccupantManager->IterateOccupants(BuildIterator, this, nullptr, nullptr, kOccupantType_Building);
+			built = true;
+		}
+	}
+}
+
+void RewardOccupantIndex::Clear()
+{
+	for (auto& item : occupants)
+	{
+		item.second->Release();
+	}
+
+	occupants.clear();
+	built = false;
+}
+
+bool RewardOccupantIndex::IsBuilt() const
+{
+	return built;
+}
+
+void RewardOccupantIndex::OnOccupantInserted(cISC4Occupant* pOccupant)
+{
+	if (built && pOccupant)
+	{
+		uint32_t cityExclusionGroup = 0;
+
+		if (TryGetCityExclusionGroup(pOccupant, cityExclusionGroup))
+		{
+			Insert(cityExclusionGroup, pOccupant);
+		}
+	}
+}
+
+void RewardOccupantIndex::OnOccupantRemoved(cISC4Occupant* pOccupant)
+{
+	if (built && pOccupant)
+	{
+		// The occupant's properties may have already been released when it is removed,
+		// so the occupant is found by its address instead of its exclusion group.
+		for (auto it = occupants.begin(); it != occupants.end(); ++it)
+		{
+			if (it->second == pOccupant)
+			{
+				it->second->Release();
+				occupants.erase(it);
+				break;
+			}
+		}
+	}
+}
+
+cISC4Occupant* RewardOccupantIndex::Find(uint32_t cityExclusionGroup) const
+{
+	const auto it = occupants.find(cityExclusionGroup);
+
+	return it != occupants.end() ? it->second : nullptr;
+}
+
+bool RewardOccupantIndex::TryGetCityExclusionGroup(cISC4Occupant* pOccupant, uint32_t& cityExclusionGroup)
+{
+	if (pOccupant->GetType() == kOccupantType_Building)
+	{
+		if (pOccupant->IsOccupantGroup(kOccupantGroup_Reward))
+		{
+			cISCPropertyHolder* pProperties = pOccupant->AsPropertyHolder();
+
+			if (pProperties)
+			{
+				return pProperties->GetProperty(kSCPROP_CityExclusionGroup, cityExclusionGroup);
+			}
+		}
+	}
+
+	return false;
+}
+
+void RewardOccupantIndex::Insert(uint32_t cityExclusionGroup, cISC4Occupant* pOccupant)
+{
+	cISC4Occupant*& item = occupants[cityExclusionGroup];
+
+	if (item != pOccupant)
+	{
+		pOccupant->AddRef();
+
+		if (item)
+		{
+			item->Release();
+		}
+
+		item = pOccupant;
+	}
+}
+
+bool RewardOccupantIndex::BuildIterator(cISC4Occupant* pOccupant, void* pData)
+{
+	uint32_t cityExclusionGroup = 0;
+
+	if (TryGetCityExclusionGroup(pOccupant, cityExclusionGroup))
+	{
+		static_cast<RewardOccupantIndex*>(pData)->Insert(cityExclusionGroup, pOccupant);
+	}
+
+	// Continue the enumeration.
+	return true;
+}
@@ -0,0 +1,77 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+
+class cISC4City;
+class cISC4Occupant;
+
+// An index of the city's reward building occupants, keyed by their city exclusion group.
+//
+// The index is built from a single occupant iteration when a city is loaded, and it is
+// then kept current from the occupant insert and remove notifications. This allows a
+// reward building to be found without iterating over every building in the city.
+//
+// The indexed occupants are referenced, so an occupant that is removed without a
+// notification cannot be released while it is in the index.
+class RewardOccupantIndex
+{
+public:
+
+	RewardOccupantIndex();
+	~RewardOccupantIndex();
+
+	RewardOccupantIndex(const RewardOccupantIndex&) = delete;
+	RewardOccupantIndex& operator=(const RewardOccupantIndex&) = delete;
+
+	/**
+	 * @brief Indexes the reward buildings of the specified city.
+	*/
+	void Build(cISC4City* pCity);
+
+	/**
+	 * @brief Removes all of the occupants from the index.
+	*/
+	void Clear();
+
+	bool IsBuilt() const;
+
+	void OnOccupantInserted(cISC4Occupant* pOccupant);
+	void OnOccupantRemoved(cISC4Occupant* pOccupant);
+
+	/**
+	 * @brief Gets the reward building that has the specified city exclusion group.
+	 * @param cityExclusionGroup The city exclusion group.
+	 * @return The occupant, or nullptr if the city does not have the building.
+	*/
+	cISC4Occupant* Find(uint32_t cityExclusionGroup) const;
+
+	/**
+	 * @brief Gets the city exclusion group of a reward building.
+	 * @param pOccupant The occupant.
+	 * @param cityExclusionGroup Receives the city exclusion group.
+	 * @return True if the occupant is a reward building with a city exclusion group; otherwise, false.
+	*/
+	static bool TryGetCityExclusionGroup(cISC4Occupant* pOccupant, uint32_t& cityExclusionGroup);
+
+private:
+
+	void Insert(uint32_t cityExclusionGroup, cISC4Occupant* pOccupant);
+
+	static bool BuildIterator(cISC4Occupant* pOccupant, void* pData);
+
+	std::unordered_map<uint32_t, cISC4Occupant*> occupants;
+	bool built;
+};
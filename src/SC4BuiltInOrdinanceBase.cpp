@@ -12,7 +12,9 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "SC4BuiltInOrdinanceBase.h"
+#include "Money.h"
 #include "StringResourceManager.h"
+#include "TraceSpan.h"
 #include "cIGZDate.h"
 #include "cIGZIStream.h"
 #include "cIGZOStream.h"
@@ -104,7 +106,8 @@ namespace
 }
 
 
-SC4BuiltInOrdinanceBase::SC4BuiltInOrdinanceBase(
+template <typename TracePolicy>
+SC4BuiltInOrdinanceBaseT<TracePolicy>::SC4BuiltInOrdinanceBaseT(
 	BuiltInOrdinanaceExemplarInfo info,
 	const char* name,
 	const StringResourceKey& nameKey,
@@ -143,11 +146,13 @@ SC4BuiltInOrdinanceBase::SC4BuiltInOrdinanceBase(
 	  pSimulator(nullptr),
 	  miscProperties(properties),
 	  exemplarInfo(info),
-	  logger(Logger::GetInstance())
+	  logger(Logger::GetInstance()),
+	  methodStatistics()
 {
 }
 
-SC4BuiltInOrdinanceBase::SC4BuiltInOrdinanceBase(const SC4BuiltInOrdinanceBase& other)
+template <typename TracePolicy>
+SC4BuiltInOrdinanceBaseT<TracePolicy>::SC4BuiltInOrdinanceBaseT(const SC4BuiltInOrdinanceBaseT& other)
 	: clsid(other.clsid),
 	  refCount(0),
 	  name(other.name),
@@ -172,11 +177,13 @@ SC4BuiltInOrdinanceBase::SC4BuiltInOrdinanceBase(const SC4BuiltInOrdinanceBase&
 	  pSimulator(other.pSimulator),
 	  miscProperties(other.miscProperties),
 	  exemplarInfo(other.exemplarInfo),
-	  logger(Logger::GetInstance())
+	  logger(Logger::GetInstance()),
+	  methodStatistics()
 {
 }
 
-SC4BuiltInOrdinanceBase::SC4BuiltInOrdinanceBase(SC4BuiltInOrdinanceBase&& other) noexcept
+template <typename TracePolicy>
+SC4BuiltInOrdinanceBaseT<TracePolicy>::SC4BuiltInOrdinanceBaseT(SC4BuiltInOrdinanceBaseT&& other) noexcept
 	: clsid(other.clsid),
 	  refCount(0),
 	  name(std::move(name)),
@@ -201,13 +208,15 @@ SC4BuiltInOrdinanceBase::SC4BuiltInOrdinanceBase(SC4BuiltInOrdinanceBase&& other
 	  pSimulator(other.pSimulator),
 	  miscProperties(std::move(other.miscProperties)),
 	  exemplarInfo(other.exemplarInfo),
-	  logger(Logger::GetInstance())
+	  logger(Logger::GetInstance()),
+	  methodStatistics()
 {
 	other.pResidentialSimulator = nullptr;
 	other.pSimulator = nullptr;
 }
 
-SC4BuiltInOrdinanceBase& SC4BuiltInOrdinanceBase::operator=(const SC4BuiltInOrdinanceBase& other)
+template <typename TracePolicy>
+SC4BuiltInOrdinanceBaseT<TracePolicy>& SC4BuiltInOrdinanceBaseT<TracePolicy>::operator=(const SC4BuiltInOrdinanceBaseT& other)
 {
 	if (this == &other)
 	{
@@ -242,7 +251,8 @@ SC4BuiltInOrdinanceBase& SC4BuiltInOrdinanceBase::operator=(const SC4BuiltInOrdi
 	return *this;
 }
 
-SC4BuiltInOrdinanceBase& SC4BuiltInOrdinanceBase::operator=(SC4BuiltInOrdinanceBase&& other) noexcept
+template <typename TracePolicy>
+SC4BuiltInOrdinanceBaseT<TracePolicy>& SC4BuiltInOrdinanceBaseT<TracePolicy>::operator=(SC4BuiltInOrdinanceBaseT&& other) noexcept
 {
 	if (this == &other)
 	{
@@ -280,7 +290,8 @@ SC4BuiltInOrdinanceBase& SC4BuiltInOrdinanceBase::operator=(SC4BuiltInOrdinanceB
 	return *this;
 }
 
-bool SC4BuiltInOrdinanceBase::QueryInterface(uint32_t riid, void** ppvObj)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::QueryInterface(uint32_t riid, void** ppvObj)
 {
 	if (riid == GZIID_SC4BuiltInOrdinanceBase)
 	{
@@ -314,12 +325,14 @@ bool SC4BuiltInOrdinanceBase::QueryInterface(uint32_t riid, void** ppvObj)
 	return false;
 }
 
-uint32_t SC4BuiltInOrdinanceBase::AddRef()
+template <typename TracePolicy>
+uint32_t SC4BuiltInOrdinanceBaseT<TracePolicy>::AddRef()
 {
 	return ++refCount;
 }
 
-uint32_t SC4BuiltInOrdinanceBase::Release()
+template <typename TracePolicy>
+uint32_t SC4BuiltInOrdinanceBaseT<TracePolicy>::Release()
 {
 	if (refCount > 0)
 	{
@@ -328,8 +341,11 @@ uint32_t SC4BuiltInOrdinanceBase::Release()
 	return refCount;
 }
 
-bool SC4BuiltInOrdinanceBase::Init(void)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::Init(void)
 {
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::Init);
+
 	if (!initialized)
 	{
 		enabled = true;
@@ -346,8 +362,12 @@ bool SC4BuiltInOrdinanceBase::Init(void)
 	return true;
 }
 
-bool SC4BuiltInOrdinanceBase::Shutdown(void)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::Shutdown(void)
 {
+	methodStatistics.WriteToLog(name.ToChar());
+	methodStatistics.Reset();
+
 	enabled = false;
 	initialized = false;
 
@@ -361,10 +381,14 @@ bool SC4BuiltInOrdinanceBase::Shutdown(void)
 	return true;
 }
 
-int64_t SC4BuiltInOrdinanceBase::GetCurrentMonthlyIncome(void)
+template <typename TracePolicy>
+int64_t SC4BuiltInOrdinanceBaseT<TracePolicy>::GetCurrentMonthlyIncome(void)
 {
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::GetCurrentMonthlyIncome);
+	TraceSpan span("SC4BuiltInOrdinanceBase::GetCurrentMonthlyIncome");
+
 	const int64_t monthlyConstantIncome = GetMonthlyConstantIncome();
-	const double monthlyIncomeFactor = GetMonthlyIncomeFactor();
+	const float monthlyIncomeFactor = GetMonthlyIncomeFactor();
 
 	if (!pResidentialSimulator)
 	{
@@ -373,119 +397,154 @@ int64_t SC4BuiltInOrdinanceBase::GetCurrentMonthlyIncome(void)
 
 	// The monthly income factor is multiplied by the city population.
 	const int32_t cityPopulation = pResidentialSimulator->GetPopulation();
-	const double populationIncome = monthlyIncomeFactor * static_cast<double>(cityPopulation);
 
-	const double monthlyIncome = static_cast<double>(monthlyConstantIncome) + populationIncome;
+	// The built-in ordinances can use any int64_t income, so this uses the int64_t arithmetic
+	// instead of a Money amount, which is limited to the range that the gambling income needs.
+	const int64_t populationIncome = SaturatingArithmetic::MultiplyQ32(
+		cityPopulation,
+		MoneyFactor::FromFloat(monthlyIncomeFactor).Raw());
 
-	int64_t monthlyIncomeInteger = 0;
+	const int64_t monthlyIncomeInteger = SaturatingArithmetic::Add(monthlyConstantIncome, populationIncome);
 
-	if (monthlyIncome < std::numeric_limits<int64_t>::min())
-	{
-		monthlyIncomeInteger = std::numeric_limits<int64_t>::min();
-	}
-	else if (monthlyIncome > std::numeric_limits<int64_t>::max())
-	{
-		monthlyIncomeInteger = std::numeric_limits<int64_t>::max();
-	}
-	else
-	{
-		monthlyIncomeInteger = static_cast<int64_t>(monthlyIncome);
-	}
-
-	logger.WriteLineFormatted(
-		LogOptions::OrdinanceAPI,
+	TracePolicy::WriteLineFormatted(
+		logger,
 		"%s: monthly income: constant=%lld, factor=%f, population=%d, current=%lld",
 		__FUNCTION__,
 		monthlyConstantIncome,
-		monthlyIncomeFactor,
+		static_cast<double>(monthlyIncomeFactor),
 		cityPopulation,
 		monthlyIncomeInteger);
 
 	return monthlyIncomeInteger;
 }
 
-uint32_t SC4BuiltInOrdinanceBase::GetID(void) const
+template <typename TracePolicy>
+uint32_t SC4BuiltInOrdinanceBaseT<TracePolicy>::GetID(void) const
 {
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::GetID);
+
 	return clsid;
 }
 
-cIGZString* SC4BuiltInOrdinanceBase::GetName(void)
+template <typename TracePolicy>
+cIGZString* SC4BuiltInOrdinanceBaseT<TracePolicy>::GetName(void)
 {
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::GetName);
+
 	return &name;
 }
 
-cIGZString* SC4BuiltInOrdinanceBase::GetDescription(void)
+template <typename TracePolicy>
+cIGZString* SC4BuiltInOrdinanceBaseT<TracePolicy>::GetDescription(void)
 {
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::GetDescription);
+
 	return &description;
 }
 
-uint32_t SC4BuiltInOrdinanceBase::GetYearFirstAvailable(void)
+template <typename TracePolicy>
+uint32_t SC4BuiltInOrdinanceBaseT<TracePolicy>::GetYearFirstAvailable(void)
 {
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::GetYearFirstAvailable);
+
 	return yearFirstAvailable;
 }
 
-SC4Percentage SC4BuiltInOrdinanceBase::GetChanceAvailability(void)
+template <typename TracePolicy>
+SC4Percentage SC4BuiltInOrdinanceBaseT<TracePolicy>::GetChanceAvailability(void)
 {
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::GetChanceAvailability);
+
 	return monthlyChance;
 }
 
-int64_t SC4BuiltInOrdinanceBase::GetEnactmentIncome(void)
+template <typename TracePolicy>
+int64_t SC4BuiltInOrdinanceBaseT<TracePolicy>::GetEnactmentIncome(void)
 {
-	logger.WriteLine(LogOptions::OrdinanceAPI, __FUNCTION__);
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::GetEnactmentIncome);
+
+	TracePolicy::WriteLine(logger, __FUNCTION__);
 
 	return enactmentIncome;
 }
 
-int64_t SC4BuiltInOrdinanceBase::GetRetracmentIncome(void)
+template <typename TracePolicy>
+int64_t SC4BuiltInOrdinanceBaseT<TracePolicy>::GetRetracmentIncome(void)
 {
-	logger.WriteLine(LogOptions::OrdinanceAPI, __FUNCTION__);
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::GetRetracmentIncome);
+
+	TracePolicy::WriteLine(logger, __FUNCTION__);
 
 	return retracmentIncome;
 }
 
-int64_t SC4BuiltInOrdinanceBase::GetMonthlyConstantIncome(void)
+template <typename TracePolicy>
+int64_t SC4BuiltInOrdinanceBaseT<TracePolicy>::GetMonthlyConstantIncome(void)
 {
-	logger.WriteLine(LogOptions::OrdinanceAPI, __FUNCTION__);
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::GetMonthlyConstantIncome);
+
+	TracePolicy::WriteLine(logger, __FUNCTION__);
 
 	return monthlyConstantIncome;
 }
 
-float SC4BuiltInOrdinanceBase::GetMonthlyIncomeFactor(void)
+template <typename TracePolicy>
+float SC4BuiltInOrdinanceBaseT<TracePolicy>::GetMonthlyIncomeFactor(void)
 {
-	logger.WriteLine(LogOptions::OrdinanceAPI, __FUNCTION__);
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::GetMonthlyIncomeFactor);
+
+	TracePolicy::WriteLine(logger, __FUNCTION__);
 
 	return monthlyIncomeFactor;
 }
 
-cISCPropertyHolder* SC4BuiltInOrdinanceBase::GetMiscProperties()
+template <typename TracePolicy>
+cISCPropertyHolder* SC4BuiltInOrdinanceBaseT<TracePolicy>::GetMiscProperties()
 {
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::GetMiscProperties);
+
 	return &miscProperties;
 }
 
-uint32_t SC4BuiltInOrdinanceBase::GetAdvisorID(void)
+template <typename TracePolicy>
+uint32_t SC4BuiltInOrdinanceBaseT<TracePolicy>::GetAdvisorID(void)
 {
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::GetAdvisorID);
+
 	return advisorID;
 }
 
-bool SC4BuiltInOrdinanceBase::IsAvailable(void)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::IsAvailable(void)
 {
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::IsAvailable);
+
 	return available;
 }
 
-bool SC4BuiltInOrdinanceBase::IsOn(void)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::IsOn(void)
 {
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::IsOn);
+
 	return available && on;
 }
 
-bool SC4BuiltInOrdinanceBase::IsEnabled(void)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::IsEnabled(void)
 {
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::IsEnabled);
+
 	return enabled;
 }
 
-int64_t SC4BuiltInOrdinanceBase::GetMonthlyAdjustedIncome(void)
+template <typename TracePolicy>
+int64_t SC4BuiltInOrdinanceBaseT<TracePolicy>::GetMonthlyAdjustedIncome(void)
 {
-	logger.WriteLineFormatted(
-		LogOptions::OrdinanceAPI,
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::GetMonthlyAdjustedIncome);
+
+	TracePolicy::WriteLineFormatted(
+		logger,
 		"%s: result=%lld",
 		__FUNCTION__,
 		monthlyAdjustedIncome);
@@ -493,8 +552,11 @@ int64_t SC4BuiltInOrdinanceBase::GetMonthlyAdjustedIncome(void)
 	return monthlyAdjustedIncome;
 }
 
-bool SC4BuiltInOrdinanceBase::CheckConditions(void)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::CheckConditions(void)
 {
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::CheckConditions);
+
 	bool result = false;
 
 	if (enabled)
@@ -510,8 +572,8 @@ bool SC4BuiltInOrdinanceBase::CheckConditions(void)
 		}
 	}
 
-	logger.WriteLineFormatted(
-		LogOptions::OrdinanceAPI,
+	TracePolicy::WriteLineFormatted(
+		logger,
 		"%s: result=%d",
 		__FUNCTION__,
 		result);
@@ -519,19 +581,26 @@ bool SC4BuiltInOrdinanceBase::CheckConditions(void)
 	return result;
 }
 
-bool SC4BuiltInOrdinanceBase::IsIncomeOrdinance(void)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::IsIncomeOrdinance(void)
 {
-	logger.WriteLine(LogOptions::OrdinanceAPI, __FUNCTION__);
+	typename TracePolicy::GetterScope timer(methodStatistics, OrdinanceMethod::IsIncomeOrdinance);
+
+	TracePolicy::WriteLine(logger, __FUNCTION__);
 
 	return isIncomeOrdinance;
 }
 
-bool SC4BuiltInOrdinanceBase::Simulate(void)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::Simulate(void)
 {
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::Simulate);
+	TraceSpan span("SC4BuiltInOrdinanceBase::Simulate");
+
 	monthlyAdjustedIncome = GetCurrentMonthlyIncome();
 
-	logger.WriteLineFormatted(
-		LogOptions::OrdinanceAPI,
+	TracePolicy::WriteLineFormatted(
+		logger,
 		"%s: monthlyAdjustedIncome=%lld",
 		__FUNCTION__,
 		monthlyAdjustedIncome);
@@ -539,10 +608,13 @@ bool SC4BuiltInOrdinanceBase::Simulate(void)
 	return true;
 }
 
-bool SC4BuiltInOrdinanceBase::SetAvailable(bool isAvailable)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::SetAvailable(bool isAvailable)
 {
-	logger.WriteLineFormatted(
-		LogOptions::OrdinanceAPI,
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::SetAvailable);
+
+	TracePolicy::WriteLineFormatted(
+		logger,
 		"%s: value=%d",
 		__FUNCTION__,
 		isAvailable);
@@ -552,10 +624,13 @@ bool SC4BuiltInOrdinanceBase::SetAvailable(bool isAvailable)
 	return true;
 }
 
-bool SC4BuiltInOrdinanceBase::SetOn(bool isOn)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::SetOn(bool isOn)
 {
-	logger.WriteLineFormatted(
-		LogOptions::OrdinanceAPI,
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::SetOn);
+
+	TracePolicy::WriteLineFormatted(
+		logger,
 		"%s: value=%d",
 		__FUNCTION__,
 		isOn);
@@ -564,10 +639,13 @@ bool SC4BuiltInOrdinanceBase::SetOn(bool isOn)
 	return true;
 }
 
-bool SC4BuiltInOrdinanceBase::SetEnabled(bool isEnabled)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::SetEnabled(bool isEnabled)
 {
-	logger.WriteLineFormatted(
-		LogOptions::OrdinanceAPI,
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::SetEnabled);
+
+	TracePolicy::WriteLineFormatted(
+		logger,
 		"%s: value=%d",
 		__FUNCTION__,
 		isEnabled);
@@ -576,25 +654,37 @@ bool SC4BuiltInOrdinanceBase::SetEnabled(bool isEnabled)
 	return true;
 }
 
-bool SC4BuiltInOrdinanceBase::ForceAvailable(bool isAvailable)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::ForceAvailable(bool isAvailable)
 {
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::ForceAvailable);
+
 	return SetAvailable(isAvailable);
 }
 
-bool SC4BuiltInOrdinanceBase::ForceOn(bool isOn)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::ForceOn(bool isOn)
 {
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::ForceOn);
+
 	return SetOn(isOn);
 }
 
-bool SC4BuiltInOrdinanceBase::ForceEnabled(bool isEnabled)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::ForceEnabled(bool isEnabled)
 {
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::ForceEnabled);
+
 	return SetEnabled(isEnabled);
 }
 
-bool SC4BuiltInOrdinanceBase::ForceMonthlyAdjustedIncome(int64_t monthlyAdjustedIncome)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::ForceMonthlyAdjustedIncome(int64_t monthlyAdjustedIncome)
 {
-	logger.WriteLineFormatted(
-		LogOptions::OrdinanceAPI,
+	typename TracePolicy::MethodScope timer(methodStatistics, OrdinanceMethod::ForceMonthlyAdjustedIncome);
+
+	TracePolicy::WriteLineFormatted(
+		logger,
 		"%s: value=%lld",
 		__FUNCTION__,
 		monthlyAdjustedIncome);
@@ -603,7 +693,8 @@ bool SC4BuiltInOrdinanceBase::ForceMonthlyAdjustedIncome(int64_t monthlyAdjusted
 	return true;
 }
 
-void SC4BuiltInOrdinanceBase::InitializeOrdinanceComponents(cISC4City* pCity)
+template <typename TracePolicy>
+void SC4BuiltInOrdinanceBaseT<TracePolicy>::InitializeOrdinanceComponents(cISC4City* pCity)
 {
 	if (pCity)
 	{
@@ -621,13 +712,15 @@ void SC4BuiltInOrdinanceBase::InitializeOrdinanceComponents(cISC4City* pCity)
 	LoadLocalizedStringResources();
 }
 
-void SC4BuiltInOrdinanceBase::ShutdownOrdinanceComponents(cISC4City* pCity)
+template <typename TracePolicy>
+void SC4BuiltInOrdinanceBaseT<TracePolicy>::ShutdownOrdinanceComponents(cISC4City* pCity)
 {
 	pResidentialSimulator = nullptr;
 	pSimulator = nullptr;
 }
 
-bool SC4BuiltInOrdinanceBase::ReadBool(cIGZIStream& stream, bool& value)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::ReadBool(cIGZIStream& stream, bool& value)
 {
 	uint8_t temp = 0;
 	// We use GetVoid because GetUint8 always returns false.
@@ -640,14 +733,16 @@ bool SC4BuiltInOrdinanceBase::ReadBool(cIGZIStream& stream, bool& value)
 	return true;
 }
 
-bool SC4BuiltInOrdinanceBase::WriteBool(cIGZOStream& stream, bool value)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::WriteBool(cIGZOStream& stream, bool value)
 {
 	const uint8_t uint8Value = static_cast<uint8_t>(value);
 
 	return stream.SetVoid(&uint8Value, 1);
 }
 
-bool SC4BuiltInOrdinanceBase::Write(cIGZOStream& stream)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::Write(cIGZOStream& stream)
 {
 	if (stream.GetError() != 0)
 	{
@@ -743,7 +838,8 @@ bool SC4BuiltInOrdinanceBase::Write(cIGZOStream& stream)
 	return WriteSC4BuiltInOrdinanceProperties(stream, exemplarInfo);
 }
 
-bool SC4BuiltInOrdinanceBase::Read(cIGZIStream& stream)
+template <typename TracePolicy>
+bool SC4BuiltInOrdinanceBaseT<TracePolicy>::Read(cIGZIStream& stream)
 {
 	if (stream.GetError() != 0)
 	{
@@ -844,12 +940,14 @@ bool SC4BuiltInOrdinanceBase::Read(cIGZIStream& stream)
 	return true;
 }
 
-uint32_t SC4BuiltInOrdinanceBase::GetGZCLSID()
+template <typename TracePolicy>
+uint32_t SC4BuiltInOrdinanceBaseT<TracePolicy>::GetGZCLSID()
 {
 	return clsid;
 }
 
-void SC4BuiltInOrdinanceBase::LoadLocalizedStringResources()
+template <typename TracePolicy>
+void SC4BuiltInOrdinanceBaseT<TracePolicy>::LoadLocalizedStringResources()
 {
 	cIGZString* localizedName = nullptr;
 	cIGZString* localizedDescription = nullptr;
@@ -874,3 +972,5 @@ void SC4BuiltInOrdinanceBase::LoadLocalizedStringResources()
 		localizedName->Release();
 	}
 }
+
+template class SC4BuiltInOrdinanceBaseT<DefaultOrdinanceTracePolicy>;
@@ -15,7 +15,9 @@
 #include "cISC4Ordinance.h"
 #include "cIGZSerializable.h"
 #include "cRZBaseString.h"
+#include "OrdinanceMethodStatistics.h"
 #include "OrdinancePropertyHolder.h"
+#include "OrdinanceTracePolicy.h"
 #include "Logger.h"
 #include "SC4Percentage.h"
 #include "StringResourceKey.h"
@@ -35,7 +37,11 @@ class cISC4Simulator;
 
 // A base class for overriding SC4's built-in ordinances.
 // The class uses the same ordinance save data format as SC4.
-class SC4BuiltInOrdinanceBase : public cISC4Ordinance, private cIGZSerializable
+//
+// The TracePolicy controls the method statistics and OrdinanceAPI logging of the
+// cISC4Ordinance methods, see OrdinanceTracePolicy.h.
+template <typename TracePolicy>
+class SC4BuiltInOrdinanceBaseT : public cISC4Ordinance, private cIGZSerializable
 {
 public:
 
@@ -56,7 +62,7 @@ public:
 	 * @param isIncomeOrdinance True if the ordinance generates income; otherwise, false.
 	 * @param properties A list of in-game effects that the ordinance has.
 	*/
-	SC4BuiltInOrdinanceBase(
+	SC4BuiltInOrdinanceBaseT(
 		BuiltInOrdinanaceExemplarInfo info,
 		const char* name,
 		const StringResourceKey& nameKey,
@@ -72,11 +78,11 @@ public:
 		bool isIncomeOrdinance,
 		const OrdinancePropertyHolder& properties);
 
-	SC4BuiltInOrdinanceBase(const SC4BuiltInOrdinanceBase& other);
-	SC4BuiltInOrdinanceBase(SC4BuiltInOrdinanceBase&& other) noexcept;
+	SC4BuiltInOrdinanceBaseT(const SC4BuiltInOrdinanceBaseT& other);
+	SC4BuiltInOrdinanceBaseT(SC4BuiltInOrdinanceBaseT&& other) noexcept;
 
-	SC4BuiltInOrdinanceBase& operator=(const SC4BuiltInOrdinanceBase& other);
-	SC4BuiltInOrdinanceBase& operator=(SC4BuiltInOrdinanceBase&& other) noexcept;
+	SC4BuiltInOrdinanceBaseT& operator=(const SC4BuiltInOrdinanceBaseT& other);
+	SC4BuiltInOrdinanceBaseT& operator=(SC4BuiltInOrdinanceBaseT&& other) noexcept;
 
 	bool QueryInterface(uint32_t riid, void** ppvObj) final;
 
@@ -219,6 +225,8 @@ public:
 
 protected:
 
+	using Trace = TracePolicy;
+
 	virtual void InitializeOrdinanceComponents(cISC4City* pCity);
 
 	virtual void ShutdownOrdinanceComponents(cISC4City* pCity);
@@ -227,6 +235,11 @@ protected:
 
 	OrdinancePropertyHolder miscProperties;
 
+	// The call count and latency of the cISC4Ordinance methods, this is written
+	// to the log and reset when the ordinance is shut down.
+	// The statistics are only stored when the build records them, see OrdinanceTracePolicy.h.
+	mutable typename TracePolicy::Statistics methodStatistics;
+
 private:
 
 	static bool ReadBool(cIGZIStream& stream, bool& value);
@@ -273,3 +286,7 @@ private:
 	bool haveDeserialized;
 };
 
+// The instantiation is in SC4BuiltInOrdinanceBase.cpp, only the policy that the build selects is instantiated.
+extern template class SC4BuiltInOrdinanceBaseT<DefaultOrdinanceTracePolicy>;
+
+using SC4BuiltInOrdinanceBase = SC4BuiltInOrdinanceBaseT<DefaultOrdinanceTracePolicy>;
@@ -12,43 +12,385 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "Settings.h"
+#include "GamblingIncomeModel.h"
+#include "IniParser.h"
 #include "Logger.h"
-#include "boost/property_tree/ptree.hpp"
-#include "boost/property_tree/ini_parser.hpp"
+#include "ReadOnlyMappedFile.h"
+#include "SettingsCache.h"
+#include "version.h"
+#include <cstdio>
+#include <type_traits>
 
 namespace
 {
-	// Throws an exception of the value is out of range.
-	float CheckValueRange(float value, float min, float max, const char* name)
+	// The values that are read from the settings file.
+	// The optional settings are initialized to their default values.
+	//
+	// This structure is also the contents of the settings cache. The cache key includes
+	// the plugin version, the size of this structure and SettingsCacheLayoutVersion below,
+	// so a cache that was written by another build of the plugin is never read with a
+	// different layout. The cached values are checked against the current limits when
+	// they are read, see IsValidCachedValues.
+	struct SettingsValues
 	{
-		if (value < min)
+		int64_t baseMonthlyIncome = 0;
+		float residentialLowWealthFactor = 0.0f;
+		float residentialMedWealthFactor = 0.0f;
+		float residentialHighWealthFactor = 0.0f;
+		float crimeEffectMultiplier = 1.0f;
+		IncomeFormula monthlyIncomeFormula{};
+		LogConfiguration loggingConfiguration{};
+		bool tracingEnabled = false;
+	};
+
+	static_assert(std::is_trivially_copyable_v<SettingsValues>);
+
+	// Increment this when the layout of SettingsValues, or of one of the types that it contains,
+	// changes. The size is also checked, but it does not detect a change that keeps the size
+	// the same, e.g. reordering two members.
+	constexpr uint32_t SettingsCacheLayoutVersion = 1;
+
+	constexpr float MinCrimeEffectMultiplier = 0.01f;
+	constexpr float MaxCrimeEffectMultiplier = 2.0f;
+	constexpr uint32_t MaxLogFileSizeMB = 1024;
+	constexpr uint32_t MaxRotatedLogFileCount = 99;
+	constexpr uint32_t MaxFlushIntervalMilliseconds = 60000;
+
+	[[noreturn]] void ThrowInvalidValue(const IniEntry& entry, const char* const requirement)
+	{
+		char buffer[1024]{};
+
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"%.*s %s",
+			static_cast<int>(entry.key.size()),
+			entry.key.data(),
+			requirement);
+
+		throw IniParseError(entry.line, entry.valueColumn, buffer);
+	}
+
+	int64_t ReadInt64(const IniEntry& entry)
+	{
+		int64_t value = 0;
+
+		if (!IniParser::TryParseInt64(entry.value, value))
 		{
-			char buffer[1024]{};
+			ThrowInvalidValue(entry, "must be an integer.");
+		}
+
+		return value;
+	}
+
+	float ReadFloat(const IniEntry& entry)
+	{
+		float value = 0.0f;
+
+		if (!IniParser::TryParseFloat(entry.value, value))
+		{
+			ThrowInvalidValue(entry, "must be a number.");
+		}
+
+		return value;
+	}
+
+	bool ReadBool(const IniEntry& entry)
+	{
+		bool value = false;
+
+		if (!IniParser::TryParseBool(entry.value, value))
+		{
+			ThrowInvalidValue(entry, "must be true or false.");
+		}
+
+		return value;
+	}
+
+	// Throws an exception if the value is out of range.
+	int64_t ReadInt64(const IniEntry& entry, int64_t min, int64_t max)
+	{
+		const int64_t value = ReadInt64(entry);
+
+		if (value < min || value > max)
+		{
+			char buffer[256]{};
 
 			std::snprintf(
 				buffer,
 				sizeof(buffer),
-				"%s is less than %f.",
-				name,
-				min);
+				"must be an integer in the range of [%lld, %lld].",
+				static_cast<long long>(min),
+				static_cast<long long>(max));
+
+			ThrowInvalidValue(entry, buffer);
+		}
+
+		return value;
+	}
+
+	// Throws an exception if the value is out of range.
+	float ReadFloat(const IniEntry& entry, float min, float max)
+	{
+		const float value = ReadFloat(entry);
+
+		if (value < min || value > max)
+		{
+			char buffer[256]{};
 
-			throw std::runtime_error(buffer);
+			std::snprintf(buffer, sizeof(buffer), "must be in the range of [%f, %f].", min, max);
+
+			ThrowInvalidValue(entry, buffer);
 		}
-		else if (value > max)
+
+		return value;
+	}
+
+	// Throws an exception if the value is out of range.
+	uint32_t ReadUInt32(const IniEntry& entry, uint32_t min, uint32_t max)
+	{
+		uint32_t value = 0;
+
+		if (!IniParser::TryParseUInt32(entry.value, value) || value < min || value > max)
+		{
+			char buffer[256]{};
+
+			std::snprintf(buffer, sizeof(buffer), "must be an integer in the range of [%u, %u].", min, max);
+
+			ThrowInvalidValue(entry, buffer);
+		}
+
+		return value;
+	}
+
+	IncomeFormula ReadIncomeFormula(const IniEntry& entry)
+	{
+		try
+		{
+			return IncomeFormula::Compile(entry.value);
+		}
+		catch (const IncomeFormulaError& e)
 		{
 			char buffer[1024]{};
 
 			std::snprintf(
 				buffer,
 				sizeof(buffer),
-				"%s is less than %f.",
-				name,
-				min);
+				"%.*s is not valid: %s",
+				static_cast<int>(entry.key.size()),
+				entry.key.data(),
+				e.what());
 
-			throw std::runtime_error(buffer);
+			throw IniParseError(entry.line, entry.valueColumn + static_cast<uint32_t>(e.Offset()), buffer);
 		}
+	}
 
-		return value;
+	LogFormat ReadLogFormat(const IniEntry& entry)
+	{
+		if (IniParser::EqualsIgnoreCase(entry.value, "Text"))
+		{
+			return LogFormat::Text;
+		}
+		else if (IniParser::EqualsIgnoreCase(entry.value, "Binary"))
+		{
+			return LogFormat::Binary;
+		}
+
+		ThrowInvalidValue(entry, "must be Text or Binary.");
+	}
+
+	LogOverflowPolicy ReadLogOverflowPolicy(const IniEntry& entry)
+	{
+		if (IniParser::EqualsIgnoreCase(entry.value, "Drop"))
+		{
+			return LogOverflowPolicy::Drop;
+		}
+		else if (IniParser::EqualsIgnoreCase(entry.value, "Block"))
+		{
+			return LogOverflowPolicy::Block;
+		}
+
+		ThrowInvalidValue(entry, "must be Drop or Block.");
+	}
+
+	template <LogOptions Option> void BindLogOption(const IniEntry& entry, SettingsValues& values)
+	{
+		LogOptions& options = values.loggingConfiguration.options;
+
+		if (ReadBool(entry))
+		{
+			options = options | Option;
+		}
+		else
+		{
+			options = options & static_cast<LogOptions>(~static_cast<std::underlying_type<LogOptions>::type>(Option));
+		}
+	}
+
+	using BindValueCallback = void(*)(const IniEntry& entry, SettingsValues& values);
+
+	struct SettingsKey
+	{
+		std::string_view section;
+		std::string_view key;
+		bool required;
+		BindValueCallback bind;
+	};
+
+	// The settings that the plugin reads, the keys are case-sensitive.
+	// The logging and tracing settings are optional, older configuration files do not have them.
+	static constexpr SettingsKey SettingsKeys[] =
+	{
+		{
+			"GamblingOrdinance", "BaseMonthlyIncome", true,
+			[](const IniEntry& entry, SettingsValues& values) { values.baseMonthlyIncome = ReadInt64(entry, -GamblingIncomeModel::MaxBaseMonthlyIncome, GamblingIncomeModel::MaxBaseMonthlyIncome); }
+		},
+		{
+			"GamblingOrdinance", "R$IncomeFactor", true,
+			[](const IniEntry& entry, SettingsValues& values) { values.residentialLowWealthFactor = ReadFloat(entry, 0.0f, GamblingIncomeModel::MaxIncomeFactor); }
+		},
+		{
+			"GamblingOrdinance", "R$$IncomeFactor", true,
+			[](const IniEntry& entry, SettingsValues& values) { values.residentialMedWealthFactor = ReadFloat(entry, 0.0f, GamblingIncomeModel::MaxIncomeFactor); }
+		},
+		{
+			"GamblingOrdinance", "R$$$IncomeFactor", true,
+			[](const IniEntry& entry, SettingsValues& values) { values.residentialHighWealthFactor = ReadFloat(entry, 0.0f, GamblingIncomeModel::MaxIncomeFactor); }
+		},
+		{
+			"GamblingOrdinance", "CrimeEffectMultiplier", true,
+			[](const IniEntry& entry, SettingsValues& values) { values.crimeEffectMultiplier = ReadFloat(entry, MinCrimeEffectMultiplier, MaxCrimeEffectMultiplier); }
+		},
+		{
+			"GamblingOrdinance", "IncomeFormula", false,
+			[](const IniEntry& entry, SettingsValues& values) { values.monthlyIncomeFormula = ReadIncomeFormula(entry); }
+		},
+		{ "Logging", "LogInfo", false, &BindLogOption<LogOptions::Info> },
+		{ "Logging", "LogErrors", false, &BindLogOption<LogOptions::Errors> },
+		{ "Logging", "LogOrdinanceAPI", false, &BindLogOption<LogOptions::OrdinanceAPI> },
+		{ "Logging", "LogOrdinancePropertyAPI", false, &BindLogOption<LogOptions::OrdinancePropertyAPI> },
+		{ "Logging", "LogRegisteredOrdinances", false, &BindLogOption<LogOptions::DumpRegisteredOrdinances> },
+		{ "Logging", "LogOrdinanceStatistics", false, &BindLogOption<LogOptions::OrdinanceStatistics> },
+		{ "Logging", "LogRegionIncomeForecast", false, &BindLogOption<LogOptions::RegionIncomeForecast> },
+		{
+			"Logging", "LogFileFormat", false,
+			[](const IniEntry& entry, SettingsValues& values) { values.loggingConfiguration.format = ReadLogFormat(entry); }
+		},
+		{
+			"Logging", "BackgroundWriter", false,
+			[](const IniEntry& entry, SettingsValues& values) { values.loggingConfiguration.backgroundWriter = ReadBool(entry); }
+		},
+		{
+			"Logging", "BackgroundWriterOverflowPolicy", false,
+			[](const IniEntry& entry, SettingsValues& values) { values.loggingConfiguration.overflowPolicy = ReadLogOverflowPolicy(entry); }
+		},
+		{
+			"Logging", "MaxLogFileSizeMB", false,
+			[](const IniEntry& entry, SettingsValues& values)
+			{
+				values.loggingConfiguration.maxFileSize = static_cast<uint64_t>(ReadUInt32(entry, 0, MaxLogFileSizeMB)) * 1024 * 1024;
+			}
+		},
+		{
+			"Logging", "RotatedLogFileCount", false,
+			[](const IniEntry& entry, SettingsValues& values) { values.loggingConfiguration.rotatedFileCount = ReadUInt32(entry, 0, MaxRotatedLogFileCount); }
+		},
+		{
+			"Logging", "FlushIntervalMilliseconds", false,
+			[](const IniEntry& entry, SettingsValues& values)
+			{
+				values.loggingConfiguration.flushIntervalMilliseconds = ReadUInt32(entry, 0, MaxFlushIntervalMilliseconds);
+			}
+		},
+		{
+			"Tracing", "Enabled", false,
+			[](const IniEntry& entry, SettingsValues& values) { values.tracingEnabled = ReadBool(entry); }
+		},
+	};
+
+	constexpr size_t SettingsKeyCount = sizeof(SettingsKeys) / sizeof(SettingsKeys[0]);
+
+	static_assert(SettingsKeyCount <= 32, "The loaded keys are tracked in a 32-bit mask.");
+
+	struct SettingsLoadContext
+	{
+		SettingsValues values;
+		uint32_t loadedKeys = 0;
+	};
+
+	void OnSettingsEntry(const IniEntry& entry, void* context)
+	{
+		SettingsLoadContext* loadContext = static_cast<SettingsLoadContext*>(context);
+
+		for (size_t i = 0; i < SettingsKeyCount; i++)
+		{
+			const SettingsKey& item = SettingsKeys[i];
+
+			if (item.key == entry.key && item.section == entry.section)
+			{
+				const uint32_t keyMask = 1U << i;
+
+				if ((loadContext->loadedKeys & keyMask) != 0)
+				{
+					ThrowInvalidValue(entry, "is set more than once.");
+				}
+
+				item.bind(entry, loadContext->values);
+				loadContext->loadedKeys |= keyMask;
+				break;
+			}
+		}
+	}
+
+	bool IsInRange(float value, float min, float max)
+	{
+		// The comparisons are false for NaN.
+		return value >= min && value <= max;
+	}
+
+	// A development build can change the limits without changing the plugin version,
+	// so the values that are read from the cache are checked against the same limits
+	// that are used when the settings file is parsed.
+	bool IsValidCachedValues(const SettingsValues& values)
+	{
+		const LogConfiguration& logging = values.loggingConfiguration;
+
+		return values.baseMonthlyIncome >= -GamblingIncomeModel::MaxBaseMonthlyIncome
+			&& values.baseMonthlyIncome <= GamblingIncomeModel::MaxBaseMonthlyIncome
+			&& IsInRange(values.residentialLowWealthFactor, 0.0f, GamblingIncomeModel::MaxIncomeFactor)
+			&& IsInRange(values.residentialMedWealthFactor, 0.0f, GamblingIncomeModel::MaxIncomeFactor)
+			&& IsInRange(values.residentialHighWealthFactor, 0.0f, GamblingIncomeModel::MaxIncomeFactor)
+			&& IsInRange(values.crimeEffectMultiplier, MinCrimeEffectMultiplier, MaxCrimeEffectMultiplier)
+			&& (logging.options & static_cast<LogOptions>(~static_cast<std::underlying_type<LogOptions>::type>(LogOptions::All))) == static_cast<LogOptions>(0)
+			&& (logging.format == LogFormat::Text || logging.format == LogFormat::Binary)
+			&& (logging.overflowPolicy == LogOverflowPolicy::Drop || logging.overflowPolicy == LogOverflowPolicy::Block)
+			&& logging.maxFileSize <= static_cast<uint64_t>(MaxLogFileSizeMB) * 1024 * 1024
+			&& logging.rotatedFileCount <= MaxRotatedLogFileCount
+			&& logging.flushIntervalMilliseconds <= MaxFlushIntervalMilliseconds;
+	}
+
+	void CheckRequiredKeys(uint32_t loadedKeys)
+	{
+		for (size_t i = 0; i < SettingsKeyCount; i++)
+		{
+			const SettingsKey& item = SettingsKeys[i];
+
+			if (item.required && (loadedKeys & (1U << i)) == 0)
+			{
+				char buffer[1024]{};
+
+				std::snprintf(
+					buffer,
+					sizeof(buffer),
+					"The required setting %.*s.%.*s is missing.",
+					static_cast<int>(item.section.size()),
+					item.section.data(),
+					static_cast<int>(item.key.size()),
+					item.key.data());
+
+				throw std::runtime_error(buffer);
+			}
+		}
 	}
 }
 
@@ -57,40 +399,65 @@ Settings::Settings()
 	  residentialLowWealthFactor(0.05f),
 	  residentialMedWealthFactor(0.03f),
 	  residentialHighWealthFactor(0.01f),
-	  cityLotteryOrdinanceEffects()
+	  monthlyIncomeFormula(),
+	  cityLotteryOrdinanceEffects(),
+	  loggingConfiguration(),
+	  tracingEnabled(false)
 {
 }
 
 void Settings::Load(const std::filesystem::path& path)
 {
-	std::ifstream stream(path, std::ifstream::in);
+	ReadOnlyMappedFile file;
 
-	if (!stream)
+	if (!file.Open(path))
 	{
-		throw std::runtime_error("Failed top open the settings file.");
+		throw std::runtime_error("Failed to open the settings file.");
 	}
 
-	boost::property_tree::ptree tree;
+	const std::string_view contents = file.GetContents();
+	const SettingsCacheKey cacheKey = SettingsCache::CreateKey(
+		path,
+		contents,
+		PLUGIN_VERSION_STR,
+		SettingsCacheLayoutVersion,
+		sizeof(SettingsValues));
+	const std::filesystem::path cachePath = SettingsCache::GetCachePath(path);
 
-	boost::property_tree::ini_parser::read_ini(stream, tree);
+	// The settings file only needs to be parsed when it has changed since the cache was written,
+	// or when the cached values are not valid for this build of the plugin.
+	SettingsValues values{};
+
+	if (!SettingsCache::TryRead(cachePath, cacheKey, &values, sizeof(values)) || !IsValidCachedValues(values))
+	{
+		// The file is parsed in a single pass, the values are only applied
+		// after the whole file has been read without errors.
+		SettingsLoadContext context{};
 
-	baseMonthlyIncome = tree.get<int64_t>("GamblingOrdinance.BaseMonthlyIncome");
-	residentialLowWealthFactor = tree.get<float>("GamblingOrdinance.R$IncomeFactor");
-	residentialMedWealthFactor = tree.get<float>("GamblingOrdinance.R$$IncomeFactor");
-	residentialHighWealthFactor = tree.get<float>("GamblingOrdinance.R$$$IncomeFactor");
+		IniParser::Parse(contents, &OnSettingsEntry, &context);
+		CheckRequiredKeys(context.loadedKeys);
 
-	float crimeEffectMultiplier = CheckValueRange(
-		tree.get<float>("GamblingOrdinance.CrimeEffectMultiplier"),
-		0.01f,
-		2.0f,
-		"CrimeEffectMultiplier");
+		values = context.values;
+
+		// The cache is optional, the write fails if the plugins folder is read-only.
+		SettingsCache::Write(cachePath, cacheKey, &values, sizeof(values));
+	}
+
+	baseMonthlyIncome = values.baseMonthlyIncome;
+	residentialLowWealthFactor = values.residentialLowWealthFactor;
+	residentialMedWealthFactor = values.residentialMedWealthFactor;
+	residentialHighWealthFactor = values.residentialHighWealthFactor;
+	monthlyIncomeFormula = values.monthlyIncomeFormula;
 
 	cityLotteryOrdinanceEffects.RemoveAllProperties();
 
-	if (crimeEffectMultiplier != 1.0f)
+	if (values.crimeEffectMultiplier != 1.0f)
 	{
-		cityLotteryOrdinanceEffects.AddProperty(0x28ed0380, crimeEffectMultiplier);
+		cityLotteryOrdinanceEffects.AddProperty(0x28ed0380, values.crimeEffectMultiplier);
 	}
+
+	loggingConfiguration = values.loggingConfiguration;
+	tracingEnabled = values.tracingEnabled;
 }
 
 int64_t Settings::BaseMonthlyIncome() const
@@ -113,7 +480,22 @@ float Settings::ResidentialHighWealthFactor() const
 	return residentialHighWealthFactor;
 }
 
-OrdinancePropertyHolder Settings::OrdinanceEffects() const
+const IncomeFormula& Settings::MonthlyIncomeFormula() const
+{
+	return monthlyIncomeFormula;
+}
+
+const OrdinancePropertyHolder& Settings::OrdinanceEffects() const
 {
 	return cityLotteryOrdinanceEffects;
 }
+
+const LogConfiguration& Settings::LoggingConfiguration() const
+{
+	return loggingConfiguration;
+}
+
+bool Settings::TracingEnabled() const
+{
+	return tracingEnabled;
+}
@@ -29,8 +29,10 @@ public:
 	float ResidentialLowWealthFactor() const override;
 	float ResidentialMedWealthFactor() const override;
 	float ResidentialHighWealthFactor() const override;
-	OrdinancePropertyHolder OrdinanceEffects() const override;
-
+	const IncomeFormula& MonthlyIncomeFormula() const override;
+	const OrdinancePropertyHolder& OrdinanceEffects() const override;
+	const LogConfiguration& LoggingConfiguration() const override;
+	bool TracingEnabled() const override;
 
 private:
 
@@ -38,6 +40,9 @@ private:
 	float residentialLowWealthFactor;
 	float residentialMedWealthFactor;
 	float residentialHighWealthFactor;
+	IncomeFormula monthlyIncomeFormula;
 	OrdinancePropertyHolder cityLotteryOrdinanceEffects;
+	LogConfiguration loggingConfiguration;
+	bool tracingEnabled;
 };
 
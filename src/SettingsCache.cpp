@@ -0,0 +1,182 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SettingsCache.h"
+#include "ReadOnlyMappedFile.h"
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+	// 'SLGC' in little-endian byte order.
+	constexpr uint32_t CacheFileSignature = 0x43474C53;
+	// Increment this when the layout of the header changes. A change to the layout of the
+	// cached settings is detected by the payload layout hash in the key.
+	constexpr uint32_t CacheFileVersion = 1;
+
+	struct CacheFileHeader
+	{
+		uint32_t signature;
+		uint32_t version;
+		uint64_t settingsFileSize;
+		int64_t settingsLastWriteTime;
+		uint64_t settingsContentHash;
+		uint64_t payloadLayoutHash;
+		uint64_t payloadSize;
+		uint64_t payloadHash;
+	};
+
+	static_assert(sizeof(CacheFileHeader) == 56);
+
+	constexpr uint64_t FnvOffsetBasis = 0xCBF29CE484222325;
+
+	// The 64-bit FNV-1a hash, the hash parameter continues a previous hash.
+	uint64_t ComputeHash(const void* data, size_t size, uint64_t hash = FnvOffsetBasis)
+	{
+		constexpr uint64_t Prime = 0x100000001B3;
+
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= Prime;
+		}
+
+		return hash;
+	}
+}
+
+SettingsCacheKey SettingsCache::CreateKey(
+	const std::filesystem::path& path,
+	std::string_view contents,
+	std::string_view pluginVersion,
+	uint32_t payloadLayoutVersion,
+	size_t payloadSize)
+{
+	SettingsCacheKey key{};
+	key.fileSize = contents.size();
+	key.contentHash = ComputeHash(contents.data(), contents.size());
+
+	const uint64_t payloadSize64 = payloadSize;
+	uint64_t layoutHash = ComputeHash(pluginVersion.data(), pluginVersion.size());
+	layoutHash = ComputeHash(&payloadLayoutVersion, sizeof(payloadLayoutVersion), layoutHash);
+	key.payloadLayoutHash = ComputeHash(&payloadSize64, sizeof(payloadSize64), layoutHash);
+
+	std::error_code ec;
+	const std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(path, ec);
+
+	key.lastWriteTime = ec ? 0 : static_cast<int64_t>(lastWriteTime.time_since_epoch().count());
+
+	return key;
+}
+
+std::filesystem::path SettingsCache::GetCachePath(const std::filesystem::path& settingsPath)
+{
+	std::filesystem::path cachePath = settingsPath;
+	cachePath += L".cache";
+
+	return cachePath;
+}
+
+bool SettingsCache::TryRead(const std::filesystem::path& cachePath, const SettingsCacheKey& key, void* payload, size_t payloadSize)
+{
+	ReadOnlyMappedFile file;
+
+	if (!file.Open(cachePath))
+	{
+		return false;
+	}
+
+	const std::string_view contents = file.GetContents();
+
+	if (contents.size() != (sizeof(CacheFileHeader) + payloadSize))
+	{
+		return false;
+	}
+
+	CacheFileHeader header{};
+	std::memcpy(&header, contents.data(), sizeof(header));
+
+	if (header.signature != CacheFileSignature
+		|| header.version != CacheFileVersion
+		|| header.settingsFileSize != key.fileSize
+		|| header.settingsLastWriteTime != key.lastWriteTime
+		|| header.settingsContentHash != key.contentHash
+		|| header.payloadLayoutHash != key.payloadLayoutHash
+		|| header.payloadSize != payloadSize)
+	{
+		return false;
+	}
+
+	const char* const cachedPayload = contents.data() + sizeof(header);
+
+	if (header.payloadHash != ComputeHash(cachedPayload, payloadSize))
+	{
+		return false;
+	}
+
+	std::memcpy(payload, cachedPayload, payloadSize);
+
+	return true;
+}
+
+bool SettingsCache::Write(const std::filesystem::path& cachePath, const SettingsCacheKey& key, const void* payload, size_t payloadSize)
+{
+	CacheFileHeader header{};
+	header.signature = CacheFileSignature;
+	header.version = CacheFileVersion;
+	header.settingsFileSize = key.fileSize;
+	header.settingsLastWriteTime = key.lastWriteTime;
+	header.settingsContentHash = key.contentHash;
+	header.payloadLayoutHash = key.payloadLayoutHash;
+	header.payloadSize = payloadSize;
+	header.payloadHash = ComputeHash(payload, payloadSize);
+
+	// The cache is written to a temporary file that replaces the existing cache,
+	// a partially written file is never read by another game instance.
+	std::filesystem::path tempPath = cachePath;
+	tempPath += L".tmp";
+
+	{
+		std::ofstream stream(tempPath, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+
+		if (!stream)
+		{
+			return false;
+		}
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(static_cast<const char*>(payload), static_cast<std::streamsize>(payloadSize));
+
+		if (!stream)
+		{
+			stream.close();
+
+			std::error_code ec;
+			std::filesystem::remove(tempPath, ec);
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempPath, cachePath, ec);
+
+	if (ec)
+	{
+		std::filesystem::remove(tempPath, ec);
+		return false;
+	}
+
+	return true;
+}
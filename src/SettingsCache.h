@@ -0,0 +1,75 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+// Identifies the version of the settings file that a cache was created from.
+struct SettingsCacheKey
+{
+	uint64_t fileSize;
+	int64_t lastWriteTime;
+	uint64_t contentHash;
+	// Identifies the plugin version and the layout version and size of the cached settings.
+	// A cache that was written by another plugin version, or with a different layout, is not used.
+	uint64_t payloadLayoutHash;
+};
+
+// A binary snapshot of the validated settings that is stored next to the settings file.
+//
+// The snapshot is only used when its key matches the current settings file, otherwise
+// the settings file is parsed and a new snapshot is written. The snapshot contents are
+// opaque to this code, the caller is responsible for validating the values before
+// they are written.
+namespace SettingsCache
+{
+	/**
+	 * @brief Creates the cache key for the settings file contents.
+	 * @param path The settings file path.
+	 * @param contents The contents of the settings file.
+	 * @param pluginVersion The version of the plugin that writes the cache.
+	 * @param payloadLayoutVersion The layout version of the cached settings.
+	 * @param payloadSize The size of the cached settings.
+	 * @return The cache key.
+	*/
+	SettingsCacheKey CreateKey(
+		const std::filesystem::path& path,
+		std::string_view contents,
+		std::string_view pluginVersion,
+		uint32_t payloadLayoutVersion,
+		size_t payloadSize);
+
+	std::filesystem::path GetCachePath(const std::filesystem::path& settingsPath);
+
+	/**
+	 * @brief Reads the cached settings.
+	 * @param cachePath The cache file path.
+	 * @param key The key of the current settings file.
+	 * @param payload The buffer that receives the cached settings.
+	 * @param payloadSize The size of the cached settings.
+	 * @return True if the cache matches the key and it is not damaged; otherwise, false.
+	*/
+	bool TryRead(const std::filesystem::path& cachePath, const SettingsCacheKey& key, void* payload, size_t payloadSize);
+
+	/**
+	 * @brief Writes the cached settings, the existing cache file is replaced.
+	 * @param cachePath The cache file path.
+	 * @param key The key of the current settings file.
+	 * @param payload The settings that are cached.
+	 * @param payloadSize The size of the cached settings.
+	 * @return True if the cache was written; otherwise, false.
+	*/
+	bool Write(const std::filesystem::path& cachePath, const SettingsCacheKey& key, const void* payload, size_t payloadSize);
+}
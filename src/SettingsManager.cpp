@@ -0,0 +1,238 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "SettingsManager.h"
+#include "Logger.h"
+#include <Windows.h>
+
+namespace
+{
+	// Text editors often write a file in several steps, the reload is delayed
+	// until the file has not been modified for this long.
+	constexpr DWORD ReloadDelayMilliseconds = 250;
+
+	std::filesystem::file_time_type GetLastWriteTime(const std::filesystem::path& path)
+	{
+		std::error_code ec;
+
+		std::filesystem::file_time_type lastWriteTime = std::filesystem::last_write_time(path, ec);
+
+		return ec ? std::filesystem::file_time_type::min() : lastWriteTime;
+	}
+
+	// Checks if a buffer of FILE_NOTIFY_INFORMATION records from ReadDirectoryChangesW
+	// has a record for the specified file.
+	bool ContainsFileName(const uint8_t* buffer, const std::wstring& fileName)
+	{
+		const int fileNameLength = static_cast<int>(fileName.size());
+
+		for (;;)
+		{
+			const FILE_NOTIFY_INFORMATION* info = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(buffer);
+			const int length = static_cast<int>(info->FileNameLength / sizeof(WCHAR));
+
+			// The file names are case-insensitive.
+			if (CompareStringOrdinal(info->FileName, length, fileName.c_str(), fileNameLength, TRUE) == CSTR_EQUAL)
+			{
+				return true;
+			}
+
+			if (info->NextEntryOffset == 0)
+			{
+				return false;
+			}
+
+			buffer += info->NextEntryOffset;
+		}
+	}
+}
+
+SettingsManager::SettingsManager()
+	: path(),
+	  lastWriteTime(),
+	  currentSettings(std::make_shared<const Settings>()),
+	  generation(0),
+	  watcherThread(),
+	  stopEvent()
+{
+}
+
+SettingsManager::~SettingsManager()
+{
+	StopWatching();
+}
+
+void SettingsManager::Load(const std::filesystem::path& path)
+{
+	this->path = path;
+	lastWriteTime = GetLastWriteTime(path);
+
+	std::shared_ptr<Settings> settings = std::make_shared<Settings>();
+	settings->Load(path);
+
+	Publish(std::move(settings));
+}
+
+void SettingsManager::StartWatching()
+{
+	if (watcherThread.joinable() || path.empty())
+	{
+		return;
+	}
+
+	if (!stopEvent)
+	{
+		stopEvent.create(wil::EventOptions::ManualReset);
+	}
+
+	stopEvent.ResetEvent();
+
+	watcherThread = std::thread(&SettingsManager::WatcherThreadProc, this);
+}
+
+void SettingsManager::StopWatching()
+{
+	if (watcherThread.joinable())
+	{
+		stopEvent.SetEvent();
+		watcherThread.join();
+	}
+}
+
+std::shared_ptr<const Settings> SettingsManager::GetSettings() const
+{
+	return currentSettings.load(std::memory_order_acquire);
+}
+
+uint32_t SettingsManager::GetGeneration() const
+{
+	return generation.load(std::memory_order_acquire);
+}
+
+void SettingsManager::WatcherThreadProc()
+{
+	// The folder also contains the plugin's log, trace and cache files, the change
+	// notifications are filtered so that only the settings file wakes this thread.
+	wil::unique_hfile directory(CreateFileW(
+		path.parent_path().c_str(),
+		FILE_LIST_DIRECTORY,
+		FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		nullptr,
+		OPEN_EXISTING,
+		FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED,
+		nullptr));
+
+	wil::unique_event changeEvent;
+
+	if (!directory || !changeEvent.try_create(wil::EventOptions::ManualReset, nullptr))
+	{
+		Logger::GetInstance().WriteLine(LogOptions::Errors, "Failed to watch the settings file for changes.");
+		return;
+	}
+
+	const std::wstring fileName = path.filename().wstring();
+
+	OVERLAPPED overlapped{};
+	overlapped.hEvent = changeEvent.get();
+
+	// The buffer must be DWORD aligned, the notifications that do not fit are reported
+	// as a read with no data.
+	alignas(DWORD) uint8_t buffer[4096];
+
+	const HANDLE handles[2] = { stopEvent.get(), changeEvent.get() };
+
+	for (;;)
+	{
+		changeEvent.ResetEvent();
+
+		if (!ReadDirectoryChangesW(
+			directory.get(),
+			buffer,
+			sizeof(buffer),
+			FALSE,
+			FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE,
+			nullptr,
+			&overlapped,
+			nullptr))
+		{
+			Logger::GetInstance().WriteLine(LogOptions::Errors, "Failed to watch the settings file for changes.");
+			break;
+		}
+
+		const DWORD result = WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+
+		DWORD bytesReturned = 0;
+
+		if (result != (WAIT_OBJECT_0 + 1))
+		{
+			CancelIoEx(directory.get(), &overlapped);
+			GetOverlappedResult(directory.get(), &overlapped, &bytesReturned, TRUE);
+			break;
+		}
+
+		if (!GetOverlappedResult(directory.get(), &overlapped, &bytesReturned, FALSE))
+		{
+			break;
+		}
+
+		if (bytesReturned > 0 && !ContainsFileName(buffer, fileName))
+		{
+			continue;
+		}
+
+		if (WaitForSingleObject(stopEvent.get(), ReloadDelayMilliseconds) == WAIT_OBJECT_0)
+		{
+			break;
+		}
+
+		ReloadIfModified();
+	}
+}
+
+void SettingsManager::ReloadIfModified()
+{
+	const std::filesystem::file_time_type writeTime = GetLastWriteTime(path);
+
+	if (writeTime == lastWriteTime)
+	{
+		return;
+	}
+
+	lastWriteTime = writeTime;
+
+	Logger& logger = Logger::GetInstance();
+
+	try
+	{
+		std::shared_ptr<Settings> settings = std::make_shared<Settings>();
+		settings->Load(path);
+
+		Publish(std::move(settings));
+
+		logger.WriteLine(LogOptions::Info, "Reloaded the settings file.");
+	}
+	catch (const std::exception& e)
+	{
+		// The previous settings remain in effect until the file is fixed.
+		logger.WriteLineFormatted(
+			LogOptions::Errors,
+			"Failed to reload the settings file: %s",
+			e.what());
+	}
+}
+
+void SettingsManager::Publish(std::shared_ptr<const Settings> settings)
+{
+	currentSettings.store(std::move(settings), std::memory_order_release);
+	generation.fetch_add(1, std::memory_order_acq_rel);
+}
@@ -0,0 +1,74 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "Settings.h"
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <thread>
+#include "wil/resource.h"
+
+// Owns the current settings and reloads them when the settings file is modified.
+//
+// The settings file is watched and parsed by a background thread, each successful
+// reload publishes a new immutable Settings snapshot and increments the generation
+// number. The game thread applies the new snapshot at a safe point by comparing
+// the generation number to the one it last applied.
+class SettingsManager
+{
+public:
+
+	SettingsManager();
+	~SettingsManager();
+
+	SettingsManager(const SettingsManager&) = delete;
+	SettingsManager& operator=(const SettingsManager&) = delete;
+
+	/**
+	 * @brief Loads the settings file, an exception is thrown if the file is not valid.
+	 * @param path The settings file path.
+	*/
+	void Load(const std::filesystem::path& path);
+
+	/**
+	 * @brief Starts the thread that reloads the settings when the file is modified.
+	*/
+	void StartWatching();
+
+	void StopWatching();
+
+	/**
+	 * @brief Gets the current settings snapshot.
+	 * @return The current settings, the snapshot is not modified by later reloads.
+	*/
+	std::shared_ptr<const Settings> GetSettings() const;
+
+	/**
+	 * @brief Gets a number that is incremented every time new settings are published.
+	*/
+	uint32_t GetGeneration() const;
+
+private:
+
+	void WatcherThreadProc();
+	void ReloadIfModified();
+	void Publish(std::shared_ptr<const Settings> settings);
+
+	std::filesystem::path path;
+	std::filesystem::file_time_type lastWriteTime;
+	std::atomic<std::shared_ptr<const Settings>> currentSettings;
+	std::atomic<uint32_t> generation;
+	std::thread watcherThread;
+	wil::unique_event stopEvent;
+};
@@ -0,0 +1,49 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "PerformanceCounter.h"
+#include "Tracer.h"
+
+// Records the time from the construction of the object to its destruction as a trace span.
+// The span is not recorded if tracing was disabled when the object was constructed.
+class TraceSpan
+{
+public:
+
+	/**
+	 * @brief Starts the span.
+	 * @param name The span name, it must have static storage duration.
+	*/
+	explicit TraceSpan(const char* const name)
+		: name(name),
+		  startTicks(Tracer::GetInstance().IsEnabled() ? PerformanceCounter::GetTicks() : 0)
+	{
+	}
+
+	~TraceSpan()
+	{
+		if (startTicks != 0)
+		{
+			Tracer::GetInstance().AddSpan(name, startTicks, PerformanceCounter::GetTicks());
+		}
+	}
+
+	TraceSpan(const TraceSpan&) = delete;
+	TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+
+	const char* const name;
+	const int64_t startTicks;
+};
@@ -0,0 +1,250 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Tracer.h"
+#include "PerformanceCounter.h"
+#include <cstdio>
+#include <Windows.h>
+
+namespace
+{
+	// The spans are written to the file when this many have been recorded,
+	// this limits the memory that is used by a long game session.
+	constexpr size_t MaxBufferedEvents = 4096;
+
+	constexpr const char* const TraceCategory = "SC4LegalizeGamblingUpgrade";
+}
+
+Tracer& Tracer::GetInstance()
+{
+	static Tracer tracer;
+
+	return tracer;
+}
+
+Tracer::Tracer()
+	: mutex(),
+	  writerWakeup(),
+	  enabled(false),
+	  traceFilePath(),
+	  traceFile(),
+	  events(),
+	  pendingBuffers(),
+	  freeBuffers(),
+	  writerThread(),
+	  stopRequested(false),
+	  writeBuffer(),
+	  startTicks(0),
+	  processId(0),
+	  eventWritten(false)
+{
+}
+
+Tracer::~Tracer()
+{
+	Shutdown();
+}
+
+void Tracer::Init(std::filesystem::path traceFilePath)
+{
+	std::scoped_lock lock(mutex);
+
+	this->traceFilePath = traceFilePath;
+	startTicks = PerformanceCounter::GetTicks();
+	processId = static_cast<uint32_t>(GetCurrentProcessId());
+}
+
+void Tracer::SetEnabled(bool enabled)
+{
+	std::scoped_lock lock(mutex);
+
+	if (enabled && !traceFilePath.empty())
+	{
+		events.reserve(MaxBufferedEvents);
+
+		if (!writerThread.joinable())
+		{
+			stopRequested = false;
+			writerThread = std::thread(&Tracer::WriterThreadProc, this);
+		}
+
+		this->enabled.store(true, std::memory_order_relaxed);
+	}
+	else
+	{
+		this->enabled.store(false, std::memory_order_relaxed);
+	}
+}
+
+void Tracer::AddSpan(const char* const name, int64_t startTicks, int64_t endTicks)
+{
+	std::scoped_lock lock(mutex);
+
+	events.push_back(TraceEvent{ name, startTicks, endTicks, static_cast<uint32_t>(GetCurrentThreadId()) });
+
+	if (events.size() >= MaxBufferedEvents)
+	{
+		QueueEvents();
+	}
+}
+
+void Tracer::Flush()
+{
+	std::scoped_lock lock(mutex);
+
+	QueueEvents();
+}
+
+void Tracer::Shutdown()
+{
+	{
+		std::scoped_lock lock(mutex);
+
+		enabled.store(false, std::memory_order_relaxed);
+
+		QueueEvents();
+		stopRequested = true;
+	}
+
+	writerWakeup.notify_one();
+
+	if (writerThread.joinable())
+	{
+		writerThread.join();
+	}
+
+	// The writer thread has stopped, the remaining spans are written on this thread.
+	// This only finds spans if the writer thread was never started.
+	std::scoped_lock lock(mutex);
+
+	for (const EventBuffer& buffer : pendingBuffers)
+	{
+		WriteEvents(buffer);
+	}
+
+	pendingBuffers.clear();
+
+	if (traceFile.is_open())
+	{
+		// The closing bracket is optional in the trace event format, it is
+		// only written when the file is closed normally.
+		traceFile << "\n]\n";
+		traceFile.close();
+	}
+}
+
+void Tracer::QueueEvents()
+{
+	if (events.empty())
+	{
+		return;
+	}
+
+	pendingBuffers.push_back(std::move(events));
+
+	if (!freeBuffers.empty())
+	{
+		events = std::move(freeBuffers.back());
+		freeBuffers.pop_back();
+	}
+	else
+	{
+		events = EventBuffer();
+		events.reserve(MaxBufferedEvents);
+	}
+
+	writerWakeup.notify_one();
+}
+
+void Tracer::WriterThreadProc()
+{
+	std::unique_lock lock(mutex);
+
+	while (true)
+	{
+		writerWakeup.wait(lock, [this] { return stopRequested || !pendingBuffers.empty(); });
+
+		while (!pendingBuffers.empty())
+		{
+			EventBuffer buffer = std::move(pendingBuffers.front());
+			pendingBuffers.erase(pendingBuffers.begin());
+
+			// The file is only written by this thread, the lock is released so that
+			// the traced threads can keep recording spans while the buffer is written.
+			lock.unlock();
+
+			WriteEvents(buffer);
+			buffer.clear();
+
+			lock.lock();
+
+			freeBuffers.push_back(std::move(buffer));
+		}
+
+		if (stopRequested)
+		{
+			break;
+		}
+	}
+}
+
+void Tracer::WriteEvents(const EventBuffer& eventBuffer)
+{
+	if (eventBuffer.empty())
+	{
+		return;
+	}
+
+	if (!traceFile.is_open())
+	{
+		traceFile.open(traceFilePath, std::ofstream::out | std::ofstream::trunc);
+
+		if (!traceFile)
+		{
+			return;
+		}
+
+		traceFile << "[\n";
+		eventWritten = false;
+	}
+
+	writeBuffer.clear();
+
+	for (const TraceEvent& item : eventBuffer)
+	{
+		char buffer[512]{};
+
+		// The time stamp and duration are in microseconds, the time stamp is
+		// relative to the time that the plugin was loaded.
+		int length = std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%u,\"tid\":%u}",
+			eventWritten ? ",\n" : "",
+			item.name,
+			TraceCategory,
+			PerformanceCounter::TicksToMicroseconds(item.startTicks - startTicks),
+			PerformanceCounter::TicksToMicroseconds(item.endTicks - item.startTicks),
+			processId,
+			item.threadId);
+
+		if (length > 0 && static_cast<size_t>(length) < sizeof(buffer))
+		{
+			writeBuffer.append(buffer, static_cast<size_t>(length));
+			eventWritten = true;
+		}
+	}
+
+	traceFile.write(writeBuffer.data(), static_cast<std::streamsize>(writeBuffer.size()));
+	traceFile.flush();
+}
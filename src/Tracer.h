@@ -0,0 +1,110 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records timed spans and writes them to a file in the Chrome trace event format.
+// The file can be opened in chrome://tracing or https://ui.perfetto.dev.
+//
+// The spans are kept in memory and handed to a writer thread when the city is shut down,
+// or when the buffer is full. The threads that record the spans never wait for the file I/O.
+class Tracer
+{
+public:
+
+	static Tracer& GetInstance();
+
+	void Init(std::filesystem::path traceFilePath);
+
+	/**
+	 * @brief Enables or disables the span recording.
+	 * @param enabled true to record the spans; otherwise, false.
+	*/
+	void SetEnabled(bool enabled);
+
+	bool IsEnabled() const
+	{
+		return enabled.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief Adds a complete span to the trace.
+	 * @param name The span name, it must have static storage duration.
+	 * @param startTicks The performance counter value at the start of the span.
+	 * @param endTicks The performance counter value at the end of the span.
+	*/
+	void AddSpan(const char* const name, int64_t startTicks, int64_t endTicks);
+
+	/**
+	 * @brief Hands the recorded spans to the writer thread, which writes them to the trace file.
+	*/
+	void Flush();
+
+	/**
+	 * @brief Stops the writer thread after it has written the recorded spans and closes the trace file.
+	*/
+	void Shutdown();
+
+private:
+
+	Tracer();
+	~Tracer();
+
+	struct TraceEvent
+	{
+		const char* name;
+		int64_t startTicks;
+		int64_t endTicks;
+		uint32_t threadId;
+	};
+
+	using EventBuffer = std::vector<TraceEvent>;
+
+	/**
+	 * @brief Moves the recorded spans to the writer thread's queue, the caller must hold the lock.
+	*/
+	void QueueEvents();
+	void WriterThreadProc();
+	/**
+	 * @brief Writes the spans to the trace file, this is only called by the writer thread
+	 * or after the writer thread has stopped.
+	*/
+	void WriteEvents(const EventBuffer& eventBuffer);
+
+	std::mutex mutex;
+	std::condition_variable writerWakeup;
+	std::atomic<bool> enabled;
+	std::filesystem::path traceFilePath;
+	std::ofstream traceFile;
+	EventBuffer events;
+	// The full buffers that are waiting for the writer thread.
+	std::vector<EventBuffer> pendingBuffers;
+	// The buffers that the writer thread has written, they are reused so that
+	// the threads that record the spans do not allocate a new buffer.
+	std::vector<EventBuffer> freeBuffers;
+	std::thread writerThread;
+	bool stopRequested;
+	std::string writeBuffer;
+	int64_t startTicks;
+	uint32_t processId;
+	bool eventWritten;
+};
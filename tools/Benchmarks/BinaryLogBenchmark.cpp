@@ -0,0 +1,104 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Compares the game thread cost of a binary log record with formatting the same message as text.
+//
+// Usage: SC4LegalizeGamblingUpgradeBinaryLogBenchmark [iterations]
+
+#include "BinaryLogEncoder.h"
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+	size_t writtenBytes = 0;
+
+	void CountDefinition(const uint8_t*, size_t size, void*)
+	{
+		writtenBytes += size;
+	}
+
+	size_t EncodeBinary(BinaryLogEncoder& encoder, const char* const format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+
+		BinaryLogEncoder::RecordBuffer record;
+		const size_t size = encoder.EncodeFormattedMessage(format, args, record, &CountDefinition, nullptr);
+
+		va_end(args);
+
+		return size;
+	}
+
+	size_t FormatText(const char* const format, ...)
+	{
+		va_list args;
+		va_start(args, format);
+
+		char message[BinaryLogFormat::MaxRecordSize];
+		const int length = std::vsnprintf(message, sizeof(message), format, args);
+
+		va_end(args);
+
+		return length > 0 ? static_cast<size_t>(length) : 0;
+	}
+
+	template <typename Function> double MeasureNanosecondsPerCall(uint32_t iterations, Function&& function)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			writtenBytes += function(i);
+		}
+
+		const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+		return elapsed.count() / iterations;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1000000;
+
+	if (iterations == 0)
+	{
+		std::fprintf(stderr, "Usage: SC4LegalizeGamblingUpgradeBinaryLogBenchmark [iterations]\n");
+		return 1;
+	}
+
+	// The message that GetCurrentMonthlyIncome writes when the ordinance API logging is enabled.
+	static const char* const Format = "%s: monthly income: constant=%lld, factor=%f, population=%d, current=%lld";
+
+	BinaryLogEncoder encoder;
+
+	const double binary = MeasureNanosecondsPerCall(iterations, [&](uint32_t i)
+	{
+		return EncodeBinary(encoder, Format, "GetCurrentMonthlyIncome", 100LL, 0.25, static_cast<int>(i), 25100LL + i);
+	});
+
+	const double text = MeasureNanosecondsPerCall(iterations, [&](uint32_t i)
+	{
+		return FormatText(Format, "GetCurrentMonthlyIncome", 100LL, 0.25, static_cast<int>(i), 25100LL + i);
+	});
+
+	std::printf("Binary record: %.1f ns per message\n", binary);
+	std::printf("Text (vsnprintf): %.1f ns per message\n", text);
+	std::printf("(%zu bytes written)\n", writtenBytes);
+
+	return 0;
+}
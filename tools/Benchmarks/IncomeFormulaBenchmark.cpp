@@ -0,0 +1,123 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Compares the monthly income calculation with an IncomeFormula with the built-in calculation
+// that it replaces. The formula is the built-in calculation written as a formula, so both
+// paths compute the same income from the same census values.
+//
+// Usage: SC4LegalizeGamblingUpgradeIncomeFormulaBenchmark [iterations]
+
+#include "GamblingIncomeModel.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr int64_t BaseMonthlyIncome = 250;
+	constexpr float ResidentialLowWealthFactor = 0.02f;
+	constexpr float ResidentialMedWealthFactor = 0.03f;
+	constexpr float ResidentialHighWealthFactor = 0.05f;
+
+	constexpr const char* const BuiltInEquivalentFormula =
+		"BaseMonthlyIncome + R$ * R$IncomeFactor + R$$ * R$$IncomeFactor + R$$$ * R$$$IncomeFactor";
+
+	// The census values are varied so that the calculation cannot be hoisted out of the loop.
+	constexpr size_t CensusSampleCount = 4096;
+
+	std::vector<CensusValues> CreateCensusSamples()
+	{
+		std::mt19937 random(12345);
+		std::uniform_int_distribution<int32_t> population(0, 500000);
+
+		std::vector<CensusValues> samples(CensusSampleCount);
+
+		for (CensusValues& values : samples)
+		{
+			for (float& value : values)
+			{
+				value = static_cast<float>(population(random));
+			}
+		}
+
+		return samples;
+	}
+
+	GamblingIncomeModel CreateModel(const IncomeFormula& formula)
+	{
+		GamblingIncomeModel model;
+		model.SetParameters(
+			BaseMonthlyIncome,
+			ResidentialLowWealthFactor,
+			ResidentialMedWealthFactor,
+			ResidentialHighWealthFactor,
+			formula);
+
+		return model;
+	}
+
+	double MeasureNanosecondsPerCalculation(
+		uint32_t iterations,
+		const GamblingIncomeModel& model,
+		const std::vector<CensusValues>& samples,
+		int64_t& checksum)
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			checksum += model.Calculate(samples[i % CensusSampleCount]).totalIncome;
+		}
+
+		const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+		return elapsed.count() / iterations;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 10000000;
+
+	if (iterations == 0)
+	{
+		std::fprintf(stderr, "Usage: SC4LegalizeGamblingUpgradeIncomeFormulaBenchmark [iterations]\n");
+		return 1;
+	}
+
+	const std::vector<CensusValues> samples = CreateCensusSamples();
+	const GamblingIncomeModel builtInModel = CreateModel(IncomeFormula());
+	const GamblingIncomeModel formulaModel = CreateModel(IncomeFormula::Compile(BuiltInEquivalentFormula));
+
+	int64_t builtInChecksum = 0;
+	int64_t formulaChecksum = 0;
+
+	const double builtIn = MeasureNanosecondsPerCalculation(iterations, builtInModel, samples, builtInChecksum);
+	const double formula = MeasureNanosecondsPerCalculation(iterations, formulaModel, samples, formulaChecksum);
+
+	std::printf("Built-in calculation: %.2f ns per calculation\n", builtIn);
+	std::printf("IncomeFormula: %.2f ns per calculation\n", formula);
+
+	if (builtInChecksum != formulaChecksum)
+	{
+		// The formula uses double arithmetic and the built-in calculation uses fixed-point,
+		// the results can differ by the rounding of the fractional dollars.
+		std::printf("The total income differs by %lld over %u calculations\n",
+			static_cast<long long>(formulaChecksum - builtInChecksum),
+			iterations);
+	}
+
+	return 0;
+}
@@ -0,0 +1,130 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Compares the OrdinancePropertyHolder lookups with a linear scan of the same property list.
+//
+// The holder has 16 effect properties, and each pass queries all 36 effect IDs in
+// OrdinancePropertySchema, as the game does when it recalculates the ordinance effects.
+// Most of the queries are for properties that the holder does not have.
+//
+// Usage: SC4LegalizeGamblingUpgradeOrdinancePropertyBenchmark [passes]
+
+#include "OrdinancePropertyHolder.h"
+#include "OrdinancePropertySchema.h"
+#include "cRZBaseVariant.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr size_t HolderPropertyCount = 16;
+
+	std::vector<cSCBaseProperty> CreateEffectProperties()
+	{
+		static float zoneTypeValues[16] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f };
+
+		std::vector<cSCBaseProperty> properties;
+
+		for (const OrdinancePropertyDescriptor& descriptor : OrdinancePropertySchema::Properties)
+		{
+			if (properties.size() == HolderPropertyCount)
+			{
+				break;
+			}
+
+			if (descriptor.elementType == cIGZVariant::Type::Float32 && descriptor.count == 1)
+			{
+				properties.emplace_back(descriptor.id, 1.0f);
+			}
+			else if (descriptor.elementType == cIGZVariant::Type::Float32 && descriptor.count == 16)
+			{
+				cRZBaseVariant value;
+				value.RefFloat32(zoneTypeValues, 16);
+
+				properties.emplace_back(descriptor.id, value);
+			}
+		}
+
+		// The properties are added in the order of the ordinance's exemplar, which is not sorted by ID.
+		std::shuffle(properties.begin(), properties.end(), std::mt19937(12345));
+
+		return properties;
+	}
+
+	const cISCProperty* FindLinear(const std::vector<cSCBaseProperty>& properties, uint32_t id)
+	{
+		for (const cSCBaseProperty& property : properties)
+		{
+			if (property.GetPropertyID() == id)
+			{
+				return &property;
+			}
+		}
+
+		return nullptr;
+	}
+
+	template <typename Function> double MeasureNanosecondsPerLookup(uint32_t passes, Function&& function)
+	{
+		size_t foundCount = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (uint32_t i = 0; i < passes; i++)
+		{
+			for (const OrdinancePropertyDescriptor& descriptor : OrdinancePropertySchema::Properties)
+			{
+				if (function(descriptor.id))
+				{
+					foundCount++;
+				}
+			}
+		}
+
+		const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+		if (foundCount != static_cast<size_t>(passes) * HolderPropertyCount)
+		{
+			std::printf("(found %zu properties, expected %zu)\n", foundCount, static_cast<size_t>(passes) * HolderPropertyCount);
+		}
+
+		return elapsed.count() / (static_cast<double>(passes) * OrdinancePropertySchema::Properties.size());
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t passes = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 1000000;
+
+	if (passes == 0)
+	{
+		std::fprintf(stderr, "Usage: SC4LegalizeGamblingUpgradeOrdinancePropertyBenchmark [passes]\n");
+		return 1;
+	}
+
+	const std::vector<cSCBaseProperty> properties = CreateEffectProperties();
+	OrdinancePropertyHolder holder(properties);
+
+	std::printf("OrdinancePropertyHolder::GetProperty: %.2f ns per lookup\n",
+		MeasureNanosecondsPerLookup(passes, [&](uint32_t id) { return holder.GetProperty(id) != nullptr; }));
+	std::printf("OrdinancePropertyHolder::HasProperty: %.2f ns per lookup\n",
+		MeasureNanosecondsPerLookup(passes, [&](uint32_t id) { return holder.HasProperty(id); }));
+	std::printf("Linear scan: %.2f ns per lookup\n",
+		MeasureNanosecondsPerLookup(passes, [&](uint32_t id) { return FindLinear(properties, id) != nullptr; }));
+
+	return 0;
+}
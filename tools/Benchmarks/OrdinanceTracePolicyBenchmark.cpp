@@ -0,0 +1,110 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Compares the per-call cost of the ordinance tracing policies.
+//
+// Each call runs the instrumentation of a SC4BuiltInOrdinanceBaseT getter, the getter scope
+// and the OrdinanceAPI log line, with the OrdinanceAPI log category disabled as it is by default.
+// The benchmark is built with all of the log categories compiled, so the logging policy
+// measures the run-time log option check that a debug build performs.
+// The OrdinanceStatistics log category is enabled, so the policies that time the getters
+// record every call. The log file is written to the temporary folder.
+//
+// Usage: SC4LegalizeGamblingUpgradeOrdinanceTracePolicyBenchmark [iterations]
+
+#include "OrdinanceTracePolicy.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+
+namespace
+{
+	template <typename TracePolicy>
+	struct OrdinanceState
+	{
+		typename TracePolicy::Statistics methodStatistics;
+		Logger& logger = Logger::GetInstance();
+		int64_t monthlyConstantIncome = 0;
+	};
+
+	// The body of SC4BuiltInOrdinanceBaseT::GetMonthlyConstantIncome.
+	template <typename TracePolicy>
+#if defined(_MSC_VER)
+	__declspec(noinline)
+#else
+	__attribute__((noinline))
+#endif
+	int64_t GetMonthlyConstantIncome(OrdinanceState<TracePolicy>& state)
+	{
+		typename TracePolicy::GetterScope timer(state.methodStatistics, OrdinanceMethod::GetMonthlyConstantIncome);
+
+		TracePolicy::WriteLine(state.logger, __FUNCTION__);
+
+		return state.monthlyConstantIncome;
+	}
+
+	template <typename TracePolicy> double MeasureNanosecondsPerCall(uint32_t iterations)
+	{
+		OrdinanceState<TracePolicy> state;
+		int64_t total = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			state.monthlyConstantIncome = i;
+			total += GetMonthlyConstantIncome<TracePolicy>(state);
+		}
+
+		const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+		const int64_t expected = static_cast<int64_t>(iterations) * (static_cast<int64_t>(iterations) - 1) / 2;
+
+		if (total != expected)
+		{
+			std::printf("(income total %lld, expected %lld)\n", static_cast<long long>(total), static_cast<long long>(expected));
+		}
+
+		return elapsed.count() / iterations;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t iterations = argc > 1 ? static_cast<uint32_t>(std::strtoul(argv[1], nullptr, 10)) : 10000000;
+
+	if (iterations == 0)
+	{
+		std::fprintf(stderr, "Usage: SC4LegalizeGamblingUpgradeOrdinanceTracePolicyBenchmark [iterations]\n");
+		return 1;
+	}
+
+	// The statistics are only recorded when their log option is enabled.
+	Logger::GetInstance().Init(
+		std::filesystem::temp_directory_path() / "SC4LegalizeGamblingUpgradeOrdinanceTracePolicyBenchmark.log",
+		LogOptions::OrdinanceStatistics);
+
+	using StatisticsOnlyOrdinanceTracePolicy = OrdinanceTracePolicy<RecordingOrdinanceStatisticsPolicy, NullOrdinanceApiLogPolicy>;
+
+	std::printf("NullOrdinanceTracePolicy: %.2f ns per call\n",
+		MeasureNanosecondsPerCall<NullOrdinanceTracePolicy>(iterations));
+	std::printf("InstrumentedOrdinanceTracePolicy: %.2f ns per call\n",
+		MeasureNanosecondsPerCall<InstrumentedOrdinanceTracePolicy>(iterations));
+	std::printf("Statistics only: %.2f ns per call\n",
+		MeasureNanosecondsPerCall<StatisticsOnlyOrdinanceTracePolicy>(iterations));
+	std::printf("LoggingOrdinanceTracePolicy: %.2f ns per call\n",
+		MeasureNanosecondsPerCall<LoggingOrdinanceTracePolicy>(iterations));
+
+	return 0;
+}
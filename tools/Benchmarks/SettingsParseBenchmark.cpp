@@ -0,0 +1,157 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Compares the time it takes to read the [GamblingOrdinance] values from the settings file text
+// with the plugin's IniParser and with boost::property_tree, which the plugin used before.
+// The file I/O is not included, the text is read into memory before the measurement.
+//
+// Usage: SC4LegalizeGamblingUpgradeSettingsParseBenchmark [settings file] [iterations]
+
+#include "IniParser.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#ifdef SC4LGU_HAVE_BOOST_PROPERTY_TREE
+#include "boost/property_tree/ini_parser.hpp"
+#include "boost/property_tree/ptree.hpp"
+#endif // SC4LGU_HAVE_BOOST_PROPERTY_TREE
+
+namespace
+{
+	struct IncomeValues
+	{
+		int64_t baseMonthlyIncome = 0;
+		float residentialLowWealthFactor = 0.0f;
+		float residentialMedWealthFactor = 0.0f;
+		float residentialHighWealthFactor = 0.0f;
+		float crimeEffectMultiplier = 0.0f;
+	};
+
+	void OnEntry(const IniEntry& entry, void* context)
+	{
+		IncomeValues* values = static_cast<IncomeValues*>(context);
+
+		if (entry.section != "GamblingOrdinance")
+		{
+			return;
+		}
+
+		if (entry.key == "BaseMonthlyIncome")
+		{
+			IniParser::TryParseInt64(entry.value, values->baseMonthlyIncome);
+		}
+		else if (entry.key == "R$IncomeFactor")
+		{
+			IniParser::TryParseFloat(entry.value, values->residentialLowWealthFactor);
+		}
+		else if (entry.key == "R$$IncomeFactor")
+		{
+			IniParser::TryParseFloat(entry.value, values->residentialMedWealthFactor);
+		}
+		else if (entry.key == "R$$$IncomeFactor")
+		{
+			IniParser::TryParseFloat(entry.value, values->residentialHighWealthFactor);
+		}
+		else if (entry.key == "CrimeEffectMultiplier")
+		{
+			IniParser::TryParseFloat(entry.value, values->crimeEffectMultiplier);
+		}
+	}
+
+	IncomeValues ParseWithIniParser(const std::string& text)
+	{
+		IncomeValues values;
+
+		IniParser::Parse(text, &OnEntry, &values);
+
+		return values;
+	}
+
+#ifdef SC4LGU_HAVE_BOOST_PROPERTY_TREE
+	IncomeValues ParseWithPropertyTree(const std::string& text)
+	{
+		std::istringstream stream(text);
+
+		boost::property_tree::ptree tree;
+		boost::property_tree::ini_parser::read_ini(stream, tree);
+
+		IncomeValues values;
+		values.baseMonthlyIncome = tree.get<int64_t>("GamblingOrdinance.BaseMonthlyIncome");
+		values.residentialLowWealthFactor = tree.get<float>("GamblingOrdinance.R$IncomeFactor");
+		values.residentialMedWealthFactor = tree.get<float>("GamblingOrdinance.R$$IncomeFactor");
+		values.residentialHighWealthFactor = tree.get<float>("GamblingOrdinance.R$$$IncomeFactor");
+		values.crimeEffectMultiplier = tree.get<float>("GamblingOrdinance.CrimeEffectMultiplier");
+
+		return values;
+	}
+#endif // SC4LGU_HAVE_BOOST_PROPERTY_TREE
+
+	template <typename Function> double MeasureMicrosecondsPerParse(uint32_t iterations, Function&& function)
+	{
+		float checksum = 0.0f;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (uint32_t i = 0; i < iterations; i++)
+		{
+			checksum += function().residentialLowWealthFactor;
+		}
+
+		const std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+
+		if (checksum == 0.0f)
+		{
+			std::printf("(the R$IncomeFactor value is zero)\n");
+		}
+
+		return elapsed.count() / iterations;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* const path = argc > 1 ? argv[1] : SC4LGU_DEFAULT_SETTINGS_FILE;
+	const uint32_t iterations = argc > 2 ? static_cast<uint32_t>(std::strtoul(argv[2], nullptr, 10)) : 100000;
+
+	std::ifstream input(path, std::ifstream::in | std::ifstream::binary);
+
+	if (!input || iterations == 0)
+	{
+		std::fprintf(stderr, "Usage: SC4LegalizeGamblingUpgradeSettingsParseBenchmark [settings file] [iterations]\n");
+		return 1;
+	}
+
+	const std::string text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+	try
+	{
+		std::printf("IniParser: %.2f us per parse\n", MeasureMicrosecondsPerParse(iterations, [&]() { return ParseWithIniParser(text); }));
+#ifdef SC4LGU_HAVE_BOOST_PROPERTY_TREE
+		std::printf("boost::property_tree: %.2f us per parse\n", MeasureMicrosecondsPerParse(iterations, [&]() { return ParseWithPropertyTree(text); }));
+#else
+		std::printf("boost::property_tree: not measured, Boost was not found when the benchmark was built\n");
+#endif // SC4LGU_HAVE_BOOST_PROPERTY_TREE
+	}
+	catch (const std::exception& e)
+	{
+		std::fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
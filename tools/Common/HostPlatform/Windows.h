@@ -0,0 +1,295 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// The subset of the Windows API that the plugin source files in the tools use, implemented
+// with the C++ standard library and POSIX. This is only on the include path when the tools
+// are built on other platforms.
+
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef unsigned long DWORD;
+typedef unsigned short WORD;
+typedef int BOOL;
+typedef long long LONGLONG;
+typedef void* HANDLE;
+typedef unsigned long LCID;
+
+#define INVALID_HANDLE_VALUE (reinterpret_cast<HANDLE>(static_cast<intptr_t>(-1)))
+
+#define _countof(array) (sizeof(array) / sizeof((array)[0]))
+
+typedef struct _FILETIME
+{
+	DWORD dwLowDateTime;
+	DWORD dwHighDateTime;
+} FILETIME;
+
+typedef union _LARGE_INTEGER
+{
+	LONGLONG QuadPart;
+} LARGE_INTEGER;
+
+typedef struct _SYSTEMTIME
+{
+	WORD wYear;
+	WORD wMonth;
+	WORD wDayOfWeek;
+	WORD wDay;
+	WORD wHour;
+	WORD wMinute;
+	WORD wSecond;
+	WORD wMilliseconds;
+} SYSTEMTIME;
+
+inline void GetSystemTimeAsFileTime(FILETIME* fileTime)
+{
+	// A FILETIME is the number of 100 nanosecond intervals since January 1, 1601.
+	constexpr uint64_t UnixEpochOffset = 116444736000000000ULL;
+
+	const auto sinceUnixEpoch = std::chrono::system_clock::now().time_since_epoch();
+	const uint64_t value = UnixEpochOffset + static_cast<uint64_t>(
+		std::chrono::duration_cast<std::chrono::duration<int64_t, std::ratio<1, 10000000>>>(sinceUnixEpoch).count());
+
+	fileTime->dwLowDateTime = static_cast<DWORD>(value & 0xFFFFFFFF);
+	fileTime->dwHighDateTime = static_cast<DWORD>(value >> 32);
+}
+
+inline BOOL FileTimeToLocalFileTime(const FILETIME* fileTime, FILETIME* localFileTime)
+{
+	// The tools do not use the time zone, the time stamps are kept in UTC.
+	*localFileTime = *fileTime;
+	return 1;
+}
+
+inline void GetLocalTime(SYSTEMTIME* systemTime)
+{
+	const auto now = std::chrono::system_clock::now();
+	const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+	const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+
+	std::tm local{};
+	localtime_r(&seconds, &local);
+
+	systemTime->wYear = static_cast<WORD>(local.tm_year + 1900);
+	systemTime->wMonth = static_cast<WORD>(local.tm_mon + 1);
+	systemTime->wDayOfWeek = static_cast<WORD>(local.tm_wday);
+	systemTime->wDay = static_cast<WORD>(local.tm_mday);
+	systemTime->wHour = static_cast<WORD>(local.tm_hour);
+	systemTime->wMinute = static_cast<WORD>(local.tm_min);
+	systemTime->wSecond = static_cast<WORD>(local.tm_sec);
+	systemTime->wMilliseconds = static_cast<WORD>(milliseconds);
+}
+
+#define LOCALE_USER_DEFAULT 0x0400
+
+// Only the default format is supported, the time is formatted as HH:MM:SS.
+inline int GetTimeFormatA(LCID, DWORD, const SYSTEMTIME* time, const char*, char* timeStr, int timeStrLength)
+{
+	SYSTEMTIME now{};
+
+	if (!time)
+	{
+		GetLocalTime(&now);
+		time = &now;
+	}
+
+	const int length = std::snprintf(timeStr, static_cast<size_t>(timeStrLength), "%02u:%02u:%02u", time->wHour, time->wMinute, time->wSecond);
+
+	// The length includes the terminating null character.
+	return length > 0 && length < timeStrLength ? length + 1 : 0;
+}
+
+inline BOOL QueryPerformanceCounter(LARGE_INTEGER* count)
+{
+	count->QuadPart = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	return 1;
+}
+
+inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency)
+{
+	frequency->QuadPart = 1000000000;
+	return 1;
+}
+
+inline uint64_t GetTickCount64()
+{
+	return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline void OutputDebugStringA(const char*)
+{
+}
+
+// The file and file mapping functions that MappedLogFile uses.
+// A handle is a file descriptor, the file mappings keep the descriptor of their file.
+
+#define GENERIC_READ 0x80000000L
+#define GENERIC_WRITE 0x40000000L
+#define FILE_SHARE_READ 0x00000001
+#define FILE_SHARE_DELETE 0x00000004
+#define CREATE_ALWAYS 2
+#define FILE_ATTRIBUTE_NORMAL 0x00000080
+#define FILE_BEGIN 0
+#define PAGE_READWRITE 0x04
+#define FILE_MAP_WRITE 0x0002
+
+namespace HostPlatform
+{
+	struct Handle
+	{
+		int fd;
+		bool ownsDescriptor;
+	};
+
+	inline int GetDescriptor(HANDLE handle)
+	{
+		return static_cast<Handle*>(handle)->fd;
+	}
+
+	// munmap and msync need the size of the view, it is recorded when the view is mapped.
+	// The map is never destroyed, the static Logger instance unmaps its view at exit.
+	inline std::map<void*, size_t>& GetMappedViews(std::unique_lock<std::mutex>& lock)
+	{
+		static std::mutex* const mutex = new std::mutex();
+		static std::map<void*, size_t>* const views = new std::map<void*, size_t>();
+
+		lock = std::unique_lock<std::mutex>(*mutex);
+		return *views;
+	}
+
+	inline size_t GetMappedViewSize(const void* address)
+	{
+		std::unique_lock<std::mutex> lock;
+		const std::map<void*, size_t>& views = GetMappedViews(lock);
+
+		const auto it = views.find(const_cast<void*>(address));
+
+		return it != views.end() ? it->second : 0;
+	}
+}
+
+// path::c_str() returns a narrow string on other platforms.
+inline HANDLE CreateFileW(const char* fileName, DWORD, DWORD, void*, DWORD, DWORD, HANDLE)
+{
+	// Only CREATE_ALWAYS with read and write access is supported.
+	const int fd = open(fileName, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+
+	return fd >= 0 ? new HostPlatform::Handle{ fd, true } : INVALID_HANDLE_VALUE;
+}
+
+inline BOOL CloseHandle(HANDLE handle)
+{
+	HostPlatform::Handle* hostHandle = static_cast<HostPlatform::Handle*>(handle);
+
+	const bool result = !hostHandle->ownsDescriptor || close(hostHandle->fd) == 0;
+	delete hostHandle;
+
+	return result;
+}
+
+inline BOOL SetFilePointerEx(HANDLE file, LARGE_INTEGER distance, LARGE_INTEGER* newPosition, DWORD)
+{
+	// Only FILE_BEGIN is supported.
+	const off_t position = lseek(HostPlatform::GetDescriptor(file), static_cast<off_t>(distance.QuadPart), SEEK_SET);
+
+	if (newPosition)
+	{
+		newPosition->QuadPart = position;
+	}
+
+	return position >= 0;
+}
+
+inline BOOL SetEndOfFile(HANDLE file)
+{
+	const int fd = HostPlatform::GetDescriptor(file);
+	const off_t position = lseek(fd, 0, SEEK_CUR);
+
+	return position >= 0 && ftruncate(fd, position) == 0;
+}
+
+inline HANDLE CreateFileMappingW(HANDLE file, void*, DWORD, DWORD maximumSizeHigh, DWORD maximumSizeLow, const wchar_t*)
+{
+	const int fd = HostPlatform::GetDescriptor(file);
+	const off_t size = static_cast<off_t>((static_cast<uint64_t>(maximumSizeHigh) << 32) | maximumSizeLow);
+
+	// Like Windows, a mapping that is larger than the file extends the file.
+	struct stat status{};
+
+	if (fstat(fd, &status) != 0 || (status.st_size < size && ftruncate(fd, size) != 0))
+	{
+		return nullptr;
+	}
+
+	return new HostPlatform::Handle{ fd, false };
+}
+
+inline void* MapViewOfFile(HANDLE mapping, DWORD, DWORD fileOffsetHigh, DWORD fileOffsetLow, size_t numberOfBytesToMap)
+{
+	const off_t offset = static_cast<off_t>((static_cast<uint64_t>(fileOffsetHigh) << 32) | fileOffsetLow);
+
+	void* view = mmap(nullptr, numberOfBytesToMap, PROT_READ | PROT_WRITE, MAP_SHARED, HostPlatform::GetDescriptor(mapping), offset);
+
+	if (view == MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	std::unique_lock<std::mutex> lock;
+	HostPlatform::GetMappedViews(lock).emplace(view, numberOfBytesToMap);
+
+	return view;
+}
+
+inline BOOL UnmapViewOfFile(const void* baseAddress)
+{
+	size_t size = 0;
+
+	{
+		std::unique_lock<std::mutex> lock;
+		std::map<void*, size_t>& views = HostPlatform::GetMappedViews(lock);
+
+		const auto it = views.find(const_cast<void*>(baseAddress));
+
+		if (it == views.end())
+		{
+			return 0;
+		}
+
+		size = it->second;
+		views.erase(it);
+	}
+
+	return munmap(const_cast<void*>(baseAddress), size) == 0;
+}
+
+inline BOOL FlushViewOfFile(const void* baseAddress, size_t numberOfBytesToFlush)
+{
+	// Only the whole view can be flushed, the base address must be the start of the view.
+	if (numberOfBytesToFlush == 0)
+	{
+		numberOfBytesToFlush = HostPlatform::GetMappedViewSize(baseAddress);
+	}
+
+	return msync(const_cast<void*>(baseAddress), numberOfBytesToFlush, MS_ASYNC) == 0;
+}
@@ -0,0 +1,99 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+
+// The wil handle types that the plugin source files in the tools use.
+// This is only on the include path when the tools are built on other platforms.
+
+#pragma once
+#include <Windows.h>
+#include <utility>
+
+namespace wil
+{
+	template <HANDLE (*GetInvalidValue)()> class unique_any_handle
+	{
+	public:
+
+		unique_any_handle() : handle(GetInvalidValue())
+		{
+		}
+
+		explicit unique_any_handle(HANDLE handle) : handle(handle)
+		{
+		}
+
+		unique_any_handle(unique_any_handle&& other) noexcept : handle(other.release())
+		{
+		}
+
+		~unique_any_handle()
+		{
+			reset();
+		}
+
+		unique_any_handle(const unique_any_handle&) = delete;
+		unique_any_handle& operator=(const unique_any_handle&) = delete;
+
+		unique_any_handle& operator=(unique_any_handle&& other) noexcept
+		{
+			reset(other.release());
+			return *this;
+		}
+
+		void reset(HANDLE newHandle = GetInvalidValue())
+		{
+			if (handle != GetInvalidValue())
+			{
+				CloseHandle(handle);
+			}
+
+			handle = newHandle;
+		}
+
+		HANDLE release()
+		{
+			return std::exchange(handle, GetInvalidValue());
+		}
+
+		HANDLE get() const
+		{
+			return handle;
+		}
+
+		explicit operator bool() const
+		{
+			return handle != GetInvalidValue();
+		}
+
+	private:
+
+		HANDLE handle;
+	};
+
+	namespace details
+	{
+		inline HANDLE GetInvalidFileHandle()
+		{
+			return INVALID_HANDLE_VALUE;
+		}
+
+		inline HANDLE GetNullHandle()
+		{
+			return nullptr;
+		}
+	}
+
+	using unique_hfile = unique_any_handle<&details::GetInvalidFileHandle>;
+	using unique_handle = unique_any_handle<&details::GetNullHandle>;
+}
@@ -0,0 +1,287 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "InputFiles.h"
+#include "GamblingIncomeModel.h"
+#include "IniParser.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace
+{
+	constexpr size_t CensusGroupCount = static_cast<size_t>(CensusGroup::Count);
+
+	constexpr std::string_view IncomeSettingsSection = "GamblingOrdinance";
+	constexpr std::string_view RequiredIncomeKeys[] =
+	{
+		"BaseMonthlyIncome",
+		"R$IncomeFactor",
+		"R$$IncomeFactor",
+		"R$$$IncomeFactor",
+	};
+
+	[[noreturn]] void ThrowInvalidValue(const IniEntry& entry, const char* const requirement)
+	{
+		const std::string message = std::string(entry.key) + " " + requirement;
+
+		throw IniParseError(entry.line, entry.valueColumn, message.c_str());
+	}
+
+	float ReadIncomeFactor(const IniEntry& entry)
+	{
+		float value = 0.0f;
+
+		if (!IniParser::TryParseFloat(entry.value, value))
+		{
+			ThrowInvalidValue(entry, "must be a number.");
+		}
+		else if (!GamblingIncomeModel::IsValidIncomeFactor(value))
+		{
+			char requirement[128]{};
+			std::snprintf(requirement, sizeof(requirement), "must be in the range of [0, %g].", GamblingIncomeModel::MaxIncomeFactor);
+
+			ThrowInvalidValue(entry, requirement);
+		}
+
+		return value;
+	}
+
+	struct IncomeSettingsLoadContext
+	{
+		IncomeSettings settings{};
+		uint32_t loadedKeys = 0;
+	};
+
+	void OnSettingsEntry(const IniEntry& entry, void* context)
+	{
+		IncomeSettingsLoadContext* loadContext = static_cast<IncomeSettingsLoadContext*>(context);
+		IncomeSettings* settings = &loadContext->settings;
+
+		if (entry.section != IncomeSettingsSection)
+		{
+			return;
+		}
+
+		// The other keys in the section are only used by the plugin, they are validated when
+		// the game loads the settings file.
+		if (entry.key == RequiredIncomeKeys[0])
+		{
+			if (!IniParser::TryParseInt64(entry.value, settings->baseMonthlyIncome))
+			{
+				ThrowInvalidValue(entry, "must be an integer.");
+			}
+			else if (!GamblingIncomeModel::IsValidBaseMonthlyIncome(settings->baseMonthlyIncome))
+			{
+				const std::string requirement = "must be in the range of ["
+					+ std::to_string(-GamblingIncomeModel::MaxBaseMonthlyIncome)
+					+ ", "
+					+ std::to_string(GamblingIncomeModel::MaxBaseMonthlyIncome)
+					+ "].";
+
+				ThrowInvalidValue(entry, requirement.c_str());
+			}
+			loadContext->loadedKeys |= 1U << 0;
+		}
+		else if (entry.key == RequiredIncomeKeys[1])
+		{
+			settings->residentialLowWealthFactor = ReadIncomeFactor(entry);
+			loadContext->loadedKeys |= 1U << 1;
+		}
+		else if (entry.key == RequiredIncomeKeys[2])
+		{
+			settings->residentialMedWealthFactor = ReadIncomeFactor(entry);
+			loadContext->loadedKeys |= 1U << 2;
+		}
+		else if (entry.key == RequiredIncomeKeys[3])
+		{
+			settings->residentialHighWealthFactor = ReadIncomeFactor(entry);
+			loadContext->loadedKeys |= 1U << 3;
+		}
+		else if (entry.key == "IncomeFormula")
+		{
+			try
+			{
+				settings->monthlyIncomeFormula = IncomeFormula::Compile(entry.value);
+			}
+			catch (const IncomeFormulaError& e)
+			{
+				const std::string message = std::string(entry.key) + " is not valid: " + e.what();
+
+				throw IniParseError(entry.line, entry.valueColumn + static_cast<uint32_t>(e.Offset()), message.c_str());
+			}
+		}
+	}
+
+	std::string_view TrimWhiteSpace(std::string_view value)
+	{
+		while (!value.empty() && (value.front() == ' ' || value.front() == '\t' || value.front() == '\r'))
+		{
+			value.remove_prefix(1);
+		}
+
+		while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r'))
+		{
+			value.remove_suffix(1);
+		}
+
+		return value;
+	}
+
+	// Returns false if a column is not a number, the column count is 0 if the line is empty.
+	bool ParseCsvLine(std::string_view line, CensusValues& values, size_t& columnCount)
+	{
+		values.fill(0.0f);
+		columnCount = 0;
+
+		line = TrimWhiteSpace(line);
+
+		if (line.empty() || line.front() == '#')
+		{
+			return true;
+		}
+
+		while (true)
+		{
+			const size_t separator = line.find(',');
+			const std::string_view column = TrimWhiteSpace(line.substr(0, separator));
+
+			if (columnCount == CensusGroupCount || !IniParser::TryParseFloat(column, values[columnCount]))
+			{
+				return false;
+			}
+
+			columnCount++;
+
+			if (separator == std::string_view::npos)
+			{
+				break;
+			}
+
+			line.remove_prefix(separator + 1);
+		}
+
+		return true;
+	}
+
+	std::vector<CensusValues> ReadCsvCensusHistory(std::string_view text)
+	{
+		std::vector<CensusValues> months;
+		uint32_t lineNumber = 0;
+		bool firstLine = true;
+
+		while (!text.empty())
+		{
+			const size_t lineEnd = text.find('\n');
+			const std::string_view line = text.substr(0, lineEnd);
+			text.remove_prefix(lineEnd == std::string_view::npos ? text.size() : lineEnd + 1);
+			lineNumber++;
+
+			CensusValues values{};
+			size_t columnCount = 0;
+
+			const bool valid = ParseCsvLine(line, values, columnCount);
+
+			if (!valid && firstLine)
+			{
+				// The header line.
+				firstLine = false;
+				continue;
+			}
+			else if (!valid)
+			{
+				throw std::runtime_error("Line " + std::to_string(lineNumber) + " has a value that is not a number.");
+			}
+
+			if (columnCount == 0)
+			{
+				continue;
+			}
+
+			firstLine = false;
+
+			if (columnCount != 3 && columnCount != CensusGroupCount)
+			{
+				throw std::runtime_error(
+					"Line " + std::to_string(lineNumber) + " must have 3 or " + std::to_string(CensusGroupCount) + " columns.");
+			}
+
+			months.push_back(values);
+		}
+
+		return months;
+	}
+
+	std::vector<CensusValues> ReadBinaryCensusHistory(std::string_view data)
+	{
+		constexpr size_t MonthSize = sizeof(float) * CensusGroupCount;
+
+		static_assert(sizeof(CensusValues) == MonthSize);
+
+		if ((data.size() % MonthSize) != 0)
+		{
+			throw std::runtime_error("The binary file size is not a multiple of " + std::to_string(MonthSize) + " bytes.");
+		}
+
+		std::vector<CensusValues> months(data.size() / MonthSize);
+
+		if (!months.empty())
+		{
+			std::memcpy(months.data(), data.data(), data.size());
+		}
+
+		return months;
+	}
+}
+
+std::string InputFiles::ReadAllText(const std::filesystem::path& path)
+{
+	std::ifstream input(path, std::ifstream::in | std::ifstream::binary);
+
+	if (!input)
+	{
+		throw std::runtime_error("Failed to open " + path.string());
+	}
+
+	return std::string((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+}
+
+IncomeSettings InputFiles::ReadIncomeSettings(const std::filesystem::path& path)
+{
+	const std::string text = ReadAllText(path);
+
+	IncomeSettingsLoadContext context{};
+	IniParser::Parse(text, &OnSettingsEntry, &context);
+
+	for (size_t i = 0; i < std::size(RequiredIncomeKeys); i++)
+	{
+		if ((context.loadedKeys & (1U << i)) == 0)
+		{
+			throw std::runtime_error(
+				"The required setting GamblingOrdinance." + std::string(RequiredIncomeKeys[i]) + " is missing.");
+		}
+	}
+
+	return context.settings;
+}
+
+std::vector<CensusValues> InputFiles::ReadCensusHistory(const std::filesystem::path& path)
+{
+	const std::string data = ReadAllText(path);
+
+	return path.extension() == ".bin" ? ReadBinaryCensusHistory(data) : ReadCsvCensusHistory(data);
+}
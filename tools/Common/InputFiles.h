@@ -0,0 +1,54 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include "CensusSnapshot.h"
+#include "IncomeFormula.h"
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// The income settings from the [GamblingOrdinance] section of the plugin's INI file.
+struct IncomeSettings
+{
+	int64_t baseMonthlyIncome;
+	float residentialLowWealthFactor;
+	float residentialMedWealthFactor;
+	float residentialHighWealthFactor;
+	IncomeFormula monthlyIncomeFormula;
+};
+
+// Reads the input files of the host-side tools.
+// The functions throw an exception if a file cannot be read or it is not valid.
+namespace InputFiles
+{
+	std::string ReadAllText(const std::filesystem::path& path);
+
+	/**
+	 * @brief Reads the income settings from the plugin's INI file.
+	 * The other settings are ignored, they are validated when the game loads the file.
+	*/
+	IncomeSettings ReadIncomeSettings(const std::filesystem::path& path);
+
+	/**
+	 * @brief Reads the monthly census values of a CSV or binary census history file.
+	 *
+	 * In a CSV file each line is one month with either the R$, R$$ and R$$$ populations,
+	 * or all of the census groups in CensusGroup order. Empty lines, lines starting with #
+	 * and a header line are skipped.
+	 * Files with a .bin extension are binary, each month is all of the census groups stored
+	 * as little-endian 32-bit floats.
+	*/
+	std::vector<CensusValues> ReadCensusHistory(const std::filesystem::path& path);
+}
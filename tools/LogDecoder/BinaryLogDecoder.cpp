@@ -0,0 +1,352 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "BinaryLogDecoder.h"
+#include "BinaryLogFormat.h"
+#include "PrintfFormat.h"
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace BinaryLogFormat;
+
+namespace
+{
+	struct FormatDefinition
+	{
+		std::string format;
+		std::vector<PrintfArgumentType> argumentTypes;
+	};
+
+	class RecordReader
+	{
+	public:
+
+		RecordReader(const uint8_t* data, size_t size)
+			: data(data), size(size), position(0)
+		{
+		}
+
+		template <typename T>
+		T Read()
+		{
+			T value{};
+			ReadBytes(&value, sizeof(value));
+			return value;
+		}
+
+		void ReadBytes(void* buffer, size_t length)
+		{
+			if (length > Remaining())
+			{
+				throw std::runtime_error("Unexpected end of the log data.");
+			}
+
+			std::memcpy(buffer, data + position, length);
+			position += length;
+		}
+
+		std::string ReadString()
+		{
+			const uint16_t length = Read<uint16_t>();
+
+			if (length > Remaining())
+			{
+				throw std::runtime_error("Unexpected end of the log data.");
+			}
+
+			std::string value(reinterpret_cast<const char*>(data + position), length);
+			position += length;
+
+			return value;
+		}
+
+		size_t Remaining() const
+		{
+			return size - position;
+		}
+
+		size_t Position() const
+		{
+			return position;
+		}
+
+	private:
+
+		const uint8_t* data;
+		size_t size;
+		size_t position;
+	};
+
+	void AppendTimeStamp(std::string& line, uint64_t fileTime)
+	{
+		constexpr uint64_t FileTimeTicksPerSecond = 10000000;
+		constexpr uint64_t SecondsPerDay = 86400;
+
+		const uint64_t secondOfDay = (fileTime / FileTimeTicksPerSecond) % SecondsPerDay;
+
+		char buffer[32]{};
+
+		std::snprintf(
+			buffer,
+			sizeof(buffer),
+			"%02u:%02u:%02u ",
+			static_cast<unsigned int>(secondOfDay / 3600),
+			static_cast<unsigned int>((secondOfDay / 60) % 60),
+			static_cast<unsigned int>(secondOfDay % 60));
+
+		line.append(buffer);
+	}
+
+	// Formats a single conversion, the arguments are read from the record data.
+	void AppendConversion(
+		std::string& line,
+		std::string_view format,
+		const PrintfConversion& conversion,
+		const std::vector<PrintfArgumentType>& argumentTypes,
+		size_t& argumentIndex,
+		RecordReader& arguments)
+	{
+		std::string spec(format.substr(conversion.offset, conversion.prefixLength));
+
+		// Replace the '*' width and precision values with the recorded numbers.
+		for (uint8_t i = 0; i < conversion.starArgumentCount; i++)
+		{
+			const int32_t value = arguments.Read<int32_t>();
+			argumentIndex++;
+
+			const size_t starOffset = spec.find('*');
+
+			if (starOffset != std::string::npos)
+			{
+				spec.replace(starOffset, 1, std::to_string(value));
+			}
+		}
+
+		if (argumentIndex >= argumentTypes.size())
+		{
+			throw std::runtime_error("The format arguments do not match the format definition.");
+		}
+
+		const PrintfArgumentType type = argumentTypes[argumentIndex++];
+		const char specifier = conversion.specifier;
+
+		char buffer[512]{};
+
+		switch (type)
+		{
+		case PrintfArgumentType::Int32:
+		case PrintfArgumentType::Int64:
+		{
+			long long value = 0;
+
+			if (type == PrintfArgumentType::Int32)
+			{
+				const int32_t int32Value = arguments.Read<int32_t>();
+
+				value = PrintfFormat::IsSignedSpecifier(specifier) || specifier == 'c'
+					? static_cast<long long>(int32Value)
+					: static_cast<long long>(static_cast<uint32_t>(int32Value));
+			}
+			else
+			{
+				value = arguments.Read<int64_t>();
+			}
+
+			if (specifier == 'c')
+			{
+				spec.push_back('c');
+				std::snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<int>(value));
+			}
+			else
+			{
+				spec.append("ll");
+				spec.push_back(specifier);
+
+				if (PrintfFormat::IsSignedSpecifier(specifier))
+				{
+					std::snprintf(buffer, sizeof(buffer), spec.c_str(), value);
+				}
+				else
+				{
+					std::snprintf(buffer, sizeof(buffer), spec.c_str(), static_cast<unsigned long long>(value));
+				}
+			}
+			break;
+		}
+		case PrintfArgumentType::Float64:
+			spec.push_back(specifier);
+			std::snprintf(buffer, sizeof(buffer), spec.c_str(), arguments.Read<double>());
+			break;
+		case PrintfArgumentType::String:
+		{
+			const std::string value = arguments.ReadString();
+
+			spec.push_back('s');
+			std::snprintf(buffer, sizeof(buffer), spec.c_str(), value.c_str());
+			break;
+		}
+		case PrintfArgumentType::Pointer:
+		{
+			const uint64_t value = arguments.Read<uint64_t>();
+
+			// Use the same format as the Visual C++ runtime, which writes
+			// the pointer as upper case hexadecimal digits without a prefix.
+			if (value > 0xFFFFFFFF)
+			{
+				std::snprintf(buffer, sizeof(buffer), "%016llX", static_cast<unsigned long long>(value));
+			}
+			else
+			{
+				std::snprintf(buffer, sizeof(buffer), "%08llX", static_cast<unsigned long long>(value));
+			}
+			break;
+		}
+		default:
+			throw std::runtime_error("Unknown format argument type.");
+		}
+
+		line.append(buffer);
+	}
+
+	std::string FormatMessage(const FormatDefinition& definition, RecordReader& arguments)
+	{
+		std::string line;
+		const std::string_view format(definition.format);
+
+		size_t argumentIndex = 0;
+		size_t literalStart = 0;
+		PrintfConversion conversion{};
+
+		while (PrintfFormat::FindNextConversion(format, literalStart, conversion))
+		{
+			line.append(format.substr(literalStart, conversion.offset - literalStart));
+
+			if (conversion.specifier == '%')
+			{
+				line.push_back('%');
+			}
+			else if (conversion.argumentType == PrintfArgumentType::None)
+			{
+				// Unsupported conversions are copied to the output.
+				line.append(format.substr(conversion.offset, conversion.length));
+			}
+			else
+			{
+				AppendConversion(line, format, conversion, definition.argumentTypes, argumentIndex, arguments);
+			}
+
+			literalStart = conversion.offset + conversion.length;
+		}
+
+		line.append(format.substr(literalStart));
+
+		return line;
+	}
+}
+
+void BinaryLogDecoder::Decode(const std::vector<uint8_t>& data, std::ostream& output)
+{
+	RecordReader reader(data.data(), data.size());
+
+	char signature[sizeof(Signature)]{};
+	reader.ReadBytes(signature, sizeof(signature));
+
+	if (std::memcmp(signature, Signature, sizeof(Signature)) != 0)
+	{
+		throw std::runtime_error("The file is not a binary SC4LegalizeGamblingUpgrade log.");
+	}
+
+	const uint32_t version = reader.Read<uint32_t>();
+
+	if (version != Version)
+	{
+		throw std::runtime_error("Unsupported binary log version: " + std::to_string(version));
+	}
+
+	std::unordered_map<uint16_t, FormatDefinition> formats;
+
+	while (reader.Remaining() > 0)
+	{
+		const RecordType type = reader.Read<RecordType>();
+
+		if (static_cast<uint8_t>(type) == 0)
+		{
+			// The log file is extended in blocks while it is written, if the game did not
+			// shut down normally the end of the file is zero-filled instead of being trimmed.
+			break;
+		}
+
+		switch (type)
+		{
+		case RecordType::FormatDefinition:
+		{
+			const uint16_t id = reader.Read<uint16_t>();
+
+			FormatDefinition definition;
+			definition.format = reader.ReadString();
+
+			const uint8_t argumentCount = reader.Read<uint8_t>();
+			definition.argumentTypes.resize(argumentCount);
+			reader.ReadBytes(definition.argumentTypes.data(), argumentCount);
+
+			formats.insert_or_assign(id, std::move(definition));
+			break;
+		}
+		case RecordType::FormattedMessage:
+		{
+			const uint64_t timeStamp = reader.Read<uint64_t>();
+			const uint16_t id = reader.Read<uint16_t>();
+			const uint16_t argumentDataLength = reader.Read<uint16_t>();
+
+			std::vector<uint8_t> argumentData(argumentDataLength);
+			reader.ReadBytes(argumentData.data(), argumentData.size());
+
+			const auto definition = formats.find(id);
+
+			if (definition == formats.end())
+			{
+				throw std::runtime_error("A message uses an undefined format id: " + std::to_string(id));
+			}
+
+			RecordReader arguments(argumentData.data(), argumentData.size());
+
+			std::string line;
+			AppendTimeStamp(line, timeStamp);
+			line.append(FormatMessage(definition->second, arguments));
+
+			output << line << '\n';
+			break;
+		}
+		case RecordType::Message:
+		{
+			const uint64_t timeStamp = reader.Read<uint64_t>();
+
+			std::string line;
+			AppendTimeStamp(line, timeStamp);
+			line.append(reader.ReadString());
+
+			output << line << '\n';
+			break;
+		}
+		case RecordType::Header:
+			output << reader.ReadString() << '\n';
+			break;
+		default:
+			throw std::runtime_error("Unknown record type at offset " + std::to_string(reader.Position() - 1));
+		}
+	}
+}
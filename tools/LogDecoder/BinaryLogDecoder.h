@@ -0,0 +1,28 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace BinaryLogDecoder
+{
+	/**
+	 * @brief Converts the contents of a binary log file to text.
+	 * @param data The binary log file data.
+	 * @param output The stream that receives the text, one line per record.
+	 * @throws std::runtime_error The data is not a valid binary log.
+	*/
+	void Decode(const std::vector<uint8_t>& data, std::ostream& output);
+}
@@ -0,0 +1,68 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Converts a binary SC4LegalizeGamblingUpgrade.log file to text.
+//
+// Usage: SC4LegalizeGamblingUpgradeLogDecoder <binary log> [output file]
+// The text is written to the standard output if an output file is not specified.
+
+#include "BinaryLogDecoder.h"
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+int main(int argc, char** argv)
+{
+	if (argc < 2 || argc > 3)
+	{
+		std::cerr << "Usage: SC4LegalizeGamblingUpgradeLogDecoder <binary log> [output file]" << std::endl;
+		return 1;
+	}
+
+	try
+	{
+		std::ifstream input(argv[1], std::ifstream::in | std::ifstream::binary);
+
+		if (!input)
+		{
+			throw std::runtime_error("Failed to open the binary log file.");
+		}
+
+		const std::vector<uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+		if (argc == 3)
+		{
+			std::ofstream output(argv[2], std::ofstream::out | std::ofstream::trunc);
+
+			if (!output)
+			{
+				throw std::runtime_error("Failed to create the output file.");
+			}
+
+			BinaryLogDecoder::Decode(data, output);
+		}
+		else
+		{
+			BinaryLogDecoder::Decode(data, std::cout);
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
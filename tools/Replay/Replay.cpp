@@ -0,0 +1,180 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Replays monthly census snapshots through the Legalize Gambling ordinance income model.
+//
+// Usage: SC4LegalizeGamblingUpgradeReplay <settings file> <scenario file>...
+//
+// The income settings are read from the [GamblingOrdinance] section of the plugin's INI file.
+// Each scenario is written to <scenario file>.income.csv with the month, monthly income and
+// cumulative income columns, and a summary line is written to the standard output.
+// The scenarios are replayed in parallel, one per hardware thread.
+//
+// A scenario file is a CSV or binary census history, see InputFiles::ReadCensusHistory.
+// The CSV columns are the R$, R$$ and R$$$ populations, or all of the census groups in the order
+// of the IncomeFormula variables (R$, R$$, R$$$, Cs$, Cs$$, Cs$$$, Co$$, Co$$$, IR, ID, IM, IHT).
+
+#include "GamblingIncomeModel.h"
+#include "InputFiles.h"
+#include "Money.h"
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct ScenarioResult
+	{
+		size_t monthCount = 0;
+		int64_t cumulativeIncome = 0;
+		std::string error;
+	};
+
+	ScenarioResult ReplayScenario(const GamblingIncomeModel& model, const std::filesystem::path& scenarioPath)
+	{
+		ScenarioResult result;
+
+		try
+		{
+			const std::vector<CensusValues> months = InputFiles::ReadCensusHistory(scenarioPath);
+
+			std::string output;
+			output.reserve(32 + (months.size() * 48));
+			output.append("month,income,cumulative_income\n");
+
+			char buffer[128]{};
+
+			for (size_t i = 0; i < months.size(); i++)
+			{
+				const int64_t monthlyIncome = model.Calculate(months[i]).totalIncome;
+
+				result.cumulativeIncome = SaturatingArithmetic::Add(result.cumulativeIncome, monthlyIncome);
+
+				const int length = std::snprintf(
+					buffer,
+					sizeof(buffer),
+					"%zu,%lld,%lld\n",
+					i + 1,
+					static_cast<long long>(monthlyIncome),
+					static_cast<long long>(result.cumulativeIncome));
+				output.append(buffer, static_cast<size_t>(length));
+			}
+
+			result.monthCount = months.size();
+
+			std::filesystem::path outputPath = scenarioPath;
+			outputPath += ".income.csv";
+
+			std::ofstream stream(outputPath, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+			stream.write(output.data(), static_cast<std::streamsize>(output.size()));
+
+			if (!stream)
+			{
+				throw std::runtime_error("Failed to write " + outputPath.string());
+			}
+		}
+		catch (const std::exception& e)
+		{
+			result.error = e.what();
+		}
+
+		return result;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 3)
+	{
+		std::cerr << "Usage: SC4LegalizeGamblingUpgradeReplay <settings file> <scenario file>..." << std::endl;
+		return 1;
+	}
+
+	GamblingIncomeModel model;
+
+	try
+	{
+		const IncomeSettings settings = InputFiles::ReadIncomeSettings(argv[1]);
+
+		model.SetParameters(
+			settings.baseMonthlyIncome,
+			settings.residentialLowWealthFactor,
+			settings.residentialMedWealthFactor,
+			settings.residentialHighWealthFactor,
+			settings.monthlyIncomeFormula);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << argv[1] << ": " << e.what() << std::endl;
+		return 1;
+	}
+
+	const std::vector<std::filesystem::path> scenarios(argv + 2, argv + argc);
+	std::vector<ScenarioResult> results(scenarios.size());
+
+	// The scenarios are independent, each worker takes the next scenario until all of them are done.
+	const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	const size_t workerCount = hardwareThreads == 0 ? 1 : (hardwareThreads < scenarios.size() ? hardwareThreads : scenarios.size());
+
+	std::atomic<size_t> nextScenario = 0;
+	std::vector<std::thread> workers;
+	workers.reserve(workerCount);
+
+	for (size_t i = 0; i < workerCount; i++)
+	{
+		workers.emplace_back([&]()
+		{
+			size_t index = nextScenario.fetch_add(1, std::memory_order_relaxed);
+
+			while (index < scenarios.size())
+			{
+				results[index] = ReplayScenario(model, scenarios[index]);
+				index = nextScenario.fetch_add(1, std::memory_order_relaxed);
+			}
+		});
+	}
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	int exitCode = 0;
+
+	for (size_t i = 0; i < scenarios.size(); i++)
+	{
+		const ScenarioResult& result = results[i];
+
+		if (result.error.empty())
+		{
+			std::cout << scenarios[i].string()
+				<< ": months=" << result.monthCount
+				<< ", cumulative income=" << result.cumulativeIncome
+				<< std::endl;
+		}
+		else
+		{
+			std::cerr << scenarios[i].string() << ": " << result.error << std::endl;
+			exitCode = 1;
+		}
+	}
+
+	return exitCode;
+}
@@ -0,0 +1,170 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Encodes formatted messages with the plugin's BinaryLogEncoder, decodes the log with
+// the LogDecoder and checks that the text matches the output of vsnprintf.
+
+#include "BinaryLogDecoder.h"
+#include "BinaryLogEncoder.h"
+#include <cstdarg>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	class BinaryLogBuilder
+	{
+	public:
+
+		BinaryLogBuilder()
+		{
+			BinaryLogEncoder::RecordBuffer record;
+
+			Append(record.data(), BinaryLogEncoder::EncodeFileHeader(record));
+		}
+
+		// Writes a message in the same way as Logger::WriteBinaryFormatted,
+		// the expected text is formatted with vsnprintf.
+		bool WriteFormatted(const char* const format, ...)
+		{
+			va_list args;
+			va_start(args, format);
+
+			va_list argsCopy;
+			va_copy(argsCopy, args);
+
+			char message[BinaryLogFormat::MaxRecordSize]{};
+			std::vsnprintf(message, sizeof(message), format, argsCopy);
+			expectedLines.push_back(message);
+
+			va_end(argsCopy);
+
+			BinaryLogEncoder::RecordBuffer record;
+
+			size_t recordSize = encoder.EncodeFormattedMessage(format, args, record, &AppendCallback, this);
+			const bool encodedArguments = recordSize != 0;
+
+			if (!encodedArguments)
+			{
+				recordSize = BinaryLogEncoder::EncodeMessage(message, record);
+			}
+
+			Append(record.data(), recordSize);
+
+			va_end(args);
+
+			return encodedArguments;
+		}
+
+		const std::vector<uint8_t>& Data() const
+		{
+			return data;
+		}
+
+		const std::vector<std::string>& ExpectedLines() const
+		{
+			return expectedLines;
+		}
+
+	private:
+
+		void Append(const uint8_t* record, size_t size)
+		{
+			data.insert(data.end(), record, record + size);
+		}
+
+		static void AppendCallback(const uint8_t* record, size_t size, void* context)
+		{
+			static_cast<BinaryLogBuilder*>(context)->Append(record, size);
+		}
+
+		BinaryLogEncoder encoder;
+		std::vector<uint8_t> data;
+		std::vector<std::string> expectedLines;
+	};
+
+	int failureCount = 0;
+
+	void Check(bool condition, const char* const description)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << description << std::endl;
+			failureCount++;
+		}
+	}
+}
+
+int main()
+{
+	BinaryLogBuilder log;
+
+	Check(log.WriteFormatted("plain %d items", 42), "an int argument is encoded");
+	Check(log.WriteFormatted("%s: income=%lld, factor=%f", "Test", 123456789012LL, 1.5), "string, int64 and double arguments are encoded");
+	Check(log.WriteFormatted("%5.2f%% of %u", 3.14159, 4000000000U), "an escaped percent sign is encoded");
+	Check(log.WriteFormatted("%*d|%-*s|", 6, 42, 4, "ab"), "star width arguments are encoded");
+	Check(log.WriteFormatted("%x %X %c", 0xbeef, 0xBEEF, 'A'), "hexadecimal and character arguments are encoded");
+
+	// The arguments after an unsupported conversion cannot be located, so the message
+	// must be formatted before it is written.
+	Check(!log.WriteFormatted("%S and %d", L"wide", 7), "a format with an unsupported conversion is formatted as text");
+	Check(!log.WriteFormatted("%S and %d", L"again", 8), "an unsupported format stays unsupported when it is reused");
+
+	Check(log.WriteFormatted("plain %d items", -1), "a format definition is reused");
+
+	std::ostringstream output;
+
+	try
+	{
+		BinaryLogDecoder::Decode(log.Data(), output);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "FAILED: the log could not be decoded: " << e.what() << std::endl;
+		return 1;
+	}
+
+	std::istringstream decoded(output.str());
+	const std::vector<std::string>& expectedLines = log.ExpectedLines();
+
+	// Every message line starts with a "HH:MM:SS " time stamp.
+	constexpr size_t TimeStampLength = 9;
+
+	std::string line;
+	size_t lineIndex = 0;
+
+	while (std::getline(decoded, line))
+	{
+		if (lineIndex >= expectedLines.size())
+		{
+			std::cerr << "FAILED: unexpected line: " << line << std::endl;
+			failureCount++;
+			continue;
+		}
+
+		const std::string& expected = expectedLines[lineIndex++];
+
+		if (line.size() < TimeStampLength || line.substr(TimeStampLength) != expected)
+		{
+			std::cerr << "FAILED: expected '" << expected << "', decoded '" << line << "'" << std::endl;
+			failureCount++;
+		}
+	}
+
+	Check(lineIndex == expectedLines.size(), "every message is decoded");
+
+	return failureCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Checks the value conversions and error positions of the settings file parser.
+
+#include "IniParser.h"
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+	int failureCount = 0;
+
+	void Check(bool condition, const char* const description)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << description << std::endl;
+			failureCount++;
+		}
+	}
+
+	bool IsFloat(std::string_view text, float expected)
+	{
+		float value = 0.0f;
+
+		return IniParser::TryParseFloat(text, value) && value == expected;
+	}
+
+	bool IsRejectedFloat(std::string_view text)
+	{
+		float value = 123.0f;
+
+		return !IniParser::TryParseFloat(text, value) && value == 123.0f;
+	}
+
+	void IgnoreEntry(const IniEntry&, void*)
+	{
+	}
+}
+
+int main()
+{
+	Check(IsFloat("0.05", 0.05f), "a decimal number is parsed");
+	Check(IsFloat("+2", 2.0f), "a leading plus sign is accepted");
+	Check(IsFloat("1e-3", 0.001f), "an exponent is accepted");
+
+	// NaN passes every range check, so the non-finite values must be rejected by the parser.
+	Check(IsRejectedFloat("nan"), "nan is rejected");
+	Check(IsRejectedFloat("NAN"), "NAN is rejected");
+	Check(IsRejectedFloat("inf"), "inf is rejected");
+	Check(IsRejectedFloat("-infinity"), "-infinity is rejected");
+	Check(IsRejectedFloat("1e39"), "a value outside the float range is rejected");
+	Check(IsRejectedFloat("0.5x"), "trailing characters are rejected");
+
+	int64_t int64Value = 0;
+	Check(IniParser::TryParseInt64("-100", int64Value) && int64Value == -100, "a negative integer is parsed");
+	Check(!IniParser::TryParseInt64("1.5", int64Value), "a decimal number is not an integer");
+
+	try
+	{
+		IniParser::Parse("[Section]\nKey=1\n[Unterminated\n", &IgnoreEntry, nullptr);
+		Check(false, "an unterminated section name is an error");
+	}
+	catch (const IniParseError& e)
+	{
+		Check(e.Line() == 3, "the error is reported on the line of the section name");
+	}
+
+	return failureCount == 0 ? 0 : 1;
+}
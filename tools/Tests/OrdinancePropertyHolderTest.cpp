@@ -0,0 +1,152 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Checks the array spans that are returned by OrdinancePropertyHolder.
+//
+// The short arrays are stored inside the properties, so a span is only valid until
+// the holder is modified. These tests add properties after a span is taken and verify
+// that the values that are looked up again are intact, and that modifying a copy
+// of a holder does not move the properties of the holder it was copied from.
+
+#include "OrdinancePropertyHolder.h"
+#include "cRZBaseVariant.h"
+#include <iostream>
+#include <span>
+
+namespace
+{
+	// The IDs are not in OrdinancePropertySchema, so the holder stores them as-is.
+	constexpr uint32_t FloatArrayPropertyId = 0x70000100;
+	constexpr uint32_t SintArrayPropertyId = 0x70000200;
+	// The filler IDs are 0x70000008, 0x70000018, ..., 0x700003f8.
+	constexpr uint32_t FillerPropertyBaseId = 0x70000008;
+	constexpr uint32_t FillerPropertyCount = 64;
+
+	// The arrays fit in the 64 byte inline storage of the variant.
+	constexpr uint32_t ArrayCount = 16;
+
+	int failureCount = 0;
+
+	void Check(bool condition, const char* const description)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << description << std::endl;
+			failureCount++;
+		}
+	}
+
+	template <typename T> bool HasValues(std::span<const T> values, T firstValue)
+	{
+		if (values.size() != ArrayCount)
+		{
+			return false;
+		}
+
+		for (uint32_t i = 0; i < ArrayCount; i++)
+		{
+			if (values[i] != firstValue + static_cast<T>(i))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void AddArrayProperties(OrdinancePropertyHolder& holder)
+	{
+		float floatValues[ArrayCount]{};
+		int32_t sintValues[ArrayCount]{};
+
+		for (uint32_t i = 0; i < ArrayCount; i++)
+		{
+			floatValues[i] = 1.0f + static_cast<float>(i);
+			sintValues[i] = 100 + static_cast<int32_t>(i);
+		}
+
+		cRZBaseVariant floatArray;
+		floatArray.RefFloat32(floatValues, ArrayCount);
+		holder.AddProperty(FloatArrayPropertyId, &floatArray, false);
+
+		cRZBaseVariant sintArray;
+		sintArray.RefSint32(sintValues, ArrayCount);
+		holder.AddProperty(SintArrayPropertyId, &sintArray, false);
+	}
+
+	void AddFillerProperties(OrdinancePropertyHolder& holder)
+	{
+		// The IDs are on both sides of the array properties, the list is
+		// reallocated and the array properties are shifted several times.
+		for (uint32_t i = 0; i < FillerPropertyCount; i++)
+		{
+			holder.AddProperty(FillerPropertyBaseId + (i * 0x10), i, false);
+		}
+	}
+
+	void CheckInsertAfterSpan()
+	{
+		OrdinancePropertyHolder holder;
+		AddArrayProperties(holder);
+
+		const std::span<const float> floatValues = holder.GetFloat32Array(FloatArrayPropertyId);
+		const std::span<const int32_t> sintValues = holder.GetSint32Array(SintArrayPropertyId);
+
+		Check(HasValues(floatValues, 1.0f), "the float32 array span has the property values");
+		Check(HasValues(sintValues, 100), "the int32 array span has the property values");
+
+		AddFillerProperties(holder);
+
+		// The spans that were taken before the properties were added may have been invalidated,
+		// the values are looked up again.
+		Check(HasValues(holder.GetFloat32Array(FloatArrayPropertyId), 1.0f), "the float32 array keeps its values when properties are added");
+		Check(HasValues(holder.GetSint32Array(SintArrayPropertyId), 100), "the int32 array keeps its values when properties are added");
+
+		holder.RemoveProperty(FillerPropertyBaseId);
+		holder.CompactProperties();
+
+		Check(HasValues(holder.GetFloat32Array(FloatArrayPropertyId), 1.0f), "the float32 array keeps its values when a property is removed");
+		Check(HasValues(holder.GetSint32Array(SintArrayPropertyId), 100), "the int32 array keeps its values when a property is removed");
+	}
+
+	void CheckInsertIntoCopy()
+	{
+		OrdinancePropertyHolder holder;
+		AddArrayProperties(holder);
+
+		const std::span<const float> floatValues = holder.GetFloat32Array(FloatArrayPropertyId);
+		const std::span<const int32_t> sintValues = holder.GetSint32Array(SintArrayPropertyId);
+
+		OrdinancePropertyHolder copy(holder);
+		Check(copy.GetFloat32Array(FloatArrayPropertyId).data() == floatValues.data(), "a copy shares the property list");
+
+		AddFillerProperties(copy);
+
+		// The copy has its own list after it is modified, the spans of the source holder are still valid.
+		Check(holder.GetFloat32Array(FloatArrayPropertyId).data() == floatValues.data(), "modifying a copy does not move the float32 array");
+		Check(holder.GetSint32Array(SintArrayPropertyId).data() == sintValues.data(), "modifying a copy does not move the int32 array");
+		Check(HasValues(floatValues, 1.0f), "modifying a copy keeps the float32 array span values");
+		Check(HasValues(sintValues, 100), "modifying a copy keeps the int32 array span values");
+
+		Check(HasValues(copy.GetFloat32Array(FloatArrayPropertyId), 1.0f), "the modified copy has the float32 array values");
+		Check(copy.GetFloat32Array(FloatArrayPropertyId).data() != floatValues.data(), "the modified copy has its own float32 array");
+	}
+}
+
+int main()
+{
+	CheckInsertAfterSpan();
+	CheckInsertIntoCopy();
+
+	return failureCount == 0 ? 0 : 1;
+}
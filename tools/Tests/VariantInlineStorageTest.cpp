@@ -0,0 +1,367 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Checks the inline storage of the short cRZBaseVariant arrays.
+//
+// The global allocation functions are replaced with versions that count the allocations,
+// this verifies that the arrays that fit in the inline storage never use the heap.
+
+#include "cRZBaseVariant.h"
+#include "cSCBaseProperty.h"
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace
+{
+	size_t allocationCount = 0;
+	size_t deallocationCount = 0;
+
+	void* CountedAllocate(size_t size)
+	{
+		allocationCount++;
+
+		void* ptr = std::malloc(size != 0 ? size : 1);
+
+		if (!ptr)
+		{
+			throw std::bad_alloc();
+		}
+
+		return ptr;
+	}
+
+	void CountedDeallocate(void* ptr) noexcept
+	{
+		if (ptr)
+		{
+			deallocationCount++;
+			std::free(ptr);
+		}
+	}
+}
+
+void* operator new(size_t size)
+{
+	return CountedAllocate(size);
+}
+
+void* operator new[](size_t size)
+{
+	return CountedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	CountedDeallocate(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	CountedDeallocate(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+	CountedDeallocate(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept
+{
+	CountedDeallocate(ptr);
+}
+
+namespace
+{
+	// The inline storage is 64 bytes, 16 float values.
+	constexpr uint32_t InlineFloatCount = 16;
+	constexpr uint32_t HeapFloatCount = InlineFloatCount + 1;
+
+	int failureCount = 0;
+
+	void Check(bool condition, const char* const description)
+	{
+		if (!condition)
+		{
+			std::cerr << "FAILED: " << description << std::endl;
+			failureCount++;
+		}
+	}
+
+	// Counts the allocations and deallocations that are made while the scope is active.
+	class AllocationScope
+	{
+	public:
+
+		AllocationScope()
+			: startAllocationCount(allocationCount),
+			  startDeallocationCount(deallocationCount)
+		{
+		}
+
+		size_t Allocations() const
+		{
+			return allocationCount - startAllocationCount;
+		}
+
+		size_t Deallocations() const
+		{
+			return deallocationCount - startDeallocationCount;
+		}
+
+	private:
+
+		size_t startAllocationCount;
+		size_t startDeallocationCount;
+	};
+
+	bool IsInline(const cRZBaseVariant& variant, const void* data)
+	{
+		const unsigned char* const begin = reinterpret_cast<const unsigned char*>(&variant);
+		const unsigned char* const end = begin + sizeof(cRZBaseVariant);
+		const unsigned char* const ptr = static_cast<const unsigned char*>(data);
+
+		return ptr >= begin && ptr < end;
+	}
+
+	void SetFloatArray(cRZBaseVariant& variant, uint32_t count, float firstValue)
+	{
+		float values[HeapFloatCount]{};
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			values[i] = firstValue + static_cast<float>(i);
+		}
+
+		variant.RefFloat32(values, count);
+	}
+
+	bool HasFloatArray(const cRZBaseVariant& variant, uint32_t count, float firstValue)
+	{
+		const float* const values = variant.RefFloat32();
+
+		if (variant.GetType() != cIGZVariant::Type::Float32Array || variant.GetCount() != count || !values)
+		{
+			return false;
+		}
+
+		for (uint32_t i = 0; i < count; i++)
+		{
+			if (values[i] != firstValue + static_cast<float>(i))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	void CheckStorageSize()
+	{
+		{
+			cRZBaseVariant variant;
+			AllocationScope allocations;
+
+			SetFloatArray(variant, InlineFloatCount, 1.0f);
+
+			Check(allocations.Allocations() == 0, "a 64 byte array does not allocate");
+			Check(IsInline(variant, variant.RefFloat32()), "a 64 byte array is stored inline");
+			Check(HasFloatArray(variant, InlineFloatCount, 1.0f), "a 64 byte array keeps its values");
+		}
+
+		{
+			cRZBaseVariant variant;
+			AllocationScope allocations;
+
+			SetFloatArray(variant, HeapFloatCount, 1.0f);
+
+			Check(allocations.Allocations() == 1, "a 68 byte array allocates once");
+			Check(!IsInline(variant, variant.RefFloat32()), "a 68 byte array is stored on the heap");
+			Check(HasFloatArray(variant, HeapFloatCount, 1.0f), "a 68 byte array keeps its values");
+		}
+
+		{
+			uint8_t bytes[65]{};
+			cRZBaseVariant variant;
+
+			AllocationScope allocations;
+			variant.RefUint8(bytes, 64);
+			Check(allocations.Allocations() == 0 && IsInline(variant, variant.RefUint8()), "a 64 element byte array is stored inline");
+
+			variant.RefUint8(bytes, 65);
+			Check(allocations.Allocations() == 1 && !IsInline(variant, variant.RefUint8()), "a 65 element byte array is stored on the heap");
+		}
+	}
+
+	void CheckCopy()
+	{
+		cRZBaseVariant inlineSource;
+		SetFloatArray(inlineSource, InlineFloatCount, 1.0f);
+
+		cRZBaseVariant heapSource;
+		SetFloatArray(heapSource, HeapFloatCount, 100.0f);
+
+		{
+			AllocationScope allocations;
+			cRZBaseVariant copy(inlineSource);
+
+			Check(allocations.Allocations() == 0, "copying an inline array does not allocate");
+			Check(IsInline(copy, copy.RefFloat32()), "the copy of an inline array uses its own inline storage");
+			Check(HasFloatArray(copy, InlineFloatCount, 1.0f), "the copy of an inline array has the same values");
+
+			copy.RefFloat32()[0] = -1.0f;
+			Check(HasFloatArray(inlineSource, InlineFloatCount, 1.0f), "changing the copy does not change the source");
+		}
+
+		{
+			AllocationScope allocations;
+			cRZBaseVariant copy(heapSource);
+
+			Check(allocations.Allocations() == 1, "copying a heap array allocates once");
+			Check(copy.RefFloat32() != heapSource.RefFloat32(), "the copy of a heap array has its own storage");
+			Check(HasFloatArray(copy, HeapFloatCount, 100.0f), "the copy of a heap array has the same values");
+		}
+
+		{
+			cRZBaseVariant target;
+			SetFloatArray(target, HeapFloatCount, 5.0f);
+
+			AllocationScope allocations;
+			target = inlineSource;
+
+			Check(allocations.Allocations() == 0 && allocations.Deallocations() == 1, "copying an inline array over a heap array frees the heap array");
+			Check(IsInline(target, target.RefFloat32()), "an inline array that is copied over a heap array is stored inline");
+			Check(HasFloatArray(target, InlineFloatCount, 1.0f), "an inline array that is copied over a heap array has the same values");
+		}
+
+		{
+			cRZBaseVariant target;
+			SetFloatArray(target, InlineFloatCount, 5.0f);
+
+			AllocationScope allocations;
+			target = heapSource;
+
+			Check(allocations.Allocations() == 1 && allocations.Deallocations() == 0, "copying a heap array over an inline array allocates once");
+			Check(HasFloatArray(target, HeapFloatCount, 100.0f), "a heap array that is copied over an inline array has the same values");
+		}
+	}
+
+	void CheckMove()
+	{
+		{
+			cRZBaseVariant source;
+			SetFloatArray(source, InlineFloatCount, 1.0f);
+
+			AllocationScope allocations;
+			cRZBaseVariant moved(std::move(source));
+
+			Check(allocations.Allocations() == 0, "moving an inline array does not allocate");
+			Check(IsInline(moved, moved.RefFloat32()), "a moved inline array uses the inline storage of the new variant");
+			Check(HasFloatArray(moved, InlineFloatCount, 1.0f), "a moved inline array keeps its values");
+			Check(source.GetType() == cIGZVariant::Type::Empty && !source.RefFloat32(), "the source of a move is empty");
+		}
+
+		{
+			cRZBaseVariant source;
+			SetFloatArray(source, HeapFloatCount, 1.0f);
+			const float* const heapValues = source.RefFloat32();
+
+			AllocationScope allocations;
+			cRZBaseVariant moved(std::move(source));
+
+			Check(allocations.Allocations() == 0, "moving a heap array does not allocate");
+			Check(moved.RefFloat32() == heapValues, "a moved heap array transfers its storage");
+			Check(source.GetType() == cIGZVariant::Type::Empty, "the source of a heap array move is empty");
+		}
+
+		{
+			cRZBaseVariant source;
+			SetFloatArray(source, InlineFloatCount, 1.0f);
+
+			cRZBaseVariant target;
+			SetFloatArray(target, HeapFloatCount, 5.0f);
+
+			AllocationScope allocations;
+			target = std::move(source);
+
+			Check(allocations.Allocations() == 0 && allocations.Deallocations() == 1, "move assigning an inline array over a heap array frees the heap array");
+			Check(IsInline(target, target.RefFloat32()), "an inline array that is move assigned is stored inline");
+			Check(HasFloatArray(target, InlineFloatCount, 1.0f), "an inline array that is move assigned keeps its values");
+		}
+
+		{
+			cRZBaseVariant source;
+			SetFloatArray(source, HeapFloatCount, 1.0f);
+			const float* const heapValues = source.RefFloat32();
+
+			cRZBaseVariant target;
+			SetFloatArray(target, InlineFloatCount, 5.0f);
+
+			AllocationScope allocations;
+			target = std::move(source);
+
+			Check(allocations.Allocations() == 0 && allocations.Deallocations() == 0, "move assigning a heap array over an inline array does not allocate");
+			Check(target.RefFloat32() == heapValues, "a heap array that is move assigned transfers its storage");
+		}
+
+		static_assert(std::is_nothrow_move_constructible_v<cRZBaseVariant>);
+		static_assert(std::is_nothrow_move_assignable_v<cRZBaseVariant>);
+	}
+
+	void CheckSelfAssignment()
+	{
+		for (uint32_t count : { InlineFloatCount, HeapFloatCount })
+		{
+			cRZBaseVariant variant;
+			SetFloatArray(variant, count, 1.0f);
+			const float* const values = variant.RefFloat32();
+
+			cRZBaseVariant& self = variant;
+
+			AllocationScope allocations;
+			variant = self;
+			variant = std::move(self);
+
+			Check(allocations.Allocations() == 0 && allocations.Deallocations() == 0, "self-assignment does not allocate");
+			Check(variant.RefFloat32() == values, "self-assignment keeps the storage");
+			Check(HasFloatArray(variant, count, 1.0f), "self-assignment keeps the values");
+		}
+	}
+
+	void CheckPropertyCopy()
+	{
+		float zoneTypeValues[InlineFloatCount]{};
+		cRZBaseVariant value;
+		value.RefFloat32(zoneTypeValues, InlineFloatCount);
+
+		const cSCBaseProperty property(0x8a67e373, value);
+
+		AllocationScope allocations;
+		const cSCBaseProperty copy(property);
+
+		Check(allocations.Allocations() == 0, "copying a zone type effect property does not allocate");
+	}
+}
+
+int main()
+{
+	CheckStorageSize();
+	CheckCopy();
+	CheckMove();
+	CheckSelfAssignment();
+	CheckPropertyCopy();
+
+	return failureCount == 0 ? 0 : 1;
+}
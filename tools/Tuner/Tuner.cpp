@@ -0,0 +1,549 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Searches for the income settings that best match a target income per capita curve.
+//
+// Usage: SC4LegalizeGamblingUpgradeTuner [options] <target curve> <census history>...
+//
+// Options:
+//   --base <min>:<max>:<steps>   The BaseMonthlyIncome values, the default is 0:1000:11.
+//   --low <min>:<max>:<steps>    The R$IncomeFactor values, the default is 0:0.1:21.
+//   --med <min>:<max>:<steps>    The R$$IncomeFactor values, the default is 0:0.1:21.
+//   --high <min>:<max>:<steps>   The R$$$IncomeFactor values, the default is 0:0.1:21.
+//   --random <count>             Tests <count> random points in the ranges instead of the grid.
+//   --seed <value>               The random search seed, the default is 1.
+//   --settings <file>            Uses the IncomeFormula from the plugin's INI file.
+//
+// The target curve is a CSV file with the residential population and the target monthly income
+// per resident on each line, the target is linearly interpolated between the points.
+// The census histories use the replay tool's format, see InputFiles::ReadCensusHistory.
+//
+// Every point is scored by the root mean square difference between its income per resident and
+// the target over all of the months, and the best point is written to the standard output as a
+// [GamblingOrdinance] section for the plugin's INI file.
+
+#include "GamblingIncomeModel.h"
+#include "InputFiles.h"
+#include "IniParser.h"
+#include "WorkStealingScheduler.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	struct ParameterRange
+	{
+		double min;
+		double max;
+		uint64_t steps;
+
+		double GetGridValue(uint64_t index) const
+		{
+			return steps > 1 ? min + ((max - min) * static_cast<double>(index) / static_cast<double>(steps - 1)) : min;
+		}
+
+		double GetRandomValue(double fraction) const
+		{
+			return min + ((max - min) * fraction);
+		}
+	};
+
+	struct TunerOptions
+	{
+		ParameterRange baseMonthlyIncome{ 0.0, 1000.0, 11 };
+		ParameterRange residentialLowWealthFactor{ 0.0, 0.1, 21 };
+		ParameterRange residentialMedWealthFactor{ 0.0, 0.1, 21 };
+		ParameterRange residentialHighWealthFactor{ 0.0, 0.1, 21 };
+		uint64_t randomPointCount = 0;
+		uint64_t seed = 1;
+		IncomeFormula monthlyIncomeFormula{};
+		std::string targetCurvePath;
+		std::vector<std::string> censusHistoryPaths;
+	};
+
+	struct IncomeParameters
+	{
+		int64_t baseMonthlyIncome;
+		float residentialLowWealthFactor;
+		float residentialMedWealthFactor;
+		float residentialHighWealthFactor;
+	};
+
+	// The months of all of the census histories that have a residential population.
+	// The target depends only on the population, so it is calculated once per month.
+	struct TuningMonths
+	{
+		std::vector<CensusValues> censusValues;
+		std::vector<double> inverseResidentialPopulation;
+		std::vector<double> targetIncomePerCapita;
+	};
+
+	struct SearchResult
+	{
+		double meanSquareError = std::numeric_limits<double>::infinity();
+		uint64_t pointIndex = std::numeric_limits<uint64_t>::max();
+
+		bool IsBetterThan(const SearchResult& other) const
+		{
+			// The point index breaks ties, so the result does not depend on the order
+			// in which the workers finish.
+			return meanSquareError < other.meanSquareError
+				|| (meanSquareError == other.meanSquareError && pointIndex < other.pointIndex);
+		}
+	};
+
+	bool TryParseDouble(std::string_view value, double& result)
+	{
+		float floatValue = 0.0f;
+
+		if (!IniParser::TryParseFloat(value, floatValue))
+		{
+			return false;
+		}
+
+		result = floatValue;
+		return true;
+	}
+
+	// The range must be within the limits of the setting, see GamblingIncomeModel.
+	ParameterRange ParseRange(std::string_view optionName, std::string_view value, double lowerLimit, double upperLimit)
+	{
+		const size_t firstSeparator = value.find(':');
+		const size_t secondSeparator = firstSeparator == std::string_view::npos ? std::string_view::npos : value.find(':', firstSeparator + 1);
+
+		ParameterRange range{};
+		int64_t steps = 0;
+
+		if (secondSeparator == std::string_view::npos
+			|| !TryParseDouble(value.substr(0, firstSeparator), range.min)
+			|| !TryParseDouble(value.substr(firstSeparator + 1, secondSeparator - firstSeparator - 1), range.max)
+			|| !IniParser::TryParseInt64(value.substr(secondSeparator + 1), steps)
+			|| steps < 1
+			|| range.max < range.min)
+		{
+			throw std::runtime_error(std::string(optionName) + " must be <min>:<max>:<steps>, with max >= min and steps >= 1.");
+		}
+
+		if (range.min < lowerLimit || range.max > upperLimit)
+		{
+			char limits[128]{};
+			std::snprintf(limits, sizeof(limits), "[%.15g, %.15g].", lowerLimit, upperLimit);
+
+			throw std::runtime_error(std::string(optionName) + " must be within the range of " + limits);
+		}
+
+		range.steps = static_cast<uint64_t>(steps);
+
+		return range;
+	}
+
+	uint64_t ParseCount(std::string_view optionName, std::string_view value)
+	{
+		int64_t count = 0;
+
+		if (!IniParser::TryParseInt64(value, count) || count < 0)
+		{
+			throw std::runtime_error(std::string(optionName) + " must be a non-negative integer.");
+		}
+
+		return static_cast<uint64_t>(count);
+	}
+
+	TunerOptions ParseCommandLine(int argc, char** argv)
+	{
+		TunerOptions options;
+
+		for (int i = 1; i < argc; i++)
+		{
+			const std::string_view argument = argv[i];
+
+			if (argument.starts_with("--"))
+			{
+				if ((i + 1) == argc)
+				{
+					throw std::runtime_error(std::string(argument) + " requires a value.");
+				}
+
+				const std::string_view value = argv[++i];
+
+				if (argument == "--base")
+				{
+					options.baseMonthlyIncome = ParseRange(
+						argument,
+						value,
+						static_cast<double>(-GamblingIncomeModel::MaxBaseMonthlyIncome),
+						static_cast<double>(GamblingIncomeModel::MaxBaseMonthlyIncome));
+				}
+				else if (argument == "--low")
+				{
+					options.residentialLowWealthFactor = ParseRange(argument, value, 0.0, GamblingIncomeModel::MaxIncomeFactor);
+				}
+				else if (argument == "--med")
+				{
+					options.residentialMedWealthFactor = ParseRange(argument, value, 0.0, GamblingIncomeModel::MaxIncomeFactor);
+				}
+				else if (argument == "--high")
+				{
+					options.residentialHighWealthFactor = ParseRange(argument, value, 0.0, GamblingIncomeModel::MaxIncomeFactor);
+				}
+				else if (argument == "--random")
+				{
+					options.randomPointCount = ParseCount(argument, value);
+				}
+				else if (argument == "--seed")
+				{
+					options.seed = ParseCount(argument, value);
+				}
+				else if (argument == "--settings")
+				{
+					options.monthlyIncomeFormula = InputFiles::ReadIncomeSettings(std::string(value)).monthlyIncomeFormula;
+				}
+				else
+				{
+					throw std::runtime_error("Unknown option: " + std::string(argument));
+				}
+			}
+			else if (options.targetCurvePath.empty())
+			{
+				options.targetCurvePath = argument;
+			}
+			else
+			{
+				options.censusHistoryPaths.emplace_back(argument);
+			}
+		}
+
+		if (options.targetCurvePath.empty() || options.censusHistoryPaths.empty())
+		{
+			throw std::runtime_error("Usage: SC4LegalizeGamblingUpgradeTuner [options] <target curve> <census history>...");
+		}
+
+		return options;
+	}
+
+	std::vector<std::pair<double, double>> ReadTargetCurve(const std::string& path)
+	{
+		const std::string text = InputFiles::ReadAllText(path);
+
+		std::vector<std::pair<double, double>> points;
+		std::string_view remaining = text;
+
+		while (!remaining.empty())
+		{
+			const size_t lineEnd = remaining.find('\n');
+			std::string_view line = remaining.substr(0, lineEnd);
+			remaining.remove_prefix(lineEnd == std::string_view::npos ? remaining.size() : lineEnd + 1);
+
+			while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+			{
+				line.remove_suffix(1);
+			}
+
+			const size_t separator = line.find(',');
+			double population = 0.0;
+			double incomePerCapita = 0.0;
+
+			// The header, comments and empty lines do not have two numbers.
+			if (separator != std::string_view::npos
+				&& TryParseDouble(line.substr(0, separator), population)
+				&& TryParseDouble(line.substr(separator + 1), incomePerCapita))
+			{
+				points.emplace_back(population, incomePerCapita);
+			}
+		}
+
+		if (points.empty())
+		{
+			throw std::runtime_error("The target curve does not have any <population>,<income per capita> lines.");
+		}
+
+		std::sort(points.begin(), points.end());
+
+		return points;
+	}
+
+	double GetTargetIncomePerCapita(const std::vector<std::pair<double, double>>& curve, double population)
+	{
+		if (population <= curve.front().first)
+		{
+			return curve.front().second;
+		}
+		else if (population >= curve.back().first)
+		{
+			return curve.back().second;
+		}
+
+		const auto upper = std::upper_bound(
+			curve.begin(),
+			curve.end(),
+			population,
+			[](double value, const std::pair<double, double>& point) { return value < point.first; });
+		const auto lower = upper - 1;
+
+		const double fraction = (population - lower->first) / (upper->first - lower->first);
+
+		return lower->second + ((upper->second - lower->second) * fraction);
+	}
+
+	TuningMonths ReadTuningMonths(const TunerOptions& options)
+	{
+		const std::vector<std::pair<double, double>> targetCurve = ReadTargetCurve(options.targetCurvePath);
+
+		TuningMonths months;
+
+		for (const std::string& path : options.censusHistoryPaths)
+		{
+			for (const CensusValues& values : InputFiles::ReadCensusHistory(path))
+			{
+				const double residentialPopulation =
+					static_cast<double>(values[static_cast<size_t>(CensusGroup::ResidentialLowWealth)])
+					+ static_cast<double>(values[static_cast<size_t>(CensusGroup::ResidentialMedWealth)])
+					+ static_cast<double>(values[static_cast<size_t>(CensusGroup::ResidentialHighWealth)]);
+
+				if (residentialPopulation >= 1.0)
+				{
+					months.censusValues.push_back(values);
+					months.inverseResidentialPopulation.push_back(1.0 / residentialPopulation);
+					months.targetIncomePerCapita.push_back(GetTargetIncomePerCapita(targetCurve, residentialPopulation));
+				}
+			}
+		}
+
+		if (months.censusValues.empty())
+		{
+			throw std::runtime_error("The census histories do not have any months with a residential population.");
+		}
+
+		return months;
+	}
+
+	uint64_t GetPointCount(const TunerOptions& options)
+	{
+		if (options.randomPointCount > 0)
+		{
+			return options.randomPointCount;
+		}
+
+		const uint64_t counts[] =
+		{
+			options.baseMonthlyIncome.steps,
+			options.residentialLowWealthFactor.steps,
+			options.residentialMedWealthFactor.steps,
+			options.residentialHighWealthFactor.steps,
+		};
+
+		uint64_t total = 1;
+
+		for (uint64_t count : counts)
+		{
+			if (total > std::numeric_limits<uint64_t>::max() / count)
+			{
+				throw std::runtime_error("The grid has too many points.");
+			}
+
+			total *= count;
+		}
+
+		return total;
+	}
+
+	// The SplitMix64 generator, each random point is derived from its index so the
+	// search does not depend on how the points are distributed between the workers.
+	uint64_t SplitMix64(uint64_t value)
+	{
+		value += 0x9E3779B97F4A7C15;
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EB;
+		return value ^ (value >> 31);
+	}
+
+	double GetRandomFraction(uint64_t& state)
+	{
+		state = SplitMix64(state);
+
+		// The upper 53 bits are converted to a value in [0, 1).
+		return static_cast<double>(state >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	IncomeParameters GetPoint(const TunerOptions& options, uint64_t index)
+	{
+		double baseMonthlyIncome = 0.0;
+		double lowWealthFactor = 0.0;
+		double medWealthFactor = 0.0;
+		double highWealthFactor = 0.0;
+
+		if (options.randomPointCount > 0)
+		{
+			uint64_t state = SplitMix64(options.seed ^ SplitMix64(index));
+
+			baseMonthlyIncome = options.baseMonthlyIncome.GetRandomValue(GetRandomFraction(state));
+			lowWealthFactor = options.residentialLowWealthFactor.GetRandomValue(GetRandomFraction(state));
+			medWealthFactor = options.residentialMedWealthFactor.GetRandomValue(GetRandomFraction(state));
+			highWealthFactor = options.residentialHighWealthFactor.GetRandomValue(GetRandomFraction(state));
+		}
+		else
+		{
+			// The index is a mixed-radix number with one digit for each parameter.
+			baseMonthlyIncome = options.baseMonthlyIncome.GetGridValue(index % options.baseMonthlyIncome.steps);
+			index /= options.baseMonthlyIncome.steps;
+			lowWealthFactor = options.residentialLowWealthFactor.GetGridValue(index % options.residentialLowWealthFactor.steps);
+			index /= options.residentialLowWealthFactor.steps;
+			medWealthFactor = options.residentialMedWealthFactor.GetGridValue(index % options.residentialMedWealthFactor.steps);
+			index /= options.residentialMedWealthFactor.steps;
+			highWealthFactor = options.residentialHighWealthFactor.GetGridValue(index);
+		}
+
+		IncomeParameters parameters{};
+		parameters.baseMonthlyIncome = static_cast<int64_t>(std::llround(baseMonthlyIncome));
+		parameters.residentialLowWealthFactor = static_cast<float>(lowWealthFactor);
+		parameters.residentialMedWealthFactor = static_cast<float>(medWealthFactor);
+		parameters.residentialHighWealthFactor = static_cast<float>(highWealthFactor);
+
+		return parameters;
+	}
+
+	// Formats the factor with the fewest digits that are read back as the same float value.
+	std::string FormatFactor(float value)
+	{
+		char buffer[64]{};
+
+		const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+
+		return std::string(buffer, result.ptr);
+	}
+
+	double GetMeanSquareError(const GamblingIncomeModel& model, const TuningMonths& months)
+	{
+		double sum = 0.0;
+
+		for (size_t i = 0; i < months.censusValues.size(); i++)
+		{
+			const int64_t income = model.Calculate(months.censusValues[i]).totalIncome;
+			const double difference = (static_cast<double>(income) * months.inverseResidentialPopulation[i]) - months.targetIncomePerCapita[i];
+
+			sum += difference * difference;
+		}
+
+		return sum / static_cast<double>(months.censusValues.size());
+	}
+
+	SearchResult Search(const TunerOptions& options, const TuningMonths& months, uint64_t pointCount)
+	{
+		const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		const size_t workerCount = hardwareThreads == 0 ? 1 : hardwareThreads;
+
+		// The cost of a point grows with the number of months, the chunks are kept
+		// small enough that the workers finish at about the same time.
+		const uint64_t chunkSize = 1 + (65536 / months.censusValues.size());
+
+		WorkStealingScheduler scheduler(pointCount, workerCount, chunkSize);
+		std::vector<SearchResult> workerResults(workerCount);
+		std::vector<std::thread> workers;
+		workers.reserve(workerCount);
+
+		for (size_t worker = 0; worker < workerCount; worker++)
+		{
+			workers.emplace_back([&, worker]()
+			{
+				SearchResult best;
+				GamblingIncomeModel model;
+				uint64_t begin = 0;
+				uint64_t end = 0;
+
+				while (scheduler.TryGetChunk(worker, begin, end))
+				{
+					for (uint64_t index = begin; index < end; index++)
+					{
+						const IncomeParameters parameters = GetPoint(options, index);
+
+						model.SetParameters(
+							parameters.baseMonthlyIncome,
+							parameters.residentialLowWealthFactor,
+							parameters.residentialMedWealthFactor,
+							parameters.residentialHighWealthFactor,
+							options.monthlyIncomeFormula);
+
+						SearchResult result;
+						result.meanSquareError = GetMeanSquareError(model, months);
+						result.pointIndex = index;
+
+						if (result.IsBetterThan(best))
+						{
+							best = result;
+						}
+					}
+				}
+
+				workerResults[worker] = best;
+			});
+		}
+
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+
+		SearchResult best;
+
+		for (const SearchResult& result : workerResults)
+		{
+			if (result.IsBetterThan(best))
+			{
+				best = result;
+			}
+		}
+
+		return best;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		const TunerOptions options = ParseCommandLine(argc, argv);
+		const TuningMonths months = ReadTuningMonths(options);
+		const uint64_t pointCount = GetPointCount(options);
+
+		const SearchResult best = Search(options, months, pointCount);
+		const IncomeParameters parameters = GetPoint(options, best.pointIndex);
+
+		std::printf(
+			"; Best of %llu points over %zu months, RMS error of the monthly income per resident: %.9g\n",
+			static_cast<unsigned long long>(pointCount),
+			months.censusValues.size(),
+			std::sqrt(best.meanSquareError));
+		std::printf("[GamblingOrdinance]\n");
+		std::printf("BaseMonthlyIncome=%lld\n", static_cast<long long>(parameters.baseMonthlyIncome));
+		std::printf("R$IncomeFactor=%s\n", FormatFactor(parameters.residentialLowWealthFactor).c_str());
+		std::printf("R$$IncomeFactor=%s\n", FormatFactor(parameters.residentialMedWealthFactor).c_str());
+		std::printf("R$$$IncomeFactor=%s\n", FormatFactor(parameters.residentialHighWealthFactor).c_str());
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,142 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// This file is part of sc4-legalize-gambling-ordinance-upgrade, a DLL Plugin
+// for SimCity 4 that updates the built-in ordinance to have its income based
+// on the city's residential population.
+//
+// Copyright (c) 2023 Nicholas Hayes
+//
+// This file is licensed under terms of the MIT License.
+// See LICENSE.txt for more information.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Distributes the indexes [0, count) between a fixed number of workers.
+//
+// Each worker starts with an equal share of the range and takes chunks from the front of it.
+// When its own range is empty, the worker steals the back half of the largest remaining range
+// of another worker. The ranges are only locked when a chunk is taken, so the chunk size
+// controls how often the workers synchronize.
+class WorkStealingScheduler
+{
+public:
+
+	WorkStealingScheduler(uint64_t count, size_t workerCount, uint64_t chunkSize)
+		: ranges(std::make_unique<WorkerRange[]>(workerCount)),
+		  workerCount(workerCount),
+		  chunkSize(chunkSize == 0 ? 1 : chunkSize)
+	{
+		for (size_t i = 0; i < workerCount; i++)
+		{
+			ranges[i].begin = (count * i) / workerCount;
+			ranges[i].end = (count * (i + 1)) / workerCount;
+		}
+	}
+
+	WorkStealingScheduler(const WorkStealingScheduler&) = delete;
+	WorkStealingScheduler& operator=(const WorkStealingScheduler&) = delete;
+
+	/**
+	 * @brief Gets the next chunk of indexes for the specified worker.
+	 * @param worker The worker index.
+	 * @param begin Receives the first index of the chunk.
+	 * @param end Receives the index after the last index of the chunk.
+	 * @return True if a chunk was returned, or false if all of the indexes have been taken.
+	*/
+	bool TryGetChunk(size_t worker, uint64_t& begin, uint64_t& end)
+	{
+		WorkerRange& own = ranges[worker];
+
+		while (true)
+		{
+			{
+				std::scoped_lock lock(own.mutex);
+
+				if (own.begin < own.end)
+				{
+					const uint64_t remaining = own.end - own.begin;
+
+					begin = own.begin;
+					end = begin + (remaining < chunkSize ? remaining : chunkSize);
+					own.begin = end;
+					return true;
+				}
+			}
+
+			uint64_t stolenBegin = 0;
+			uint64_t stolenEnd = 0;
+
+			if (!TrySteal(worker, stolenBegin, stolenEnd))
+			{
+				return false;
+			}
+
+			std::scoped_lock lock(own.mutex);
+
+			own.begin = stolenBegin;
+			own.end = stolenEnd;
+		}
+	}
+
+private:
+
+	bool TrySteal(size_t thief, uint64_t& begin, uint64_t& end)
+	{
+		// The largest range is only a hint, it is checked again after the victim is locked.
+		while (true)
+		{
+			size_t victim = workerCount;
+			uint64_t largestRemaining = 0;
+
+			for (size_t i = 0; i < workerCount; i++)
+			{
+				if (i != thief)
+				{
+					std::scoped_lock lock(ranges[i].mutex);
+
+					const uint64_t remaining = ranges[i].end - ranges[i].begin;
+
+					if (remaining > largestRemaining)
+					{
+						victim = i;
+						largestRemaining = remaining;
+					}
+				}
+			}
+
+			if (victim == workerCount)
+			{
+				return false;
+			}
+
+			WorkerRange& range = ranges[victim];
+			std::scoped_lock lock(range.mutex);
+
+			const uint64_t remaining = range.end - range.begin;
+
+			if (remaining > 0)
+			{
+				begin = range.begin + (remaining / 2);
+				end = range.end;
+				range.end = begin;
+				return true;
+			}
+		}
+	}
+
+	struct alignas(64) WorkerRange
+	{
+		std::mutex mutex;
+		uint64_t begin = 0;
+		uint64_t end = 0;
+	};
+
+	std::unique_ptr<WorkerRange[]> ranges;
+	size_t workerCount;
+	uint64_t chunkSize;
+};